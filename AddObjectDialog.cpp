@@ -21,45 +21,48 @@
 #include <AddObjectDialog.h>
 #include <FilesystemWatcher.h>
 #include <LogiLED.h>
+#include <SoundCache.h>
 
 // Qt
 #include <QFileDialog>
 #include <QPixmap>
 #include <QIcon>
 #include <QColorDialog>
-#include <QSoundEffect>
-#include <QTemporaryFile>
 #include <QFileInfo>
 #include <QMessageBox>
-#include <QPushButton.h>
+#include <QPushButton>
 
 // C++
-#include <minwindef.h>
 #include <cstdlib>
 #include <time.h>
 #include <set>
 
 //-----------------------------------------------------------------------------
 AddObjectDialog::AddObjectDialog(QDir &lastDir, const int alarmVolume, const AlarmFlags flags, const Events events,
-                                 const std::vector<Object> &objects, QWidget *p, Qt::WindowFlags f)
+                                 const Properties properties, const unsigned int window, const QString &include, const QString &exclude,
+                                 const bool gitIgnore, const std::vector<Object> &objects, SoundCache &sounds, QWidget *p,
+                                 Qt::WindowFlags f)
 : QDialog(p,f)
+, m_sounds(sounds)
 , m_dir(lastDir)
 , m_alarmFlags{flags}
 , m_events{events}
+, m_properties{properties}
 , m_objects{objects}
 {
   setupUi(this);
 
-  createSoundFile();
-
   const auto value = std::min(100,std::max(1,alarmVolume));
   m_volumeSlider->setValue(value);
   m_volumeNumber->setText(tr("%1%").arg(value));
-  m_sound->setVolume(static_cast<float>(value)/100.);
 
   m_useKeyboardLights->setChecked((m_alarmFlags & AlarmFlags::LIGHTS) != AlarmFlags::NONE);
   m_useTrayMessage->setChecked((m_alarmFlags & AlarmFlags::MESSAGE) != AlarmFlags::NONE);
   m_soundAlarm->setChecked((m_alarmFlags & AlarmFlags::SOUND) != AlarmFlags::NONE);
+  m_mergeWindow->setValue(static_cast<int>(std::min(window, 60000u)));
+  m_include->setText(include);
+  m_exclude->setText(exclude);
+  m_gitIgnoreProp->setChecked(gitIgnore);
   buttonBox->button(QDialogButtonBox::Ok)->setEnabled(false);
 
   connectSignals();
@@ -83,17 +86,7 @@ AddObjectDialog::~AddObjectDialog()
 {
   if(m_useKeyboardLights->isChecked()) stopKeyboardColors();
 
-  if(m_sound->isPlaying()) m_sound->stop();
-  if(m_sound)
-  {
-    delete m_sound;
-    m_sound = nullptr;
-  }
-  if(m_soundFile)
-  {
-    delete m_soundFile;
-    m_soundFile = nullptr;
-  }
+  m_sounds.stopPreview();
 }
 
 //-----------------------------------------------------------------------------
@@ -105,6 +98,8 @@ void AddObjectDialog::connectSignals()
   connect(m_useKeyboardLights, SIGNAL(stateChanged(int)), this, SLOT(onKeyboardCheckStateChange(int)));
   connect(m_soundAlarm,        SIGNAL(stateChanged(int)), this, SLOT(onSoundAlarmCheckStateChanged(int)));
   connect(m_volumeSlider,      SIGNAL(valueChanged(int)), this, SLOT(onSoundVolumeChanged(int)));
+  connect(m_soundButton,       SIGNAL(clicked()),         this, SLOT(onSoundButtonClicked()));
+  connect(m_modifyProp,        SIGNAL(stateChanged(int)), this, SLOT(onModifyCheckStateChanged(int)));
 }
 
 //-----------------------------------------------------------------------------
@@ -195,6 +190,20 @@ Events AddObjectDialog::objectEvents() const
   return result;
 }
 
+//-----------------------------------------------------------------------------
+Properties AddObjectDialog::objectProperties() const
+{
+  Properties result = Properties::NONE;
+
+  if(m_sizeProp->isChecked())       result |= Properties::SIZE;
+  if(m_writeTimeProp->isChecked())  result |= Properties::WRITE_TIME;
+  if(m_attributesProp->isChecked()) result |= Properties::ATTRIBUTES;
+  if(m_securityProp->isChecked())   result |= Properties::SECURITY;
+  if(m_otherProp->isChecked())      result |= Properties::OTHER;
+
+  return result;
+}
+
 //-----------------------------------------------------------------------------
 AlarmFlags AddObjectDialog::objectAlarms() const
 {
@@ -213,6 +222,12 @@ int AddObjectDialog::alarmVolume() const
   return m_volumeSlider->value();
 }
 
+//-----------------------------------------------------------------------------
+QString AddObjectDialog::alarmSound() const
+{
+  return m_soundFile;
+}
+
 //-----------------------------------------------------------------------------
 QColor AddObjectDialog::alarmColor() const
 {
@@ -291,10 +306,11 @@ void AddObjectDialog::onSoundAlarmCheckStateChanged(int state)
 {
   m_volumeNumber->setEnabled(state == Qt::Checked);
   m_volumeSlider->setEnabled(state == Qt::Checked);
+  m_soundButton->setEnabled(state == Qt::Checked);
 
-  if(state == Qt::Checked && !m_sound->isPlaying())
+  if(state == Qt::Checked && !m_sounds.isPreviewPlaying())
   {
-    m_sound->play();
+    m_sounds.preview(m_soundFile, m_volumeSlider->value());
   }
 }
 
@@ -307,7 +323,7 @@ void AddObjectDialog::updateWidgets(bool isDirectory)
   const bool hasRenameFlag = (m_events & (Events::RENAMED_NEW|Events::RENAMED_OLD)) != Events::NONE;
   const bool hasRecursive = (m_events & Events::RECURSIVE) != Events::NONE;
 
-  for(auto &cbox: {m_modifyProp, m_deleteProp, m_renameProp})
+  for(auto &cbox: {m_modifyProp, m_deleteProp, m_renameProp, m_contentsProp})
     cbox->setEnabled(true);
 
   m_createProp->setChecked(hasAddFlag);
@@ -320,6 +336,17 @@ void AddObjectDialog::updateWidgets(bool isDirectory)
   m_recursiveProp->setChecked(hasRecursive);
   m_recursiveProp->setEnabled(isDirectory);
 
+  m_include->setEnabled(isDirectory);
+  m_exclude->setEnabled(isDirectory);
+  m_gitIgnoreProp->setEnabled(isDirectory);
+
+  m_sizeProp->setChecked((m_properties & Properties::SIZE) != Properties::NONE);
+  m_writeTimeProp->setChecked((m_properties & Properties::WRITE_TIME) != Properties::NONE);
+  m_attributesProp->setChecked((m_properties & Properties::ATTRIBUTES) != Properties::NONE);
+  m_securityProp->setChecked((m_properties & Properties::SECURITY) != Properties::NONE);
+  m_otherProp->setChecked((m_properties & Properties::OTHER) != Properties::NONE);
+  onModifyCheckStateChanged(m_modifyProp->isChecked() ? Qt::Checked : Qt::Unchecked);
+
   m_alarmGroup->setEnabled(true);
   m_propertiesGroup->setEnabled(true);
 
@@ -328,21 +355,30 @@ void AddObjectDialog::updateWidgets(bool isDirectory)
 }
 
 //-----------------------------------------------------------------------------
-void AddObjectDialog::createSoundFile()
+void AddObjectDialog::onSoundVolumeChanged(int value)
 {
-  m_sound = new QSoundEffect(this);
-  m_soundFile = QTemporaryFile::createNativeFile(":/FilesystemWatcher/Beeper.wav");
-  m_sound->setSource(QUrl::fromLocalFile(m_soundFile->fileName()));
-  m_sound->setLoopCount(3);
-  m_sound->setVolume(1);
+  m_volumeNumber->setText(tr("%1%").arg(value));
+  if(m_sounds.isPreviewPlaying()) m_sounds.setPreviewVolume(value);
+  else                            m_sounds.preview(m_soundFile, value);
 }
 
 //-----------------------------------------------------------------------------
-void AddObjectDialog::onSoundVolumeChanged(int value)
+void AddObjectDialog::onSoundButtonClicked()
 {
-  m_sound->setVolume(static_cast<double>(value)/100);
-  m_volumeNumber->setText(tr("%1%").arg(value));
-  if(!m_sound->isPlaying()) m_sound->play();
+  m_soundFile = QFileDialog::getOpenFileName(this, tr("Select alarm sound"), m_dir.absolutePath(), tr("Wave files (*.wav)"));
+
+  m_soundButton->setToolTip(m_soundFile.isEmpty() ? tr("Default sound") : QDir::toNativeSeparators(m_soundFile));
+
+  m_sounds.preview(m_soundFile, m_volumeSlider->value());
+}
+
+//-----------------------------------------------------------------------------
+void AddObjectDialog::onModifyCheckStateChanged(int state)
+{
+  const bool enabled = m_modifyProp->isEnabled() && (state == Qt::Checked);
+
+  for(auto &cbox: {m_sizeProp, m_writeTimeProp, m_attributesProp, m_securityProp, m_otherProp})
+    cbox->setEnabled(enabled);
 }
 
 //-----------------------------------------------------------------------------
@@ -351,6 +387,36 @@ bool AddObjectDialog::isRecursive() const
   return m_recursiveProp->isEnabled() && m_recursiveProp->isChecked();
 }
 
+//-----------------------------------------------------------------------------
+bool AddObjectDialog::compareContents() const
+{
+  return m_contentsProp->isEnabled() && m_contentsProp->isChecked();
+}
+
+//-----------------------------------------------------------------------------
+QString AddObjectDialog::includePatterns() const
+{
+  return m_include->isEnabled() ? m_include->text().trimmed() : QString();
+}
+
+//-----------------------------------------------------------------------------
+QString AddObjectDialog::excludePatterns() const
+{
+  return m_exclude->isEnabled() ? m_exclude->text().trimmed() : QString();
+}
+
+//-----------------------------------------------------------------------------
+bool AddObjectDialog::useGitIgnore() const
+{
+  return m_gitIgnoreProp->isEnabled() && m_gitIgnoreProp->isChecked();
+}
+
+//-----------------------------------------------------------------------------
+unsigned int AddObjectDialog::mergeWindow() const
+{
+  return static_cast<unsigned int>(m_mergeWindow->value());
+}
+
 //-----------------------------------------------------------------------------
 void AddObjectDialog::generateColor()
 {
@@ -28,9 +28,8 @@
 #include <QDialog>
 #include <QDir>
 
-class QSoundEffect;
-class QTemporaryFile;
 class Object;
+class SoundCache;
 
 enum class AlarmFlags : char
 {
@@ -70,13 +69,21 @@ class AddObjectDialog
      * \param[in] alarmVolume Default volume of the sound alarm.
      * \param[in] flags Alarm flags for dialog.
      * \param[in] events Events flags for dialog.
+     * \param[in] properties Properties of the modifications for dialog.
+     * \param[in] window Merge window in milliseconds for dialog.
+     * \param[in] include Patterns of the included paths of a directory for dialog.
+     * \param[in] exclude Patterns of the excluded paths of a directory for dialog.
+     * \param[in] gitIgnore True to ignore the paths in the '.gitignore' files of a directory for dialog.
      * \param[in] objects List of current wathed objects.
+     * \param[in] sounds Alarm sounds cache.
      * \param[in] p Raw pointer of the object parent of this one.
      * \param[in] f Dialog flags.
      *
      */
     explicit AddObjectDialog(QDir &lastDir, const int alarmVolume, const AlarmFlags flags, const Events events,
-                             const std::vector<Object> &objects, QWidget *p = nullptr, Qt::WindowFlags f = Qt::WindowFlags());
+                             const Properties properties, const unsigned int window, const QString &include, const QString &exclude,
+                             const bool gitIgnore, const std::vector<Object> &objects, SoundCache &sounds, QWidget *p = nullptr,
+                             Qt::WindowFlags f = Qt::WindowFlags());
 
     /** \brief AddObjectDialog class virtual destructor.
      *
@@ -93,6 +100,11 @@ class AddObjectDialog
      */
     Events objectEvents() const;
 
+    /** \brief Returns the properties whose modifications are watched.
+     *
+     */
+    Properties objectProperties() const;
+
     /** \brief Returns the alarms for the object modifications.
      *
      */
@@ -103,17 +115,49 @@ class AddObjectDialog
      */
     int alarmVolume() const;
 
+    /** \brief Returns the sound file of the alarm, empty for the default sound.
+     *
+     */
+    QString alarmSound() const;
+
     /** \brief Returns the selected alarm color for the keyboard lights.
      *
      */
     QColor alarmColor() const;
 
+    /** \brief Returns the time in milliseconds to merge the repeated events of a file, 0 if disabled.
+     *
+     */
+    unsigned int mergeWindow() const;
+
     /** \brief Returns true if the object is a subdirectory and the whole tree must be monitored,
      * and false otherwise.
      *
      */
     bool isRecursive() const;
 
+    /** \brief Returns true if only the modifications that change the contents of the files must be
+     * notified, and false otherwise.
+     *
+     */
+    bool compareContents() const;
+
+    /** \brief Returns the patterns of the paths of a directory to notify, separated by ';'.
+     *
+     */
+    QString includePatterns() const;
+
+    /** \brief Returns the patterns of the paths of a directory to not notify, separated by ';'.
+     *
+     */
+    QString excludePatterns() const;
+
+    /** \brief Returns true if the changes of the paths of a directory ignored by its '.gitignore' files
+     * must not be notified, and false otherwise.
+     *
+     */
+    bool useGitIgnore() const;
+
   private slots:
     /** \brief Shows the dialog to select a filesystem file to watch.
      *
@@ -148,12 +192,24 @@ class AddObjectDialog
      */
     void onSoundAlarmCheckStateChanged(int state);
 
+    /** \brief Enables/Disables the properties of the modifications according to state.
+     * \param[in] state Check state.
+     *
+     */
+    void onModifyCheckStateChanged(int state);
+
     /** \brief Updates the volume of the alarm sound.
      * \param[in] value Sound volume in [0,99].
      *
      */
     void onSoundVolumeChanged(int value);
 
+    /** \brief Shows the dialog to select the sound file of the alarm, the default sound is used if
+     * the user cancels it.
+     *
+     */
+    void onSoundButtonClicked();
+
   private:
     /** \brief Helper method to connect signals and slots.
      *
@@ -176,11 +232,6 @@ class AddObjectDialog
      */
     void updateWidgets(bool isDirectory);
 
-    /** \brief Helper method to create the temporary file and classes for the sound.
-     *
-     */
-    void createSoundFile();
-
     /** \brief Helper method to generate a color for the keyboard lights taking into
      * account the colors used by other objects.
      *
@@ -188,11 +239,12 @@ class AddObjectDialog
     void generateColor();
 
     QColor                     m_color;      /** keyboard lights color.         */
-    QSoundEffect              *m_sound;      /** sound class.                   */
-    QTemporaryFile            *m_soundFile;  /** wave file temporary file.      */
+    SoundCache                &m_sounds;     /** alarm sounds cache.            */
+    QString                    m_soundFile;  /** alarm sound file, or empty.    */
     QDir                      &m_dir;        /** last opened dir.               */
     AlarmFlags                 m_alarmFlags; /** last used alarm flags.         */
     Events                     m_events;     /** last used events.              */
+    Properties                 m_properties; /** last used properties.          */
     const std::vector<Object> &m_objects;    /** list of objects being watched. */
 };
 
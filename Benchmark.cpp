@@ -0,0 +1,627 @@
+/*
+ File: Benchmark.cpp
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <ChangeRouter.h>
+#include <WatchThread.h>
+#include <ObjectsTableModel.h>
+
+// Qt
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTemporaryDir>
+#include <QColor>
+
+// C++
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+const int DRAIN_INTERVAL = 50;  /** milliseconds between takes of the queued changes, as the application. */
+const int SETTLE_TIME    = 500; /** milliseconds without changes to consider the watcher idle.            */
+const int RESTORE_FILES  = 10;  /** files of every directory object of the restore scenario.             */
+const int RESTORE_LIMIT  = 60;  /** seconds to wait for the restored objects to be watched.              */
+
+const Events ALL_EVENTS = Events::ADDED|Events::REMOVED|Events::MODIFIED|Events::RENAMED_OLD|Events::RENAMED_NEW;
+
+/** \struct Options
+ * \brief Parameters of the scenarios.
+ *
+ */
+struct Options
+{
+  double       rate;     /** operations per second, 0 for as fast as possible.        */
+  double       duration; /** seconds generating operations.                           */
+  unsigned int files;    /** files of the flat directory.                             */
+  unsigned int depth;    /** levels of the deep tree.                                 */
+  unsigned int fanout;   /** subdirectories of every directory of the tree.           */
+  unsigned int objects;  /** objects of the concurrent objects and restore scenarios. */
+  unsigned int interval; /** milliseconds between takes of the queued changes.        */
+};
+
+/** \struct Scenario
+ * \brief Watched objects and the files changed by the operations.
+ *
+ */
+struct Scenario
+{
+  /** \struct Object
+   * \brief Watched object.
+   *
+   */
+  struct Object
+  {
+    std::filesystem::path path;      /** path of the object.                       */
+    bool                  recursive; /** true to watch the subtree of a directory. */
+  };
+
+  std::string                        name;       /** name of the scenario.                                    */
+  std::vector<Object>                objects;    /** watched objects.                                         */
+  std::vector<std::filesystem::path> files;      /** changed files.                                           */
+  bool                               modifyOnly; /** true if the files are objects, only modified, not moved. */
+};
+
+/** \struct Result
+ * \brief Measures of a scenario.
+ *
+ */
+struct Result
+{
+  unsigned long long     operations   = 0; /** operations done.                                          */
+  double                 seconds      = 0; /** seconds doing the operations.                             */
+  unsigned long long     events       = 0; /** changes taken from the queue.                             */
+  double                 drainSeconds = 0; /** seconds until the last change was taken.                  */
+  unsigned long long     alarms       = 0; /** alarms dispatched, one per changed object and take.       */
+  unsigned long long     dropped      = 0; /** changes dropped by the queue.                             */
+  unsigned long long     collapsed    = 0; /** changes collapsed by the queue.                           */
+  unsigned long long     unobserved   = 0; /** operations without a change.                              */
+  std::vector<long long> notified;         /** microseconds from the operation to its notification.     */
+  std::vector<long long> updated;          /** microseconds from the operation to the model update.     */
+  std::vector<long long> dispatched;       /** microseconds from the operation to the alarm dispatch.   */
+};
+
+/** \class Operations
+ * \brief Times of the operations not yet seen as changes, by path and in order. Every change takes
+ * as many operations of its path as events it merges, oldest first.
+ *
+ */
+class Operations
+{
+  public:
+    /** \brief Adds the time of an operation.
+     * \param[in] path Path of the changed file.
+     * \param[in] time Microseconds since the epoch before the operation.
+     *
+     */
+    void add(const std::filesystem::path &path, const long long time)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_times[path.wstring()].push_back(time);
+      ++m_size;
+    }
+
+    /** \brief Moves the times of the oldest pending operations of the path to the given vector.
+     * \param[in] path Path of a change.
+     * \param[in] count Maximum number of operations.
+     * \param[out] times Times of the operations in microseconds since the epoch.
+     *
+     */
+    void take(std::wstring_view path, const unsigned long count, std::vector<long long> &times)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_path.assign(path);
+      const auto it = m_times.find(m_path);
+      if(it == m_times.end()) return;
+
+      auto &pending = it->second;
+      const auto taken = std::min<size_t>(count, pending.size());
+      times.insert(times.end(), pending.begin(), pending.begin() + taken);
+      pending.erase(pending.begin(), pending.begin() + taken);
+      m_size -= taken;
+
+      if(pending.empty()) m_times.erase(it);
+    }
+
+    /** \brief Returns the number of pending operations.
+     *
+     */
+    size_t size()
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_size;
+    }
+
+  private:
+    std::mutex                                              m_mutex;    /** protects the times.                  */
+    std::unordered_map<std::wstring, std::deque<long long>> m_times;    /** path to the times of its operations. */
+    size_t                                                  m_size = 0; /** number of pending operations.        */
+    std::wstring                                            m_path;     /** buffer of the taken path.            */
+};
+
+//-----------------------------------------------------------------
+static long long now()
+{
+  const auto time = std::chrono::system_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+}
+
+//-----------------------------------------------------------------
+static void touch(const std::filesystem::path &path)
+{
+  std::ofstream file(path, std::ios::app|std::ios::binary);
+  file.put('x');
+}
+
+//-----------------------------------------------------------------
+static void createTree(const std::filesystem::path &directory, const unsigned int depth, const unsigned int fanout,
+                       std::vector<std::filesystem::path> &files)
+{
+  std::filesystem::create_directories(directory);
+
+  for(unsigned int i = 0; i < fanout; ++i)
+  {
+    const auto file = directory / ("file" + std::to_string(i) + ".txt");
+    touch(file);
+    files.push_back(file);
+
+    if(depth > 1) createTree(directory / ("dir" + std::to_string(i)), depth - 1, fanout, files);
+  }
+}
+
+//-----------------------------------------------------------------
+static std::vector<Scenario> createScenarios(const std::filesystem::path &root, const Options &options, const QStringList &names)
+{
+  std::vector<Scenario> result;
+
+  auto wanted = [&names](const QString &name) { return names.contains(name) || names.contains("all"); };
+
+  if(wanted("single"))
+  {
+    Scenario scenario{"single", {}, {}, true};
+    const auto directory = root / "single";
+    std::filesystem::create_directories(directory);
+    scenario.files.push_back(directory / "file.txt");
+    touch(scenario.files.front());
+    scenario.objects.push_back(Scenario::Object{scenario.files.front(), false});
+    result.push_back(scenario);
+  }
+
+  if(wanted("flat"))
+  {
+    Scenario scenario{"flat", {}, {}, false};
+    const auto directory = root / "flat";
+    std::filesystem::create_directories(directory);
+    for(unsigned int i = 0; i < options.files; ++i)
+    {
+      scenario.files.push_back(directory / ("file" + std::to_string(i) + ".txt"));
+      touch(scenario.files.back());
+    }
+    scenario.objects.push_back(Scenario::Object{directory, false});
+    result.push_back(scenario);
+  }
+
+  if(wanted("deep"))
+  {
+    Scenario scenario{"deep", {}, {}, false};
+    const auto directory = root / "deep";
+    createTree(directory, options.depth, options.fanout, scenario.files);
+    scenario.objects.push_back(Scenario::Object{directory, true});
+    result.push_back(scenario);
+  }
+
+  if(wanted("objects"))
+  {
+    Scenario scenario{"objects", {}, {}, true};
+    const auto directory = root / "objects";
+    for(unsigned int i = 0; i < options.objects; ++i)
+    {
+      // a few directories, the files of the same directory share its watch.
+      const auto subdirectory = directory / ("dir" + std::to_string(i % 16));
+      std::filesystem::create_directories(subdirectory);
+      scenario.files.push_back(subdirectory / ("file" + std::to_string(i) + ".txt"));
+      touch(scenario.files.back());
+      scenario.objects.push_back(Scenario::Object{scenario.files.back(), false});
+    }
+    result.push_back(scenario);
+  }
+
+  return result;
+}
+
+//-----------------------------------------------------------------
+static void generate(Scenario &scenario, const Options &options, Operations &operations, Result &result)
+{
+  std::mt19937 random{42};
+  std::uniform_int_distribution<size_t> anyFile{0, scenario.files.size() - 1};
+  std::uniform_int_distribution<int> anyOperation{0, 99};
+
+  // the renamed and removed files are restored by a later operation on them.
+  std::vector<char> state(scenario.files.size(), 0);
+  auto renamed = [](const std::filesystem::path &path) { auto result = path; result += ".renamed"; return result; };
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto end = start + std::chrono::microseconds(static_cast<long long>(options.duration * 1e6));
+
+  std::error_code ec;
+  unsigned long long count = 0;
+  for(auto current = start; current < end; current = std::chrono::steady_clock::now())
+  {
+    if(options.rate > 0)
+    {
+      const auto due = start + std::chrono::microseconds(static_cast<long long>(count * 1e6 / options.rate));
+      if(due > current) std::this_thread::sleep_until(due);
+    }
+
+    const auto index = anyFile(random);
+    const auto &file = scenario.files[index];
+    const auto operation = scenario.modifyOnly ? 0 : anyOperation(random);
+
+    switch(state[index])
+    {
+      case 0:
+        if(operation < 70)
+        {
+          operations.add(file, now());
+          touch(file);
+        }
+        else if(operation < 85)
+        {
+          operations.add(file, now());
+          std::filesystem::rename(file, renamed(file), ec);
+          state[index] = 1;
+        }
+        else
+        {
+          operations.add(file, now());
+          std::filesystem::remove(file, ec);
+          state[index] = 2;
+        }
+        break;
+      case 1:
+        operations.add(file, now());
+        std::filesystem::rename(renamed(file), file, ec);
+        state[index] = 0;
+        break;
+      default:
+        operations.add(file, now());
+        touch(file);
+        state[index] = 0;
+        break;
+    }
+
+    ++count;
+  }
+
+  result.operations = count;
+  result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+//-----------------------------------------------------------------
+static long long percentile(std::vector<long long> &values, const double fraction)
+{
+  if(values.empty()) return 0;
+
+  const auto position = static_cast<size_t>(fraction * (values.size() - 1));
+  std::nth_element(values.begin(), values.begin() + position, values.end());
+
+  return values[position];
+}
+
+/** \class Consumer
+ * \brief Takes the queued changes and does the same work as the application for every change,
+ * routing them to the objects table model and dispatching the alarms, without the sounds and the tray.
+ *
+ */
+class Consumer
+: private ChangeRouter::Listener
+{
+  public:
+    /** \brief Consumer class constructor.
+     * \param[in] watcher Watcher thread.
+     * \param[in] operations Times of the pending operations.
+     *
+     */
+    explicit Consumer(WatchThread &watcher, Operations &operations)
+    : m_watcher(watcher), m_operations(operations), m_updated{0}, m_alarms{0}
+    {}
+
+    /** \brief Adds an object to the table.
+     * \param[in] path Path of the object.
+     *
+     */
+    void addObject(const std::filesystem::path &path)
+    {
+      m_router.insert(path.wstring(), m_model.rowCount(), std::filesystem::is_directory(path));
+      m_model.addObject(QString::fromStdWString(path.wstring()), QColor(Qt::white));
+    }
+
+    /** \brief Takes the queued changes. Returns true if there were changes and false otherwise.
+     * \param[out] result Measures of the scenario.
+     *
+     */
+    bool consume(Result &result)
+    {
+      m_batch.clear();
+      m_summaries.clear();
+      if(!m_watcher.drain(m_batch, m_summaries)) return false;
+
+      m_times.clear();
+
+      auto measure = [&](std::wstring_view path, const unsigned long count, const long long notified)
+      {
+        const auto first = m_times.size();
+        if(!path.empty()) m_operations.take(path, count, m_times);
+
+        for(auto i = first; i < m_times.size(); ++i)
+        {
+          if(notified > 0) result.notified.push_back(notified - m_times[i]);
+        }
+      };
+
+      for(const auto event: m_batch)
+      {
+        measure(event.object, event.count, event.time);
+        measure(event.oldName, event.count, event.time);
+      }
+
+      result.events += m_batch.size();
+
+      m_updated = 0;
+      m_alarms = 0;
+      m_router.route(m_batch, *this);
+
+      const auto dispatched = now();
+      if(m_updated == 0) m_updated = dispatched;
+
+      result.alarms += m_alarms;
+
+      for(const auto time: m_times)
+      {
+        result.updated.push_back(m_updated - time);
+        result.dispatched.push_back(dispatched - time);
+      }
+
+      return true;
+    }
+
+  private:
+    virtual void onModification(const int row, std::wstring_view, const Events e, const unsigned long count,
+                                const Properties properties) override
+    { m_model.modification(row, e, count, properties); }
+
+    virtual void onRename(const int row, std::wstring_view, std::wstring_view newName, const bool isObject) override
+    {
+      if(isObject) m_model.rename(row, newName);
+      else         m_model.modification(row, Events::RENAMED_NEW, 1);
+    }
+
+    virtual void onRowsChanged(const int first, const int last, const bool renamed) override
+    {
+      m_model.updateRows(first, last, renamed);
+      m_updated = now();
+    }
+
+    // the alarms of the application only start the sounds, lights and messages from here.
+    virtual void onAlarm(const int, const Events, const Properties) override
+    { ++m_alarms; }
+
+    WatchThread                    &m_watcher;    /** watcher thread.                          */
+    Operations                     &m_operations; /** times of the pending operations.         */
+    ChangeRouter                    m_router;     /** routes the changes to their rows.        */
+    ObjectsTableModel               m_model;      /** objects table model.                     */
+    EventBatch                      m_batch;      /** buffer of the queued changes.            */
+    std::vector<EventRing::Summary> m_summaries;  /** buffer of the collapsed changes.         */
+    std::vector<long long>          m_times;      /** times of the operations of the changes.  */
+    long long                       m_updated;    /** time the model was updated, 0 if not.    */
+    unsigned long long              m_alarms;     /** alarms dispatched by the last take.      */
+};
+
+//-----------------------------------------------------------------
+static Result run(Scenario &scenario, const Options &options)
+{
+  Result result;
+  Operations operations;
+
+  WatchThread watcher;
+  Consumer consumer(watcher, operations);
+  for(const auto &object: scenario.objects)
+  {
+    watcher.addObject(object.path, ALL_EVENTS, object.recursive);
+    consumer.addObject(object.path);
+  }
+  watcher.start();
+
+  // takes the changes until there are none for a while, returns the time of the last ones.
+  auto settle = [&]()
+  {
+    auto last = std::chrono::steady_clock::now();
+    while(std::chrono::steady_clock::now() - last < std::chrono::milliseconds(SETTLE_TIME))
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(options.interval));
+      if(consumer.consume(result)) last = std::chrono::steady_clock::now();
+    }
+    return last;
+  };
+
+  // the snapshots of the objects are taken before the operations start.
+  settle();
+  result = Result();
+
+  std::atomic<bool> generating{true};
+  std::thread generator([&]() { generate(scenario, options, operations, result); generating = false; });
+
+  const auto start = std::chrono::steady_clock::now();
+  while(generating)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(options.interval));
+    consumer.consume(result);
+  }
+  generator.join();
+
+  const auto last = settle();
+
+  result.drainSeconds = std::chrono::duration<double>(last - start).count();
+  result.dropped = watcher.queue().dropped();
+  result.collapsed = watcher.queue().collapsed();
+  result.unobserved = operations.size();
+
+  watcher.abort();
+  watcher.wait();
+
+  return result;
+}
+
+//-----------------------------------------------------------------
+static double restore(const std::filesystem::path &root, const Options &options)
+{
+  // as restored from the settings: directory objects with a few files and file objects sharing directories.
+  const auto directory = root / "restore";
+  std::vector<WatchThread::ObjectParameters> objects;
+  for(unsigned int i = 0; i < options.objects; ++i)
+  {
+    std::filesystem::path path;
+    if(i % 2 == 0 && i + 1 < options.objects)
+    {
+      path = directory / ("dir" + std::to_string(i));
+      std::filesystem::create_directories(path);
+      for(int j = 0; j < RESTORE_FILES; ++j) touch(path / ("file" + std::to_string(j) + ".txt"));
+    }
+    else
+    {
+      const auto subdirectory = directory / ("files" + std::to_string(i % 16));
+      std::filesystem::create_directories(subdirectory);
+      path = subdirectory / ("file" + std::to_string(i) + ".txt");
+      touch(path);
+    }
+
+    objects.push_back(WatchThread::ObjectParameters{path, ALL_EVENTS, false, 0, false, Properties::ALL, PathFilter(), false});
+  }
+
+  WatchThread watcher;
+  watcher.start();
+
+  // the last object is a file, its changes are seen once all the watches were added and their snapshots read.
+  const auto sentinel = objects.back().object;
+  EventBatch batch;
+  std::vector<EventRing::Summary> summaries;
+
+  const auto start = std::chrono::steady_clock::now();
+  watcher.addObjects(objects);
+
+  bool watched = false;
+  while(!watched && std::chrono::steady_clock::now() - start < std::chrono::seconds(RESTORE_LIMIT))
+  {
+    touch(sentinel);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    batch.clear();
+    summaries.clear();
+    watcher.drain(batch, summaries);
+    for(const auto event: batch) watched |= (event.object == sentinel.wstring());
+  }
+
+  const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  watcher.abort();
+  watcher.wait();
+
+  return watched ? elapsed : -1;
+}
+
+//-----------------------------------------------------------------
+int main(int argc, char **argv)
+{
+  QCoreApplication app(argc, argv);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Measures the changes per second and the latencies of the watcher under a synthetic load.");
+  parser.addHelpOption();
+  const QCommandLineOption scenarioOption("scenario", "Scenarios to run, separated by commas: single, flat, deep, objects, restore or all.", "names", "all");
+  const QCommandLineOption rateOption("rate", "Operations per second, 0 for as fast as possible.", "rate", "1000");
+  const QCommandLineOption durationOption("duration", "Seconds generating operations in every scenario.", "seconds", "10");
+  const QCommandLineOption filesOption("files", "Files of the flat directory.", "number", "100000");
+  const QCommandLineOption depthOption("depth", "Levels of the deep tree.", "number", "6");
+  const QCommandLineOption fanoutOption("fanout", "Subdirectories and files of every directory of the deep tree.", "number", "4");
+  const QCommandLineOption objectsOption("objects", "Objects of the concurrent objects and restore scenarios.", "number", "1000");
+  const QCommandLineOption intervalOption("interval", "Milliseconds between takes of the queued changes.", "milliseconds", QString::number(DRAIN_INTERVAL));
+  const QCommandLineOption directoryOption("directory", "Directory of the temporary files.", "path");
+  parser.addOptions({scenarioOption, rateOption, durationOption, filesOption, depthOption, fanoutOption, objectsOption, intervalOption, directoryOption});
+  parser.process(app);
+
+  Options options;
+  options.rate = std::max(0.0, parser.value(rateOption).toDouble());
+  options.duration = std::max(0.1, parser.value(durationOption).toDouble());
+  options.files = std::max(1u, parser.value(filesOption).toUInt());
+  options.depth = std::max(1u, parser.value(depthOption).toUInt());
+  options.fanout = std::max(1u, parser.value(fanoutOption).toUInt());
+  options.objects = std::max(1u, parser.value(objectsOption).toUInt());
+  options.interval = std::max(1u, parser.value(intervalOption).toUInt());
+
+  const auto directory = parser.isSet(directoryOption) ? QTemporaryDir(parser.value(directoryOption) + "/FilesystemWatcherBenchmark-XXXXXX") : QTemporaryDir();
+  if(!directory.isValid())
+  {
+    std::cerr << "Unable to create the temporary directory: " << directory.errorString().toStdString() << std::endl;
+    return 1;
+  }
+
+  const std::filesystem::path root{directory.path().toStdWString()};
+  const auto names = parser.value(scenarioOption).split(',');
+  auto scenarios = createScenarios(root, options, names);
+
+  std::printf("%-8s %10s %10s %10s %10s %10s %9s %9s %10s %19s %19s %19s\n", "scenario", "ops", "ops/s", "events", "events/s", "alarms",
+              "dropped", "collapsed", "unobserved", "notify p50/p99", "model p50/p99", "alarm p50/p99");
+
+  for(auto &scenario: scenarios)
+  {
+    auto result = run(scenario, options);
+
+    auto latencies = [](std::vector<long long> &values)
+    {
+      char text[32];
+      std::snprintf(text, sizeof(text), "%.2f/%.2f ms", percentile(values, 0.5) / 1000.0, percentile(values, 0.99) / 1000.0);
+      return std::string(text);
+    };
+
+    std::printf("%-8s %10llu %10.0f %10llu %10.0f %10llu %9llu %9llu %10llu %19s %19s %19s\n", scenario.name.c_str(), result.operations,
+                result.operations / result.seconds, result.events, result.events / std::max(result.drainSeconds, 1e-6), result.alarms,
+                result.dropped, result.collapsed, result.unobserved, latencies(result.notified).c_str(), latencies(result.updated).c_str(),
+                latencies(result.dispatched).c_str());
+    std::fflush(stdout);
+  }
+
+  if(names.contains("restore") || names.contains("all"))
+  {
+    const auto milliseconds = restore(root, options);
+    if(milliseconds < 0) std::printf("restore: %u objects not watched after %d seconds\n", options.objects, RESTORE_LIMIT);
+    else                 std::printf("restore: %u objects watched in %.1f ms\n", options.objects, milliseconds);
+  }
+
+  return 0;
+}
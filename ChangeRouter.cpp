@@ -0,0 +1,87 @@
+/*
+ File: ChangeRouter.cpp
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <ChangeRouter.h>
+
+// C++
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+bool ChangeRouter::route(const EventBatch &batch, Listener &listener)
+{
+  m_alarms.clear();
+  bool renamed = false;
+
+  for(const auto event: batch)
+  {
+    const bool isRename = !event.oldName.empty();
+    const auto row = m_index.find(isRename ? event.oldName : event.object);
+    if(row < 0) continue;
+
+    if(isRename)
+    {
+      // a file renamed inside a watched directory counts as a change of the directory.
+      const bool isObject = m_index.find(event.oldName, true) == row;
+      if(isObject) m_index.rename(event.oldName, event.object);
+
+      renamed |= isObject;
+      listener.onRename(row, event.oldName, event.object, isObject);
+    }
+    else
+    {
+      listener.onModification(row, event.object, event.event, event.count, event.properties);
+    }
+
+    const auto alarmEvent = isRename ? Events::RENAMED_OLD : event.event;
+    const auto alarmProperties = isRename ? Properties::NONE : event.properties;
+
+    // a batch can change thousands of objects, the alarm of the row is found without a search.
+    if(static_cast<size_t>(row) >= m_slots.size()) m_slots.resize(row + 1, -1);
+
+    auto &slot = m_slots[row];
+    if(slot >= 0)
+    {
+      std::get<1>(m_alarms[slot]) = alarmEvent;
+      std::get<2>(m_alarms[slot]) = alarmProperties;
+    }
+    else
+    {
+      slot = static_cast<int>(m_alarms.size());
+      m_alarms.emplace_back(row, alarmEvent, alarmProperties);
+    }
+  }
+
+  // only the changed rows have a slot, the next batch starts with none.
+  for(const auto &alarm: m_alarms) m_slots[std::get<0>(alarm)] = -1;
+
+  if(m_alarms.empty()) return false;
+
+  auto lessRow = [](const Alarm &lhs, const Alarm &rhs) { return std::get<0>(lhs) < std::get<0>(rhs); };
+  const auto range = std::minmax_element(m_alarms.cbegin(), m_alarms.cend(), lessRow);
+
+  listener.onRowsChanged(std::get<0>(*range.first), std::get<0>(*range.second), renamed);
+
+  for(const auto &alarm: m_alarms)
+  {
+    listener.onAlarm(std::get<0>(alarm), std::get<1>(alarm), std::get<2>(alarm));
+  }
+
+  return true;
+}
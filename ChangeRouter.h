@@ -0,0 +1,132 @@
+/*
+ File: ChangeRouter.h
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHANGEROUTER_H_
+#define CHANGEROUTER_H_
+
+// Project
+#include <EventBatch.h>
+#include <PathIndex.h>
+
+// C++
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+/** \class ChangeRouter
+ * \brief Routes the changes of a batch to the rows of the watched objects that own their paths and
+ * decides the alarms, once for every changed object with its last event. Used by the application
+ * and the benchmark.
+ *
+ */
+class ChangeRouter
+{
+  public:
+    /** \class Listener
+     * \brief Receives the routed changes and the alarms.
+     *
+     */
+    class Listener
+    {
+      public:
+        /** \brief Listener class virtual destructor.
+         *
+         */
+        virtual ~Listener()
+        {};
+
+        /** \brief Called for every change that is not a rename.
+         * \param[in] row Row of the object owning the changed path.
+         * \param[in] object Changed path.
+         * \param[in] e Event.
+         * \param[in] count Number of merged events.
+         * \param[in] properties Changed properties if a modification.
+         *
+         */
+        virtual void onModification(const int row, std::wstring_view object, const Events e, const unsigned long count,
+                                    const Properties properties) = 0;
+
+        /** \brief Called for every rename, after the index has the new path if the object itself was renamed.
+         * \param[in] row Row of the object owning the old path.
+         * \param[in] oldName Old path.
+         * \param[in] newName New path.
+         * \param[in] isObject True if the object itself was renamed and false if it was a path inside a
+         * directory object.
+         *
+         */
+        virtual void onRename(const int row, std::wstring_view oldName, std::wstring_view newName, const bool isObject) = 0;
+
+        /** \brief Called once per batch with changes, with the range of the changed rows.
+         * \param[in] first First changed row.
+         * \param[in] last Last changed row.
+         * \param[in] renamed True if an object was renamed.
+         *
+         */
+        virtual void onRowsChanged(const int first, const int last, const bool renamed) = 0;
+
+        /** \brief Called once for every changed object of the batch, after the rows are updated.
+         * \param[in] row Row of the object.
+         * \param[in] e Last event of the object, RENAMED_OLD if renamed.
+         * \param[in] properties Changed properties if a modification.
+         *
+         */
+        virtual void onAlarm(const int row, const Events e, const Properties properties) = 0;
+    };
+
+    /** \brief Adds an object to the routed rows.
+     * \param[in] path Path of the object.
+     * \param[in] row Row of the object.
+     * \param[in] isDirectory True if the object also owns the paths inside it.
+     *
+     */
+    void insert(std::wstring_view path, const int row, const bool isDirectory)
+    { m_index.insert(path, row, isDirectory); }
+
+    /** \brief Removes the object of the given row, the rows after it move up by one.
+     * \param[in] row Row of the removed object.
+     *
+     */
+    void removeRow(const int row)
+    { m_index.removeValue(row); }
+
+    /** \brief Returns the row of the object that owns the path or -1 if none.
+     * \param[in] path Path of a changed object.
+     * \param[in] exact True to only return the row of an object with exactly that path.
+     *
+     */
+    int find(std::wstring_view path, const bool exact = false) const
+    { return m_index.find(path, exact); }
+
+    /** \brief Routes the changes to their objects and notifies the listener. Returns true if any object
+     * changed and false otherwise.
+     * \param[in] batch Changes of the watched objects.
+     * \param[in] listener Listener of the routed changes.
+     *
+     */
+    bool route(const EventBatch &batch, Listener &listener);
+
+  private:
+    using Alarm = std::tuple<int, Events, Properties>;
+
+    PathIndex          m_index;  /** paths to the row of the object owning them.            */
+    std::vector<Alarm> m_alarms; /** buffer of the last event of every changed row.         */
+    std::vector<int>   m_slots;  /** index of the alarm of every row in the buffer, or -1.  */
+};
+
+#endif // CHANGEROUTER_H_
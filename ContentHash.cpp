@@ -0,0 +1,213 @@
+/*
+ File: ContentHash.cpp
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <ContentHash.h>
+
+// Qt
+#include <QObject>
+
+// C++
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <Win32WatchBackend.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const uint32_t PRIME1 = 2654435761U;
+static const uint32_t PRIME2 = 2246822519U;
+static const uint32_t PRIME3 = 3266489917U;
+static const uint64_t PRIME64 = 0x9E3779B97F4A7C15ULL;
+
+static const size_t CHUNK = 1 << 20; /** size of the reads of a file. */
+
+//-----------------------------------------------------------------------------
+ContentHash::ContentHash()
+: m_buffered{0}
+, m_length{0}
+{
+  for(size_t i = 0; i < LANES; ++i) m_lanes[i] = PRIME3 + static_cast<uint32_t>(i) * PRIME2;
+}
+
+//-----------------------------------------------------------------------------
+void ContentHash::update(const unsigned char *data, size_t size)
+{
+  m_length += size;
+
+  if(m_buffered > 0)
+  {
+    const auto length = std::min(size, BLOCK - m_buffered);
+    std::memcpy(m_buffer + m_buffered, data, length);
+    m_buffered += length;
+    data += length;
+    size -= length;
+
+    if(m_buffered < BLOCK) return;
+
+    consume(m_buffer, 1);
+    m_buffered = 0;
+  }
+
+  const auto blocks = size / BLOCK;
+  consume(data, blocks);
+
+  m_buffered = size - blocks * BLOCK;
+  std::memcpy(m_buffer, data + blocks * BLOCK, m_buffered);
+}
+
+//-----------------------------------------------------------------------------
+void ContentHash::consume(const unsigned char *data, size_t blocks)
+{
+  // the lanes don't depend on each other, every round is a single vector operation.
+  uint32_t lanes[LANES];
+  std::memcpy(lanes, m_lanes, sizeof(lanes));
+
+  for(size_t block = 0; block < blocks; ++block, data += BLOCK)
+  {
+    uint32_t values[LANES];
+    std::memcpy(values, data, BLOCK);
+
+    for(size_t i = 0; i < LANES; ++i)
+    {
+      const auto lane = lanes[i] + values[i] * PRIME2;
+      lanes[i] = ((lane << 13) | (lane >> 19)) * PRIME1;
+    }
+  }
+
+  std::memcpy(m_lanes, lanes, sizeof(lanes));
+}
+
+//-----------------------------------------------------------------------------
+uint64_t ContentHash::value() const
+{
+  uint64_t hash = m_length * PRIME64;
+
+  auto mix = [&hash](const uint64_t value)
+  {
+    hash ^= value * PRIME64;
+    hash = ((hash << 31) | (hash >> 33)) * PRIME64;
+  };
+
+  for(size_t i = 0; i < LANES; i += 2) mix((static_cast<uint64_t>(m_lanes[i]) << 32) | m_lanes[i + 1]);
+  for(size_t i = 0; i < m_buffered; ++i) mix(m_buffer[i] + 1);
+
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCDULL;
+  hash ^= hash >> 33;
+  hash *= 0xC4CEB9FE1A85EC53ULL;
+  hash ^= hash >> 33;
+
+  return hash;
+}
+
+#ifdef _WIN32
+
+//-----------------------------------------------------------------------------
+bool ContentHash::hashFile(const std::filesystem::path &file, uint64_t &hash, QString &error)
+{
+  // shared for writing and removal, the owner of the file must not notice the read.
+  const auto handle = CreateFileW(file.wstring().c_str(),
+                                  GENERIC_READ,
+                                  FILE_SHARE_READ | FILE_SHARE_DELETE | FILE_SHARE_WRITE,
+                                  nullptr,
+                                  OPEN_EXISTING,
+                                  FILE_FLAG_SEQUENTIAL_SCAN,
+                                  nullptr);
+
+  if(handle == INVALID_HANDLE_VALUE)
+  {
+    const auto errorString = Win32WatchBackend::getLastErrorString(GetLastError());
+    error = QObject::tr("Unable to open file '%1'. Error: %2").arg(QString::fromStdWString(file.wstring())).arg(errorString);
+    return false;
+  }
+
+  ContentHash contents;
+  std::vector<unsigned char> buffer(CHUNK);
+
+  BOOL result = TRUE;
+  DWORD length = 0;
+  while((result = ReadFile(handle, buffer.data(), static_cast<DWORD>(buffer.size()), &length, nullptr)) && length > 0)
+  {
+    contents.update(buffer.data(), length);
+  }
+
+  const auto errorCode = GetLastError();
+  CloseHandle(handle);
+
+  if(!result)
+  {
+    const auto errorString = Win32WatchBackend::getLastErrorString(errorCode);
+    error = QObject::tr("Unable to read file '%1'. Error: %2").arg(QString::fromStdWString(file.wstring())).arg(errorString);
+    return false;
+  }
+
+  hash = contents.value();
+  return true;
+}
+
+#else
+
+//-----------------------------------------------------------------------------
+bool ContentHash::hashFile(const std::filesystem::path &file, uint64_t &hash, QString &error)
+{
+  const auto fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+  if(fd == -1)
+  {
+    const auto errorString = QString::fromLocal8Bit(strerror(errno));
+    error = QObject::tr("Unable to open file '%1'. Error: %2").arg(QString::fromStdWString(file.wstring())).arg(errorString);
+    return false;
+  }
+
+  posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  ContentHash contents;
+  std::vector<unsigned char> buffer(CHUNK);
+
+  while(true)
+  {
+    const auto length = read(fd, buffer.data(), buffer.size());
+    if(length == 0) break;
+
+    if(length < 0)
+    {
+      if(errno == EINTR) continue;
+
+      const auto errorString = QString::fromLocal8Bit(strerror(errno));
+      error = QObject::tr("Unable to read file '%1'. Error: %2").arg(QString::fromStdWString(file.wstring())).arg(errorString);
+      close(fd);
+      return false;
+    }
+
+    contents.update(buffer.data(), static_cast<size_t>(length));
+  }
+
+  close(fd);
+
+  hash = contents.value();
+  return true;
+}
+
+#endif
@@ -0,0 +1,82 @@
+/*
+ File: ContentHash.h
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONTENTHASH_H_
+#define CONTENTHASH_H_
+
+// Qt
+#include <QString>
+
+// C++
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+/** \class ContentHash
+ * \brief Fast non-cryptographic hash of the contents of a file, to tell if a modification changed
+ * them. The data is consumed incrementally in blocks of 32 bytes by eight independent 32 bit lanes,
+ * that the compiler turns into SIMD instructions. Files are read sequentially in chunks.
+ *
+ */
+class ContentHash
+{
+  public:
+    /** \brief ContentHash class constructor.
+     *
+     */
+    explicit ContentHash();
+
+    /** \brief Adds the given data to the hash.
+     * \param[in] data Pointer to the data.
+     * \param[in] size Size of the data in bytes.
+     *
+     */
+    void update(const unsigned char *data, size_t size);
+
+    /** \brief Returns the hash of the data added until now.
+     *
+     */
+    uint64_t value() const;
+
+    /** \brief Computes the hash of the contents of the given file. Returns true on success and false otherwise.
+     * \param[in] file Path of the file.
+     * \param[out] hash Hash of the file contents.
+     * \param[out] error Error message in case of failure.
+     *
+     */
+    static bool hashFile(const std::filesystem::path &file, uint64_t &hash, QString &error);
+
+  private:
+    static constexpr size_t LANES = 8;                        /** independent hash lanes.        */
+    static constexpr size_t BLOCK = LANES * sizeof(uint32_t); /** bytes consumed by a lanes round. */
+
+    /** \brief Consumes the given number of whole blocks.
+     * \param[in] data Pointer to the blocks.
+     * \param[in] blocks Number of blocks.
+     *
+     */
+    void consume(const unsigned char *data, size_t blocks);
+
+    uint32_t      m_lanes[LANES];  /** state of the lanes.                     */
+    unsigned char m_buffer[BLOCK]; /** data of an incomplete block.            */
+    size_t        m_buffered;      /** size of the incomplete block.           */
+    uint64_t      m_length;        /** total number of bytes added.            */
+};
+
+#endif // CONTENTHASH_H_
@@ -0,0 +1,707 @@
+/*
+ File: DirectorySnapshot.cpp
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <DirectorySnapshot.h>
+
+// Qt
+#include <QObject>
+
+// C++
+#include <limits>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <Win32WatchBackend.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const wchar_t separator = std::filesystem::path::preferred_separator;
+
+const size_t DirectorySnapshot::NO_SUBTREE = std::numeric_limits<size_t>::max();
+const size_t DirectorySnapshot::MOVED = std::numeric_limits<size_t>::max() - 1;
+
+//-----------------------------------------------------------------------------
+DirectorySnapshot::DirectorySnapshot(const std::filesystem::path &directory, bool recursive)
+: m_directory{directory}
+, m_recursive{recursive}
+{
+}
+
+//-----------------------------------------------------------------------------
+bool DirectorySnapshot::scan(QString &error)
+{
+  m_directories.clear();
+  m_renamed.clear();
+  m_stale.clear();
+
+  return scanDirectory(std::wstring(), error);
+}
+
+//-----------------------------------------------------------------------------
+bool DirectorySnapshot::scanDirectory(const std::wstring &relative, QString &error)
+{
+  std::vector<std::wstring> pending{relative};
+
+  while(!pending.empty())
+  {
+    const auto directory = std::move(pending.back());
+    pending.pop_back();
+
+    Entries entries;
+    QString readError;
+    if(!readDirectory(m_directory / directory, entries, readError))
+    {
+      // subdirectories can be removed while scanning, only the first one is an error.
+      if(directory == relative)
+      {
+        error = readError;
+        return false;
+      }
+      continue;
+    }
+
+    if(m_recursive)
+    {
+      for(const auto &[name, entry]: entries)
+      {
+        if(entry.isDirectory) pending.push_back(join(directory, name));
+      }
+    }
+
+    m_directories[directory] = std::move(entries);
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool DirectorySnapshot::rescan(const Callback &callback, QString &error)
+{
+  /** \struct Pending
+   * \brief Directory to compare with its recorded entries.
+   *
+   */
+  struct Pending
+  {
+    std::wstring path;     /** path of the directory.                   */
+    bool         recorded; /** false if the directory was not recorded. */
+  };
+
+  // Every directory is compared and replaced at once, the memory is the one of the recorded tree plus
+  // the entries that appeared or disappeared, kept until the end to pair the ones moved between directories.
+  std::vector<Candidate> removed, added;
+  std::vector<Subtree> subtrees;
+  std::vector<Pending> pending{ Pending{std::wstring(), true} };
+
+  while(!pending.empty())
+  {
+    while(!pending.empty())
+    {
+      const auto directory = std::move(pending.back());
+      pending.pop_back();
+
+      Entries current;
+      QString readError;
+      if(!readDirectory(m_directory / directory.path, current, readError))
+      {
+        // subdirectories can be removed while scanning, only the watched one is an error. The recorded
+        // entries are kept, the next rescan reports their removal.
+        if(directory.path.empty())
+        {
+          error = readError;
+          return false;
+        }
+        continue;
+      }
+
+      Entries recorded;
+      if(directory.recorded)
+      {
+        const auto it = m_directories.find(directory.path);
+        if(it != m_directories.end()) recorded = std::move(it->second);
+      }
+
+      auto removeCandidate = [&](const std::wstring &entryName, const Entry &entry)
+      {
+        const auto name = join(directory.path, entryName);
+
+        // the recorded subtree is needed to follow the directory if moved, or to report its removal.
+        auto subtree = NO_SUBTREE;
+        if(m_recursive && entry.isDirectory)
+        {
+          subtree = subtrees.size();
+          subtrees.push_back(detachSubtree(name));
+        }
+
+        removed.push_back(Candidate{name, entry.fileId, entry.created, entry.isDirectory, subtree, false});
+      };
+
+      auto addCandidate = [&](const std::wstring &entryName, const Entry &entry)
+      {
+        added.push_back(Candidate{join(directory.path, entryName), entry.fileId, entry.created, entry.isDirectory, NO_SUBTREE, false});
+      };
+
+      // the recorded entries left once the current ones are looked up are the removed ones.
+      for(const auto &[name, c]: current)
+      {
+        const auto found = recorded.find(name);
+        if(found == recorded.end())
+        {
+          addCandidate(name, c);
+          continue;
+        }
+
+        // the changes of a stale or unknown entry were notified, only its data is outdated.
+        const auto &r = found->second;
+        const bool outdated = r.stale || !r.known;
+        if(!outdated && (r.isDirectory != c.isDirectory || r.fileId != c.fileId || r.created != c.created))
+        {
+          removeCandidate(name, r);
+          addCandidate(name, c);
+        }
+        else
+        {
+          if(!outdated)
+          {
+            const auto properties = compare(r, c);
+            if(properties != Properties::OTHER) callback(join(directory.path, name), Events::MODIFIED, properties);
+          }
+
+          if(m_recursive && c.isDirectory) pending.push_back(Pending{join(directory.path, name), true});
+        }
+
+        recorded.erase(found);
+      }
+
+      for(const auto &[name, r]: recorded) removeCandidate(name, r);
+
+      m_directories[directory.path] = std::move(current);
+    }
+
+    // Entries that kept their identifier were moved, identifiers can be reused after a removal. A moved
+    // directory is compared with its recorded subtree, a new one is scanned and its entries can be moved
+    // ones too.
+    std::unordered_map<unsigned long long, size_t> removedIds;
+    for(size_t i = 0; i < removed.size(); ++i)
+    {
+      if(!removed[i].done && removed[i].fileId != 0) removedIds.emplace(removed[i].fileId, i);
+    }
+
+    for(auto &candidate: added)
+    {
+      if(candidate.done) continue;
+      candidate.done = true;
+
+      const auto found = candidate.fileId != 0 ? removedIds.find(candidate.fileId) : removedIds.end();
+      if(found != removedIds.end() && !removed[found->second].done && removed[found->second].isDirectory == candidate.isDirectory &&
+         removed[found->second].created == candidate.created)
+      {
+        auto &source = removed[found->second];
+        source.done = true;
+        candidate.subtree = MOVED;
+
+        callback(source.name, Events::RENAMED_OLD, Properties::NONE);
+        callback(candidate.name, Events::RENAMED_NEW, Properties::NONE);
+
+        if(source.subtree != NO_SUBTREE)
+        {
+          attachSubtree(subtrees[source.subtree], candidate.name);
+          pending.push_back(Pending{candidate.name, true});
+        }
+        continue;
+      }
+
+      if(m_recursive && candidate.isDirectory) pending.push_back(Pending{candidate.name, false});
+    }
+  }
+
+  for(const auto &candidate: removed)
+  {
+    if(candidate.done) continue;
+
+    if(candidate.subtree != NO_SUBTREE) reportRemoved(subtrees[candidate.subtree], candidate.name, callback);
+    callback(candidate.name, Events::REMOVED, Properties::NONE);
+  }
+
+  for(const auto &candidate: added)
+  {
+    if(candidate.subtree != MOVED) callback(candidate.name, Events::ADDED, Properties::NONE);
+  }
+
+  m_renamed.clear();
+  m_stale.clear();
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+DirectorySnapshot::Subtree DirectorySnapshot::detachSubtree(const std::wstring &name)
+{
+  Subtree subtree;
+  std::vector<std::wstring> pending{std::wstring()};
+
+  while(!pending.empty())
+  {
+    const auto relative = std::move(pending.back());
+    pending.pop_back();
+
+    auto node = m_directories.extract(relative.empty() ? name : join(name, relative));
+    if(node.empty()) continue;
+
+    for(const auto &[entryName, entry]: node.mapped())
+    {
+      if(entry.isDirectory) pending.push_back(join(relative, entryName));
+    }
+
+    subtree.emplace(relative, std::move(node.mapped()));
+  }
+
+  return subtree;
+}
+
+//-----------------------------------------------------------------------------
+void DirectorySnapshot::attachSubtree(Subtree &subtree, const std::wstring &name)
+{
+  for(auto &directory: subtree)
+  {
+    m_directories[directory.first.empty() ? name : join(name, directory.first)] = std::move(directory.second);
+  }
+
+  subtree.clear();
+}
+
+//-----------------------------------------------------------------------------
+void DirectorySnapshot::reportRemoved(const Subtree &subtree, const std::wstring &name, const Callback &callback)
+{
+  std::vector<std::wstring> pending{std::wstring()};
+
+  while(!pending.empty())
+  {
+    const auto relative = std::move(pending.back());
+    pending.pop_back();
+
+    const auto it = subtree.find(relative);
+    if(it == subtree.end()) continue;
+
+    for(const auto &[entryName, entry]: it->second)
+    {
+      const auto entryRelative = join(relative, entryName);
+      if(entry.isDirectory) pending.push_back(entryRelative);
+
+      callback(join(name, entryRelative), Events::REMOVED, Properties::NONE);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void DirectorySnapshot::update(std::wstring_view changed, const Events e, const bool read)
+{
+  // reuses the capacity of the previous names instead of allocating a string for every change.
+  m_name.assign(changed);
+  const auto &name = m_name;
+
+  // the new name of a rename is always the next change, if not the old one is gone.
+  if(!m_renamed.empty() && e != Events::RENAMED_NEW)
+  {
+    removeEntry(m_renamed);
+    m_renamed.clear();
+  }
+
+  // a new entry is not read, its data stays unknown until it's modified or rescanned.
+  Entry entry{0, 0, 0, 0, 0, 0, 0, false, false, false, Properties::ALL};
+
+  switch(e)
+  {
+    case Events::RENAMED_OLD:
+      m_renamed = name;
+      return;
+    case Events::REMOVED:
+      removeEntry(name);
+      return;
+    case Events::RENAMED_NEW:
+      if(!m_renamed.empty())
+      {
+        // a rename keeps the file and its data, only the name changes.
+        const auto renamed = findEntry(m_renamed);
+        if(renamed) entry = *renamed;
+
+        if(m_recursive) moveSubtree(m_renamed, name);
+        removeEntry(m_renamed);
+        m_renamed.clear();
+      }
+      break;
+    default:
+      break;
+  }
+
+  const auto position = name.find_last_of(separator);
+  const auto parent = (position == std::wstring::npos) ? std::wstring() : name.substr(0, position);
+
+  auto it = m_directories.find(parent);
+  if(it == m_directories.end())
+  {
+    // the changes inside a new directory tell it's one, its entries are recorded from them.
+    const auto directory = m_recursive && !parent.empty() ? findEntry(parent) : nullptr;
+    if(!directory || directory->known) return;
+
+    directory->isDirectory = true;
+    it = m_directories.emplace(parent, Entries()).first;
+  }
+
+  // hashed by name, a new entry in a large directory doesn't move the rest.
+  auto &entries = it->second;
+  auto existing = entries.try_emplace((position == std::wstring::npos) ? name : name.substr(position + 1), entry);
+  if(!existing.second)
+  {
+    if(e == Events::RENAMED_NEW) existing.first->second = entry;
+    else if(read)                existing.first->second.stale = true;
+    else                         existing.first->second.known = false;
+  }
+
+  if(existing.first->second.stale && m_stale.find(name) == m_stale.end()) m_stale.insert(name);
+
+}
+
+//-----------------------------------------------------------------------------
+void DirectorySnapshot::refresh()
+{
+  std::vector<std::wstring> removed, added;
+
+  // only the changed entries are read, not the rest of their directories.
+  for(const auto &name: m_stale)
+  {
+    const auto entry = findEntry(name);
+    if(!entry || !entry->stale) continue;
+
+    const auto before = *entry;
+    if(!readEntry(m_directory / name, *entry))
+    {
+      removed.push_back(name);
+      continue;
+    }
+
+    entry->changed = before.known ? compare(before, *entry) : Properties::ALL;
+
+    if(m_recursive && entry->isDirectory && m_directories.find(name) == m_directories.end()) added.push_back(name);
+  }
+
+  m_stale.clear();
+
+  for(const auto &name: removed) removeEntry(name);
+
+  QString ignored;
+  for(const auto &name: added) scanDirectory(name, ignored);
+}
+
+//-----------------------------------------------------------------------------
+Properties DirectorySnapshot::changes(std::wstring_view name)
+{
+  m_name.assign(name);
+
+  const auto entry = findEntry(m_name);
+  return (entry && entry->known && !entry->stale) ? entry->changed : Properties::ALL;
+}
+
+//-----------------------------------------------------------------------------
+Properties DirectorySnapshot::compare(const Entry &before, const Entry &after)
+{
+  auto result = Properties::NONE;
+  if(before.size != after.size)             result |= Properties::SIZE;
+  if(before.time != after.time)             result |= Properties::WRITE_TIME;
+  if(before.attributes != after.attributes) result |= Properties::ATTRIBUTES;
+
+#ifdef _WIN32
+  // the change time also changes with the other properties, alone it's a change of the security.
+  if(before.security != after.security && result == Properties::NONE) result |= Properties::SECURITY;
+#else
+  if(before.security != after.security || before.permissions != after.permissions) result |= Properties::SECURITY;
+#endif
+
+  return result == Properties::NONE ? Properties::OTHER : result;
+}
+
+//-----------------------------------------------------------------------------
+DirectorySnapshot::Entry *DirectorySnapshot::findEntry(const std::wstring &name)
+{
+  const auto position = name.find_last_of(separator);
+  const auto parent = (position == std::wstring::npos) ? std::wstring() : name.substr(0, position);
+  const auto leaf = (position == std::wstring::npos) ? name : name.substr(position + 1);
+
+  auto it = m_directories.find(parent);
+  if(it == m_directories.end()) return nullptr;
+
+  const auto existing = it->second.find(leaf);
+  return (existing != it->second.end()) ? &existing->second : nullptr;
+}
+
+//-----------------------------------------------------------------------------
+void DirectorySnapshot::removeEntry(const std::wstring &name)
+{
+  const auto position = name.find_last_of(separator);
+  const auto parent = (position == std::wstring::npos) ? std::wstring() : name.substr(0, position);
+  const auto leaf = (position == std::wstring::npos) ? name : name.substr(position + 1);
+
+  auto it = m_directories.find(parent);
+  if(it != m_directories.end()) it->second.erase(leaf);
+
+  std::vector<std::wstring> pending{name};
+  while(!pending.empty())
+  {
+    const auto directory = std::move(pending.back());
+    pending.pop_back();
+
+    const auto subtree = m_directories.find(directory);
+    if(subtree == m_directories.end()) continue;
+
+    for(const auto &[entryName, entry]: subtree->second)
+    {
+      if(entry.isDirectory) pending.push_back(join(directory, entryName));
+    }
+
+    m_directories.erase(subtree);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void DirectorySnapshot::moveSubtree(const std::wstring &from, const std::wstring &to)
+{
+  std::vector<std::wstring> pending{from};
+  std::vector<decltype(m_directories)::node_type> nodes;
+
+  while(!pending.empty())
+  {
+    const auto directory = std::move(pending.back());
+    pending.pop_back();
+
+    auto node = m_directories.extract(directory);
+    if(node.empty()) continue;
+
+    for(const auto &[entryName, entry]: node.mapped())
+    {
+      if(entry.isDirectory) pending.push_back(join(directory, entryName));
+    }
+
+    node.key() = to + directory.substr(from.size());
+    nodes.push_back(std::move(node));
+  }
+
+  for(auto &node: nodes) m_directories.insert(std::move(node));
+}
+
+//-----------------------------------------------------------------------------
+unsigned long long DirectorySnapshot::size() const
+{
+  unsigned long long count = 0;
+  for(const auto &directory: m_directories) count += directory.second.size();
+
+  return count;
+}
+
+//-----------------------------------------------------------------------------
+std::wstring DirectorySnapshot::join(const std::wstring &directory, const std::wstring &name)
+{
+  if(directory.empty()) return name;
+
+  std::wstring result;
+  result.reserve(directory.size() + name.size() + 1);
+  result.append(directory).append(1, separator).append(name);
+
+  return result;
+}
+
+#ifdef _WIN32
+
+//-----------------------------------------------------------------------------
+bool DirectorySnapshot::readDirectory(const std::filesystem::path &directory, Entries &entries, QString &error)
+{
+  const auto handle = CreateFileW(directory.wstring().c_str(),
+                                  FILE_LIST_DIRECTORY,
+                                  FILE_SHARE_READ | FILE_SHARE_DELETE | FILE_SHARE_WRITE,
+                                  nullptr,
+                                  OPEN_EXISTING,
+                                  FILE_FLAG_BACKUP_SEMANTICS,
+                                  nullptr);
+
+  if(handle == INVALID_HANDLE_VALUE)
+  {
+    const auto errorString = Win32WatchBackend::getLastErrorString(GetLastError());
+    error = QObject::tr("Unable to open directory '%1'. Error: %2").arg(QString::fromStdWString(directory.wstring())).arg(errorString);
+    return false;
+  }
+
+  entries.clear();
+
+  // the entries are retrieved in blocks, with their identifiers, without opening them.
+  std::vector<BYTE> buffer(65536);
+  auto informationClass = FileIdBothDirectoryRestartInfo;
+  while(GetFileInformationByHandleEx(handle, informationClass, buffer.data(), static_cast<DWORD>(buffer.size())))
+  {
+    informationClass = FileIdBothDirectoryInfo;
+
+    auto information = reinterpret_cast<const FILE_ID_BOTH_DIR_INFO*>(buffer.data());
+    do
+    {
+      const std::wstring name{ information->FileName, information->FileNameLength / sizeof(information->FileName[0]) };
+      if(name != L"." && name != L"..")
+      {
+        const auto attributes = information->FileAttributes;
+
+        Entry entry;
+        entry.size = information->EndOfFile.QuadPart;
+        entry.time = information->LastWriteTime.QuadPart;
+        entry.created = information->CreationTime.QuadPart;
+        entry.fileId = information->FileId.QuadPart;
+        entry.attributes = attributes;
+        entry.security = information->ChangeTime.QuadPart;
+        entry.permissions = 0;
+        entry.isDirectory = (attributes & FILE_ATTRIBUTE_DIRECTORY) && !(attributes & FILE_ATTRIBUTE_REPARSE_POINT);
+        entry.stale = false;
+        entry.known = true;
+        entry.changed = Properties::NONE;
+        entries.emplace(name, entry);
+      }
+
+      if (information->NextEntryOffset == 0) break;
+
+      information = reinterpret_cast<const FILE_ID_BOTH_DIR_INFO*>(reinterpret_cast<const BYTE*>(information) + information->NextEntryOffset);
+    } while (true);
+  }
+
+  const auto errorCode = GetLastError();
+  CloseHandle(handle);
+
+  if(errorCode != ERROR_NO_MORE_FILES)
+  {
+    const auto errorString = Win32WatchBackend::getLastErrorString(errorCode);
+    error = QObject::tr("Unable to read directory '%1'. Error: %2").arg(QString::fromStdWString(directory.wstring())).arg(errorString);
+    return false;
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool DirectorySnapshot::readEntry(const std::filesystem::path &path, Entry &entry)
+{
+  const auto handle = CreateFileW(path.wstring().c_str(),
+                                  FILE_READ_ATTRIBUTES,
+                                  FILE_SHARE_READ | FILE_SHARE_DELETE | FILE_SHARE_WRITE,
+                                  nullptr,
+                                  OPEN_EXISTING,
+                                  FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OPEN_REPARSE_POINT,
+                                  nullptr);
+
+  if(handle == INVALID_HANDLE_VALUE) return false;
+
+  // the change time is only in the basic information.
+  BY_HANDLE_FILE_INFORMATION information;
+  FILE_BASIC_INFO basic;
+  const auto result = GetFileInformationByHandle(handle, &information) &&
+                      GetFileInformationByHandleEx(handle, FileBasicInfo, &basic, sizeof(basic));
+  CloseHandle(handle);
+
+  if(!result) return false;
+
+  const auto attributes = information.dwFileAttributes;
+  entry.size = (static_cast<unsigned long long>(information.nFileSizeHigh) << 32) | information.nFileSizeLow;
+  entry.time = (static_cast<long long>(information.ftLastWriteTime.dwHighDateTime) << 32) | information.ftLastWriteTime.dwLowDateTime;
+  entry.created = (static_cast<long long>(information.ftCreationTime.dwHighDateTime) << 32) | information.ftCreationTime.dwLowDateTime;
+  entry.fileId = (static_cast<unsigned long long>(information.nFileIndexHigh) << 32) | information.nFileIndexLow;
+  entry.attributes = attributes;
+  entry.security = basic.ChangeTime.QuadPart;
+  entry.permissions = 0;
+  entry.isDirectory = (attributes & FILE_ATTRIBUTE_DIRECTORY) && !(attributes & FILE_ATTRIBUTE_REPARSE_POINT);
+  entry.stale = false;
+  entry.known = true;
+  entry.changed = Properties::NONE;
+
+  return true;
+}
+
+#else
+
+//-----------------------------------------------------------------------------
+bool DirectorySnapshot::readDirectory(const std::filesystem::path &directory, Entries &entries, QString &error)
+{
+  const auto fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  auto dir = (fd == -1) ? nullptr : fdopendir(fd);
+
+  if(!dir)
+  {
+    const auto errorString = QString::fromLocal8Bit(strerror(errno));
+    error = QObject::tr("Unable to open directory '%1'. Error: %2").arg(QString::fromStdWString(directory.wstring())).arg(errorString);
+    if(fd != -1) close(fd);
+    return false;
+  }
+
+  entries.clear();
+
+  struct dirent *dirEntry = nullptr;
+  while((dirEntry = readdir(dir)) != nullptr)
+  {
+    if(strcmp(dirEntry->d_name, ".") == 0 || strcmp(dirEntry->d_name, "..") == 0) continue;
+
+    // relative to the directory descriptor to avoid resolving the full path for every entry.
+    Entry entry;
+    if(!readEntry(fd, dirEntry->d_name, entry)) continue;
+
+    entries.emplace(std::filesystem::path(dirEntry->d_name).wstring(), entry);
+  }
+
+  closedir(dir);
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool DirectorySnapshot::readEntry(const std::filesystem::path &path, Entry &entry)
+{
+  return readEntry(AT_FDCWD, path.c_str(), entry);
+}
+
+//-----------------------------------------------------------------------------
+bool DirectorySnapshot::readEntry(const int directoryFd, const char *name, Entry &entry)
+{
+  // statx() also returns the creation time, if the filesystem records it.
+  struct statx information;
+  if(statx(directoryFd, name, AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC, STATX_BASIC_STATS | STATX_BTIME, &information) != 0) return false;
+
+  entry.size = information.stx_size;
+  entry.time = information.stx_mtime.tv_sec * 1000000000LL + information.stx_mtime.tv_nsec;
+  entry.created = (information.stx_mask & STATX_BTIME) ? information.stx_btime.tv_sec * 1000000000LL + information.stx_btime.tv_nsec : 0;
+  entry.fileId = information.stx_ino;
+  entry.attributes = information.stx_attributes & information.stx_attributes_mask;
+  entry.security = (static_cast<unsigned long long>(information.stx_uid) << 32) | information.stx_gid;
+  entry.permissions = information.stx_mode & 07777;
+  entry.isDirectory = S_ISDIR(information.stx_mode);
+  entry.stale = false;
+  entry.known = true;
+  entry.changed = Properties::NONE;
+
+  return true;
+}
+
+#endif
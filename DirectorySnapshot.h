@@ -0,0 +1,247 @@
+/*
+ File: DirectorySnapshot.h
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DIRECTORYSNAPSHOT_H_
+#define DIRECTORYSNAPSHOT_H_
+
+// Project
+#include <Events.h>
+
+// Qt
+#include <QString>
+
+// C++
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/** \class DirectorySnapshot
+ * \brief Records the name, size, modification time and file identifier of the entries of a
+ * watched directory and, if recursive, of its subtree. When notifications are lost the directory
+ * is scanned again and the differences with the snapshot are reported as the changes that
+ * would have been notified. The entries are stored and compared one directory at a time.
+ * The notified changes don't read the filesystem: new entries are recorded with unknown data,
+ * a renamed entry keeps its recorded data and modified entries are either marked as stale, to be
+ * read again at once by refresh() that compares the data to tell which properties changed, or
+ * marked as unknown when the changed properties are not needed.
+ *
+ */
+class DirectorySnapshot
+{
+  public:
+    using Callback = std::function<void(const std::wstring &name, const Events e, const Properties properties)>;
+
+    /** \brief DirectorySnapshot class constructor.
+     * \param[in] directory Path of the watched directory.
+     * \param[in] recursive True to record the directory subtree, false to only record the directory entries.
+     *
+     */
+    explicit DirectorySnapshot(const std::filesystem::path &directory, bool recursive);
+
+    /** \brief Records the current state of the directory. Returns true on success and false otherwise.
+     * \param[out] error Error message in case of failure.
+     *
+     */
+    bool scan(QString &error);
+
+    /** \brief Scans the directory again and calls the callback for every difference with the recorded
+     * state, that is replaced by the new one. Entries that kept their file identifier but changed their
+     * name are reported as renames. Returns true on success and false otherwise.
+     * \param[in] callback Receives the name of the changed entry relative to the directory, the event and
+     * the changed properties if it's a modification.
+     * \param[out] error Error message in case of failure.
+     *
+     */
+    bool rescan(const Callback &callback, QString &error);
+
+    /** \brief Updates the recorded state with a notified change without reading the filesystem.
+     * \param[in] name Name of the changed entry relative to the directory.
+     * \param[in] e Event.
+     * \param[in] read True to read a modified entry in the next refresh to tell its changed properties,
+     * false to only mark its data as unknown.
+     *
+     */
+    void update(std::wstring_view name, const Events e, const bool read);
+
+    /** \brief Reads again the entries marked as stale by the notified changes.
+     *
+     */
+    void refresh();
+
+    /** \brief Returns the properties of the entry that changed in the last refresh, or all of them if
+     * unknown.
+     * \param[in] name Name of the entry relative to the directory.
+     *
+     */
+    Properties changes(std::wstring_view name);
+
+    /** \brief Returns true if there are entries to refresh.
+     *
+     */
+    bool isStale() const
+    { return !m_stale.empty(); }
+
+    /** \brief Returns the number of recorded entries.
+     *
+     */
+    unsigned long long size() const;
+
+  private:
+    /** \struct Entry
+     * \brief Data of a directory entry.
+     *
+     */
+    struct Entry
+    {
+      unsigned long long size;        /** size in bytes.                                           */
+      long long          time;        /** last modification time.                                  */
+      long long          created;     /** creation time, tells apart reused identifiers, 0 if none. */
+      unsigned long long fileId;      /** identifier of the file in the volume, 0 if none.         */
+      unsigned long long attributes;  /** file attributes.                                         */
+      unsigned long long security;    /** user and group identifiers, or last metadata change time
+                                          on Windows where they can't be read from the directory.  */
+      unsigned int       permissions; /** permission bits of the mode, 0 on Windows.               */
+      bool               isDirectory; /** true if the entry is a directory to descend into.        */
+      bool               stale;       /** true if changed since last read, the data is outdated.   */
+      bool               known;       /** false if never read, the data is unknown.                */
+      Properties         changed;     /** properties changed in the last refresh.                  */
+    };
+
+    using Entries = std::unordered_map<std::wstring, Entry>;   /** entries of a directory by name.                 */
+    using Subtree = std::unordered_map<std::wstring, Entries>; /** directories by path relative to a subtree root. */
+
+    /** \struct Candidate
+     * \brief Entry that appeared or disappeared during a rescan, a rename if its file identifier appears
+     * on both sides.
+     *
+     */
+    struct Candidate
+    {
+      std::wstring       name;        /** name relative to the watched directory.                     */
+      unsigned long long fileId;      /** identifier of the file in the volume.                       */
+      long long          created;     /** creation time of the file.                                  */
+      bool               isDirectory; /** true if the entry is a directory.                           */
+      size_t             subtree;     /** index of the recorded subtree of a removed directory,
+                                          NO_SUBTREE if none, or MOVED if an added entry was moved.   */
+      bool               done;        /** true once paired or, if added, once looked for a pair.      */
+    };
+
+    static const size_t NO_SUBTREE; /** candidate without recorded subtree.        */
+    static const size_t MOVED;      /** added candidate paired with a removed one. */
+
+    /** \brief Records the given directory and, if recursive, its subtree. Returns true on success and false
+     * if the directory can't be read. Unreadable subdirectories are not recorded.
+     * \param[in] relative Path of the directory relative to the watched one.
+     * \param[out] error Error message in case of failure.
+     *
+     */
+    bool scanDirectory(const std::wstring &relative, QString &error);
+
+    /** \brief Returns the properties that differ between the data of two reads of an entry.
+     * \param[in] before Data of the entry in the first read.
+     * \param[in] after Data of the entry in the second read.
+     *
+     */
+    static Properties compare(const Entry &before, const Entry &after);
+
+    /** \brief Returns the recorded entry with the given name or nullptr if not recorded.
+     * \param[in] name Name of the entry relative to the watched directory.
+     *
+     */
+    Entry *findEntry(const std::wstring &name);
+
+    /** \brief Removes the entry with the given name and the recorded subtree if it's a directory.
+     * \param[in] name Name of the entry relative to the watched directory.
+     *
+     */
+    void removeEntry(const std::wstring &name);
+
+    /** \brief Moves the recorded subtree of a renamed directory.
+     * \param[in] from Old name of the directory relative to the watched one.
+     * \param[in] to New name of the directory relative to the watched one.
+     *
+     */
+    void moveSubtree(const std::wstring &from, const std::wstring &to);
+
+    /** \brief Removes the recorded subtree of the given directory from the snapshot and returns it.
+     * \param[in] name Name of the directory relative to the watched one.
+     *
+     */
+    Subtree detachSubtree(const std::wstring &name);
+
+    /** \brief Records the given subtree as the one of the given directory. The subtree is left empty.
+     * \param[in] subtree Detached subtree.
+     * \param[in] name Name of the directory relative to the watched one.
+     *
+     */
+    void attachSubtree(Subtree &subtree, const std::wstring &name);
+
+    /** \brief Calls the callback for the removal of every entry of the given detached subtree.
+     * \param[in] subtree Detached subtree.
+     * \param[in] name Name of the directory of the subtree relative to the watched one.
+     * \param[in] callback Receives the changes.
+     *
+     */
+    static void reportRemoved(const Subtree &subtree, const std::wstring &name, const Callback &callback);
+
+    /** \brief Reads the entries of the given directory. Returns true on success and false otherwise.
+     * \param[in] directory Path of the directory.
+     * \param[out] entries Entries of the directory.
+     * \param[out] error Error message in case of failure.
+     *
+     */
+    static bool readDirectory(const std::filesystem::path &directory, Entries &entries, QString &error);
+
+    /** \brief Reads the data of a single entry. Returns true on success and false otherwise.
+     * \param[in] path Path of the entry.
+     * \param[out] entry Entry data.
+     *
+     */
+    static bool readEntry(const std::filesystem::path &path, Entry &entry);
+
+#ifndef _WIN32
+    /** \brief Reads the data of a single entry. Returns true on success and false otherwise.
+     * \param[in] directoryFd Descriptor of the directory of the entry.
+     * \param[in] name Name of the entry in the directory.
+     * \param[out] entry Entry data.
+     *
+     */
+    static bool readEntry(const int directoryFd, const char *name, Entry &entry);
+#endif
+
+    /** \brief Returns the name of 'name' inside the 'directory', both relative to the watched directory.
+     * \param[in] directory Relative path of a directory, empty for the watched one.
+     * \param[in] name Name of the entry.
+     *
+     */
+    static std::wstring join(const std::wstring &directory, const std::wstring &name);
+
+    std::filesystem::path                     m_directory;   /** path of the watched directory.                       */
+    bool                                      m_recursive;   /** true to record the directory subtree.                */
+    std::unordered_map<std::wstring, Entries> m_directories; /** relative path of a directory to its entries.         */
+    std::wstring                              m_renamed;     /** old name of the entry of a pending rename, if any.   */
+    std::wstring                              m_name;        /** name of the last updated entry.                      */
+    std::unordered_set<std::wstring>          m_stale;       /** names of the entries changed since last read.        */
+};
+
+#endif // DIRECTORYSNAPSHOT_H_
@@ -0,0 +1,167 @@
+/*
+ File: EventBatch.h
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EVENTBATCH_H_
+#define EVENTBATCH_H_
+
+// Project
+#include <Events.h>
+
+// C++
+#include <string>
+#include <string_view>
+#include <vector>
+
+/** \struct Event
+ * \brief A change of a watched object. The paths are views of the batch that contains it.
+ *
+ */
+struct Event
+{
+  std::wstring_view object;     /** path of the changed object, the new path if renamed.      */
+  std::wstring_view oldName;    /** old path of the object if renamed, empty otherwise.       */
+  Events            event;      /** event.                                                    */
+  unsigned long     count;      /** number of merged events.                                  */
+  Properties        properties; /** changed properties of a modification.                     */
+  long long         time;       /** microseconds since the epoch when notified, 0 if unknown. */
+  unsigned long     id;         /** identifier of the watched object, 0 if unknown.           */
+};
+
+/** \class EventBatch
+ * \brief Changes in the order they happened. The paths of all the changes are stored one after
+ * another in a single buffer, that keeps its capacity when the batch is cleared.
+ *
+ */
+class EventBatch
+{
+  public:
+    /** \class const_iterator
+     * \brief Iterator over the changes of the batch.
+     *
+     */
+    class const_iterator
+    {
+      public:
+        const_iterator(const EventBatch *batch, size_t position)
+        : m_batch{batch}, m_position{position}
+        {};
+
+        Event operator*() const
+        { return m_batch->at(m_position); }
+
+        const_iterator &operator++()
+        { ++m_position; return *this; }
+
+        bool operator!=(const const_iterator &other) const
+        { return m_position != other.m_position; }
+
+      private:
+        const EventBatch *m_batch;    /** iterated batch.          */
+        size_t            m_position; /** position of the change.  */
+    };
+
+    /** \brief Adds a change to the batch.
+     * \param[in] object Path of the changed object, the new path if renamed.
+     * \param[in] oldName Old path of the object if renamed, empty otherwise.
+     * \param[in] e Event.
+     * \param[in] count Number of merged events.
+     * \param[in] properties Changed properties if it's a modification.
+     * \param[in] time Microseconds since the epoch when notified, 0 if unknown.
+     * \param[in] id Identifier of the watched object, 0 if unknown.
+     *
+     */
+    void add(std::wstring_view object, std::wstring_view oldName, const Events e, const unsigned long count,
+             const Properties properties = Properties::ALL, const long long time = 0, const unsigned long id = 0)
+    {
+      Record record;
+      record.object = m_strings.size();
+      record.objectLength = object.size();
+      m_strings.append(object);
+      record.oldName = m_strings.size();
+      record.oldNameLength = oldName.size();
+      m_strings.append(oldName);
+      record.event = e;
+      record.count = count;
+      record.properties = properties;
+      record.time = time;
+      record.id = id;
+
+      m_records.push_back(record);
+    }
+
+    /** \brief Returns the change in the given position.
+     * \param[in] position Position of the change in the batch.
+     *
+     */
+    Event at(const size_t position) const
+    {
+      const auto &record = m_records.at(position);
+      const std::wstring_view strings{m_strings};
+
+      return Event{strings.substr(record.object, record.objectLength), strings.substr(record.oldName, record.oldNameLength),
+                   record.event, record.count, record.properties, record.time, record.id};
+    }
+
+    /** \brief Returns the number of changes in the batch.
+     *
+     */
+    size_t size() const
+    { return m_records.size(); }
+
+    /** \brief Returns true if the batch has no changes.
+     *
+     */
+    bool empty() const
+    { return m_records.empty(); }
+
+    /** \brief Removes the changes, keeping the allocated memory.
+     *
+     */
+    void clear()
+    { m_records.clear(); m_strings.clear(); }
+
+    const_iterator begin() const
+    { return const_iterator(this, 0); }
+
+    const_iterator end() const
+    { return const_iterator(this, m_records.size()); }
+
+  private:
+    /** \struct Record
+     * \brief A change with the position of its paths in the strings buffer.
+     *
+     */
+    struct Record
+    {
+      size_t        object;        /** position of the object path.    */
+      size_t        objectLength;  /** length of the object path.      */
+      size_t        oldName;       /** position of the old path.       */
+      size_t        oldNameLength; /** length of the old path.         */
+      Events        event;         /** event.                          */
+      unsigned long count;         /** number of merged events.        */
+      Properties    properties;    /** changed properties.             */
+      long long     time;          /** notification time.              */
+      unsigned long id;            /** watched object identifier.      */
+    };
+
+    std::vector<Record> m_records; /** changes in order.                     */
+    std::wstring        m_strings; /** paths of the changes, one after another. */
+};
+
+#endif // EVENTBATCH_H_
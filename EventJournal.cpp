@@ -0,0 +1,333 @@
+/*
+ File: EventJournal.cpp
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <EventJournal.h>
+
+// Qt
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+
+// C++
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+const QString SEGMENT_PREFIX = "journal-";
+const QString SEGMENT_SUFFIX = ".fwj";
+
+const long long MINIMUM_SEGMENT_SIZE = 1024ll * 1024; /** smallest segment, fits the longest path. */
+
+//-----------------------------------------------------------------------------
+EventJournal::EventJournal(const QString &directory, const long long segmentSize, const long long maximumSize, const long long maximumAge,
+                           QObject *p)
+: QThread{p}
+, m_directory{directory}
+, m_segmentSize{std::max(MINIMUM_SEGMENT_SIZE, segmentSize)}
+, m_maximumSize{std::max(0ll, maximumSize)}
+, m_maximumAge{std::max(0ll, maximumAge)}
+, m_queue{DEFAULT_QUEUE_CAPACITY, EventRing::Overflow::DROP_NEWEST}
+, m_segment{nullptr}
+, m_used{0}
+, m_sequence{0}
+, m_written{0}
+, m_aborted{false}
+, m_signalled{false}
+{
+}
+
+//-----------------------------------------------------------------------------
+EventJournal::~EventJournal()
+{
+  abort();
+  wait();
+}
+
+//-----------------------------------------------------------------------------
+void EventJournal::record(const EventRing::Key object, std::wstring_view path, std::wstring_view oldName, const Events e,
+                          const unsigned long count, const Properties properties, const long long time)
+{
+  m_queue.push(object, path, oldName, e, count, properties, time);
+
+  // only the first change since the thread slept wakes it, the rest are taken with it.
+  if(!m_signalled.exchange(true)) m_wake.release();
+}
+
+//-----------------------------------------------------------------------------
+void EventJournal::abort()
+{
+  m_aborted = true;
+  m_wake.release();
+}
+
+//-----------------------------------------------------------------------------
+QStringList EventJournal::segments(const QString &directory)
+{
+  QStringList result;
+
+  // the sequence numbers have a fixed width, the names sort in creation order.
+  const QDir dir{directory};
+  const auto names = dir.entryList(QStringList{SEGMENT_PREFIX + "*" + SEGMENT_SUFFIX}, QDir::Files, QDir::Name);
+  for(const auto &name: names) result << dir.absoluteFilePath(name);
+
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+void EventJournal::run()
+{
+  QString errorString;
+
+  if(!QDir().mkpath(m_directory))
+  {
+    emit error(tr("Journal: Unable to create the directory '%1'.").arg(m_directory));
+    return;
+  }
+
+  const auto existing = segments(m_directory);
+  if(!existing.isEmpty())
+  {
+    const auto name = QFileInfo{existing.last()}.completeBaseName();
+    m_sequence = name.mid(SEGMENT_PREFIX.length()).toULongLong() + 1;
+  }
+
+  EventBatch batch;
+  std::vector<EventRing::Summary> summaries;
+
+  // the changes queued before aborting are recorded too.
+  bool finished = false;
+  while(!finished)
+  {
+    finished = m_aborted;
+
+    batch.clear();
+    if(!m_queue.drain(batch, summaries))
+    {
+      if(finished) continue;
+
+      // sleeps until record() or abort() wake it. A change queued before the flag is cleared didn't
+      // wake it again, the next drain takes it.
+      m_wake.acquire();
+      m_signalled = false;
+      continue;
+    }
+
+    for(const auto event: batch)
+    {
+      if(!write(event, errorString))
+      {
+        closeSegment();
+        emit error(tr("Journal: %1").arg(errorString));
+        return;
+      }
+    }
+
+    m_written.fetch_add(batch.size(), std::memory_order_relaxed);
+  }
+
+  closeSegment();
+}
+
+//-----------------------------------------------------------------------------
+bool EventJournal::openSegment(const long long time, QString &errorString)
+{
+  const auto name = QString("%1%2%3").arg(SEGMENT_PREFIX).arg(m_sequence, 16, 10, QChar('0')).arg(SEGMENT_SUFFIX);
+  m_file.setFileName(QDir{m_directory}.absoluteFilePath(name));
+
+  if(!m_file.open(QIODevice::ReadWrite|QIODevice::Truncate) || !m_file.resize(m_segmentSize))
+  {
+    errorString = tr("Unable to create the segment '%1': %2").arg(m_file.fileName()).arg(m_file.errorString());
+    m_file.close();
+    return false;
+  }
+
+  // the file is full of zeros, the records end at the first zero type.
+  m_segment = m_file.map(0, m_segmentSize);
+  if(!m_segment)
+  {
+    errorString = tr("Unable to map the segment '%1': %2").arg(m_file.fileName()).arg(m_file.errorString());
+    m_file.close();
+    return false;
+  }
+
+  SegmentHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+  header.version = VERSION;
+  header.headerSize = sizeof(SegmentHeader);
+  header.recordSize = sizeof(RecordHeader);
+  header.sequence = m_sequence;
+  header.created = time;
+
+  std::memcpy(m_segment, &header, sizeof(header));
+  m_used = sizeof(header);
+
+  m_ids.clear();
+  m_paths.clear();
+
+  removeOldSegments();
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void EventJournal::closeSegment()
+{
+  if(!m_segment) return;
+
+  m_file.unmap(m_segment);
+  m_segment = nullptr;
+
+  m_file.resize(m_used);
+  m_file.close();
+
+  ++m_sequence;
+}
+
+//-----------------------------------------------------------------------------
+void EventJournal::removeOldSegments()
+{
+  if(m_maximumSize == 0 && m_maximumAge == 0) return;
+
+  const QDir dir{m_directory};
+  const auto files = dir.entryInfoList(QStringList{SEGMENT_PREFIX + "*" + SEGMENT_SUFFIX}, QDir::Files, QDir::Name);
+
+  long long total = 0;
+  for(const auto &file: files) total += file.size();
+
+  const auto limit = QDateTime::currentDateTime().addSecs(-m_maximumAge);
+  for(const auto &file: files)
+  {
+    if(file.absoluteFilePath() == QFileInfo{m_file}.absoluteFilePath()) break;
+
+    const bool tooBig = m_maximumSize > 0 && total > m_maximumSize;
+    const bool tooOld = m_maximumAge > 0 && file.lastModified() < limit;
+    if(!tooBig && !tooOld) break;
+
+    if(QFile::remove(file.absoluteFilePath())) total -= file.size();
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool EventJournal::write(const Event &event, QString &errorString)
+{
+  const bool hasOldName = !event.oldName.empty();
+  auto path = find(event.object);
+  auto oldPath = hasOldName ? find(event.oldName) : NO_PATH;
+
+  if(path == NO_PATH) m_path = QString::fromWCharArray(event.object.data(), event.object.size()).toUtf8();
+  if(hasOldName && oldPath == NO_PATH) m_oldPath = QString::fromWCharArray(event.oldName.data(), event.oldName.size()).toUtf8();
+
+  auto needed = [&]()
+  {
+    auto size = sizeof(RecordHeader);
+    if(path == NO_PATH) size += recordSize(m_path);
+    if(hasOldName && oldPath == NO_PATH) size += recordSize(m_oldPath);
+
+    return static_cast<long long>(size);
+  };
+
+  if(!m_segment || m_used + needed() > m_segmentSize)
+  {
+    closeSegment();
+    if(!openSegment(event.time, errorString)) return false;
+
+    // the new segment defines its own paths.
+    if(path != NO_PATH) m_path = QString::fromWCharArray(event.object.data(), event.object.size()).toUtf8();
+    if(hasOldName && oldPath != NO_PATH) m_oldPath = QString::fromWCharArray(event.oldName.data(), event.oldName.size()).toUtf8();
+    path = NO_PATH;
+    oldPath = NO_PATH;
+
+    // only a path longer than any filesystem allows doesn't fit in an empty segment.
+    if(m_used + needed() > m_segmentSize) return true;
+  }
+
+  if(path == NO_PATH) path = define(event.object, m_path, event.time);
+  if(hasOldName && oldPath == NO_PATH) oldPath = define(event.oldName, m_oldPath, event.time);
+
+  RecordHeader header;
+  std::memset(&header, 0, sizeof(header));
+  header.time = event.time;
+  header.object = static_cast<std::uint32_t>(event.id);
+  header.path = path;
+  header.oldPath = oldPath;
+  header.count = static_cast<std::uint32_t>(std::min<unsigned long>(event.count, UINT32_MAX));
+  header.type = static_cast<std::uint16_t>(RecordType::EVENT);
+  header.event = static_cast<std::uint8_t>(event.event);
+  header.properties = static_cast<std::uint8_t>(event.properties);
+
+  append(header);
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+std::uint32_t EventJournal::find(std::wstring_view path) const
+{
+  const auto range = m_ids.equal_range(hash(path));
+  for(auto it = range.first; it != range.second; ++it)
+  {
+    if(m_paths[it->second - 1] == path) return it->second;
+  }
+
+  return NO_PATH;
+}
+
+//-----------------------------------------------------------------------------
+std::uint32_t EventJournal::define(std::wstring_view path, const QByteArray &utf8, const long long time)
+{
+  m_paths.emplace_back(path);
+  const auto id = static_cast<std::uint32_t>(m_paths.size());
+  m_ids.emplace(hash(path), id);
+
+  RecordHeader header;
+  std::memset(&header, 0, sizeof(header));
+  header.time = time;
+  header.path = id;
+  header.count = static_cast<std::uint32_t>(utf8.size());
+  header.type = static_cast<std::uint16_t>(RecordType::PATH);
+
+  append(header, utf8);
+
+  return id;
+}
+
+//-----------------------------------------------------------------------------
+void EventJournal::append(const RecordHeader &header, const QByteArray &data)
+{
+  auto record = m_segment + m_used;
+
+  // the mapped file is already zero, the padding of the data needs no writing.
+  auto incomplete = header;
+  incomplete.type = static_cast<std::uint16_t>(RecordType::END);
+  std::memcpy(record + sizeof(RecordHeader), data.constData(), data.size());
+  std::memcpy(record, &incomplete, sizeof(RecordHeader));
+
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(record + offsetof(RecordHeader, type), &header.type, sizeof(header.type));
+
+  m_used += recordSize(data);
+}
+
+//-----------------------------------------------------------------------------
+size_t EventJournal::recordSize(const QByteArray &data)
+{
+  return sizeof(RecordHeader) + ((static_cast<size_t>(data.size()) + 7) & ~static_cast<size_t>(7));
+}
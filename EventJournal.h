@@ -0,0 +1,276 @@
+/*
+ File: EventJournal.h
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EVENTJOURNAL_H_
+#define EVENTJOURNAL_H_
+
+// Project
+#include <EventBatch.h>
+#include <EventRing.h>
+#include <Events.h>
+
+// Qt
+#include <QThread>
+#include <QFile>
+#include <QSemaphore>
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+// C++
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/** \class EventJournal
+ * \brief Thread recording the changes in an append-only binary journal. The watcher threads only
+ * queue the changes in a bounded ring, the journal thread takes them and copies them to a segment
+ * file mapped in memory. Every record has a fixed size header and the paths are written once per
+ * segment and referenced by their identifier, so every segment can be read alone. When a segment
+ * is full it's truncated to its used size and a new one is started, and the oldest segments are
+ * removed when the journal is too big or they are too old.
+ *
+ */
+class EventJournal
+: public QThread
+{
+    Q_OBJECT
+  public:
+    static constexpr size_t        DEFAULT_QUEUE_CAPACITY = 65536;                /** default maximum number of queued changes. */
+    static constexpr long long     DEFAULT_SEGMENT_SIZE   = 16ll * 1024 * 1024;   /** default size of a segment in bytes.       */
+    static constexpr long long     DEFAULT_MAXIMUM_SIZE   = 256ll * 1024 * 1024;  /** default size of the journal in bytes.     */
+    static constexpr long long     DEFAULT_MAXIMUM_AGE    = 30ll * 24 * 3600;     /** default age of a segment in seconds.      */
+    static constexpr char          MAGIC[4]               = {'F', 'W', 'J', '1'}; /** identifier of the segment files.          */
+    static constexpr std::uint16_t VERSION                = 1;                    /** version of the format.                    */
+    static constexpr std::uint32_t NO_PATH                = 0;                    /** path identifier of no path.               */
+
+    /** \brief Types of the records.
+     *
+     */
+    enum class RecordType: std::uint16_t
+    {
+      END = 0, /** no more records in the segment, the rest is unused. */
+      EVENT,   /** change of an object.                                */
+      PATH     /** definition of a path identifier.                    */
+    };
+
+    /** \struct SegmentHeader
+     * \brief Header at the start of a segment file.
+     *
+     */
+    struct SegmentHeader
+    {
+      char          magic[4];   /** MAGIC.                                           */
+      std::uint16_t version;    /** VERSION.                                         */
+      std::uint16_t headerSize; /** size of this header.                             */
+      std::uint32_t recordSize; /** size of a record header.                         */
+      std::uint32_t reserved;   /** zero.                                            */
+      std::uint64_t sequence;   /** number of the segment in the journal.            */
+      std::int64_t  created;    /** microseconds since the epoch of the first write. */
+    };
+
+    /** \struct RecordHeader
+     * \brief Header of a record. An event record has no more data, a path record is followed by the
+     * UTF-8 path, padded with zeros to a multiple of eight bytes.
+     *
+     */
+    struct RecordHeader
+    {
+      std::int64_t  time;       /** microseconds since the epoch when notified.                              */
+      std::uint32_t object;     /** identifier of the watched object.                                        */
+      std::uint32_t path;       /** identifier of the changed path, or the defined one in a path record.     */
+      std::uint32_t oldPath;    /** identifier of the old path of a rename, NO_PATH otherwise.               */
+      std::uint32_t count;      /** number of merged events, or the length of the path in a path record.     */
+      std::uint16_t type;       /** RecordType, written last so a record cut by a crash reads as the end.    */
+      std::uint8_t  event;      /** Events value.                                                            */
+      std::uint8_t  properties; /** Properties value of a modification.                                      */
+      std::uint32_t reserved;   /** zero.                                                                    */
+    };
+
+    static_assert(sizeof(SegmentHeader) == 32, "Unexpected segment header size");
+    static_assert(sizeof(RecordHeader) == 32, "Unexpected record header size");
+
+    /** \brief EventJournal class constructor.
+     * \param[in] directory Path of the directory of the segment files.
+     * \param[in] segmentSize Size of a segment in bytes.
+     * \param[in] maximumSize Size of the journal in bytes, 0 for no limit.
+     * \param[in] maximumAge Age of a segment in seconds, 0 for no limit.
+     * \param[in] p Raw pointer of the object parent of this one.
+     *
+     */
+    explicit EventJournal(const QString &directory, const long long segmentSize = DEFAULT_SEGMENT_SIZE,
+                          const long long maximumSize = DEFAULT_MAXIMUM_SIZE, const long long maximumAge = DEFAULT_MAXIMUM_AGE,
+                          QObject *p = nullptr);
+
+    /** \brief EventJournal class virtual destructor. Stops the thread.
+     *
+     */
+    virtual ~EventJournal();
+
+    /** \brief Queues the change to be recorded. Can be called from any thread.
+     * \param[in] object Identifier of the watched object.
+     * \param[in] path Path of the changed object, the new path if renamed.
+     * \param[in] oldName Old path of the object if renamed, empty otherwise.
+     * \param[in] e Event.
+     * \param[in] count Number of merged events.
+     * \param[in] properties Changed properties if it's a modification.
+     * \param[in] time Microseconds since the epoch when notified.
+     *
+     */
+    void record(const EventRing::Key object, std::wstring_view path, std::wstring_view oldName, const Events e,
+                const unsigned long count, const Properties properties, const long long time);
+
+    /** \brief Stops the thread after recording the queued changes.
+     *
+     */
+    void abort();
+
+    /** \brief Returns the number of changes not recorded because the queue was full.
+     *
+     */
+    unsigned long long dropped() const
+    { return m_queue.dropped(); }
+
+    /** \brief Returns the number of recorded changes.
+     *
+     */
+    unsigned long long written() const
+    { return m_written.load(std::memory_order_relaxed); }
+
+    /** \brief Returns the path of the directory of the segment files.
+     *
+     */
+    const QString &directory() const
+    { return m_directory; }
+
+    /** \brief Returns the size of a segment in bytes.
+     *
+     */
+    long long segmentSize() const
+    { return m_segmentSize; }
+
+    /** \brief Returns the size of the journal in bytes, 0 for no limit.
+     *
+     */
+    long long maximumSize() const
+    { return m_maximumSize; }
+
+    /** \brief Returns the age of a segment in seconds, 0 for no limit.
+     *
+     */
+    long long maximumAge() const
+    { return m_maximumAge; }
+
+    /** \brief Returns the paths of the segment files of the journal in the directory, oldest first.
+     * \param[in] directory Path of the directory of the segment files.
+     *
+     */
+    static QStringList segments(const QString &directory);
+
+  signals:
+    void error(const QString message);
+
+  protected:
+    virtual void run() override;
+
+  private:
+    /** \brief Creates the next segment file and maps it. Returns true on success and false otherwise.
+     * \param[in] time Microseconds since the epoch of the first write.
+     * \param[out] errorString Error message if it fails.
+     *
+     */
+    bool openSegment(const long long time, QString &errorString);
+
+    /** \brief Unmaps the current segment and truncates it to its used size.
+     *
+     */
+    void closeSegment();
+
+    /** \brief Removes the oldest segments while the journal is too big or they are too old. The
+     * current segment is never removed.
+     *
+     */
+    void removeOldSegments();
+
+    /** \brief Writes the records of the change and the definitions of its new paths. Returns true
+     * on success and false otherwise.
+     * \param[in] event Change.
+     * \param[out] errorString Error message if it fails.
+     *
+     */
+    bool write(const Event &event, QString &errorString);
+
+    /** \brief Returns the identifier of the path in the current segment, or NO_PATH if not defined.
+     * \param[in] path Path.
+     *
+     */
+    std::uint32_t find(std::wstring_view path) const;
+
+    /** \brief Writes the definition of the path and returns its identifier. There must be space for it.
+     * \param[in] path Path.
+     * \param[in] utf8 UTF-8 encoded path.
+     * \param[in] time Microseconds since the epoch of the change.
+     *
+     */
+    std::uint32_t define(std::wstring_view path, const QByteArray &utf8, const long long time);
+
+    /** \brief Copies the record to the segment. There must be space for it.
+     * \param[in] header Record header, its type is written last.
+     * \param[in] data Data following the header.
+     *
+     */
+    void append(const RecordHeader &header, const QByteArray &data = QByteArray());
+
+    /** \brief Returns the size in the segment of a record followed by the data.
+     * \param[in] data Data following the header.
+     *
+     */
+    static size_t recordSize(const QByteArray &data);
+
+    /** \brief Returns the hash of the path.
+     * \param[in] path Path.
+     *
+     */
+    static size_t hash(std::wstring_view path)
+    { return std::hash<std::wstring_view>()(path); }
+
+    const QString                                  m_directory;   /** directory of the segment files.               */
+    const long long                                m_segmentSize; /** size of a segment in bytes.                   */
+    const long long                                m_maximumSize; /** size of the journal in bytes, 0 for no limit. */
+    const long long                                m_maximumAge;  /** age of a segment in seconds, 0 for no limit.  */
+    EventRing                                      m_queue;       /** changes not yet recorded.                     */
+    QFile                                          m_file;        /** current segment file.                         */
+    uchar                                         *m_segment;     /** memory of the current segment.                */
+    long long                                      m_used;        /** bytes used of the current segment.            */
+    unsigned long long                             m_sequence;    /** number of the current segment.                */
+    std::unordered_multimap<size_t, std::uint32_t> m_ids;         /** hash of a path to the identifiers of the
+                                                                      paths with that hash in the segment.           */
+    std::vector<std::wstring>                      m_paths;       /** paths of the segment by identifier minus one. */
+    QByteArray                                     m_path;        /** buffer of the UTF-8 changed path.             */
+    QByteArray                                     m_oldPath;     /** buffer of the UTF-8 old path.                 */
+    std::atomic<unsigned long long>                m_written;     /** number of recorded changes.                   */
+    std::atomic<bool>                              m_aborted;     /** true to stop the thread, false otherwise.     */
+    QSemaphore                                     m_wake;        /** wakes the thread when there are changes.      */
+    std::atomic<bool>                              m_signalled;   /** true if woken since the thread last slept.    */
+};
+
+#endif // EVENTJOURNAL_H_
@@ -0,0 +1,205 @@
+/*
+ File: EventRing.cpp
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <EventRing.h>
+
+// Qt
+#include <QMutexLocker>
+
+// C++
+#include <algorithm>
+#include <thread>
+
+//-----------------------------------------------------------------------------
+static size_t roundCapacity(const size_t capacity)
+{
+  size_t result = 2;
+  while(result < capacity) result <<= 1;
+
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+EventRing::EventRing(const size_t capacity, const Overflow overflow)
+: m_slots{new Slot[roundCapacity(capacity)]}
+, m_mask{roundCapacity(capacity) - 1}
+, m_overflow{overflow}
+, m_head{0}
+, m_tail{0}
+, m_dropped{0}
+, m_collapsed{0}
+, m_summarized{false}
+{
+  for(size_t i = 0; i <= m_mask; ++i) m_slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+void EventRing::push(const Key key, std::wstring_view object, std::wstring_view oldName, const Events e, const unsigned long count,
+                     const Properties properties, const long long time)
+{
+  while(!tryPush(key, object, oldName, e, count, properties, time))
+  {
+    switch(m_overflow)
+    {
+      case Overflow::DROP_OLDEST:
+        {
+          size_t position;
+          auto slot = claim(position);
+          if(slot)
+          {
+            release(*slot, position);
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+          }
+          else
+          {
+            // the consumer holds the slots, they are free again soon.
+            std::this_thread::yield();
+          }
+        }
+        break;
+      case Overflow::DROP_NEWEST:
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      case Overflow::COLLAPSE:
+        collapse(key, e, count, properties);
+        return;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool EventRing::drain(EventBatch &batch, std::vector<Summary> &summaries)
+{
+  bool result = false;
+
+  // only the changes queued until now, the producers may keep adding more.
+  for(size_t i = 0; i <= m_mask; ++i)
+  {
+    size_t position;
+    auto slot = claim(position);
+    if(!slot) break;
+
+    batch.add(slot->object, slot->oldName, slot->event, slot->count, slot->properties, slot->time, slot->key);
+    release(*slot, position);
+    result = true;
+  }
+
+  if(m_summarized.load(std::memory_order_acquire))
+  {
+    QMutexLocker lock(&m_mutex);
+
+    summaries.insert(summaries.end(), m_summaries.cbegin(), m_summaries.cend());
+    m_summaries.clear();
+    m_summarized.store(false, std::memory_order_release);
+    result = true;
+  }
+
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+bool EventRing::tryPush(const Key key, std::wstring_view object, std::wstring_view oldName, const Events e, const unsigned long count,
+                        const Properties properties, const long long time)
+{
+  auto position = m_tail.load(std::memory_order_relaxed);
+  Slot *slot = nullptr;
+
+  while(true)
+  {
+    slot = &m_slots[position & m_mask];
+    const auto sequence = slot->sequence.load(std::memory_order_acquire);
+    const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+
+    if(difference == 0)
+    {
+      if(m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+    }
+    else
+    {
+      // not yet released from the previous lap.
+      if(difference < 0) return false;
+
+      position = m_tail.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->key = key;
+  slot->object.assign(object);
+  slot->oldName.assign(oldName);
+  slot->event = e;
+  slot->count = count;
+  slot->properties = properties;
+  slot->time = time;
+
+  slot->sequence.store(position + 1, std::memory_order_release);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+EventRing::Slot *EventRing::claim(size_t &position)
+{
+  position = m_head.load(std::memory_order_relaxed);
+
+  while(true)
+  {
+    auto slot = &m_slots[position & m_mask];
+    const auto sequence = slot->sequence.load(std::memory_order_acquire);
+    const auto difference = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+
+    if(difference == 0)
+    {
+      // the producers dropping the oldest changes claim slots too.
+      if(m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) return slot;
+    }
+    else
+    {
+      if(difference < 0) return nullptr;
+
+      position = m_head.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void EventRing::release(Slot &slot, const size_t position)
+{
+  slot.sequence.store(position + m_mask + 1, std::memory_order_release);
+}
+
+//-----------------------------------------------------------------------------
+void EventRing::collapse(const Key key, const Events e, const unsigned long count, const Properties properties)
+{
+  QMutexLocker lock(&m_mutex);
+
+  auto sameChange = [key, e](const Summary &summary) { return summary.key == key && summary.event == e; };
+  auto it = std::find_if(m_summaries.begin(), m_summaries.end(), sameChange);
+  if(it != m_summaries.end())
+  {
+    it->count += count;
+    it->properties |= properties;
+  }
+  else
+  {
+    m_summaries.push_back(Summary{key, e, count, properties});
+  }
+
+  m_collapsed.fetch_add(1, std::memory_order_relaxed);
+  m_summarized.store(true, std::memory_order_release);
+}
@@ -0,0 +1,185 @@
+/*
+ File: EventRing.h
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EVENTRING_H_
+#define EVENTRING_H_
+
+// Project
+#include <EventBatch.h>
+#include <Events.h>
+
+// Qt
+#include <QMutex>
+
+// C++
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/** \class EventRing
+ * \brief Bounded queue of changes between the threads producing them and the thread consuming them.
+ * The changes are stored in a fixed number of slots that are claimed without locks, so the memory
+ * stays the same whatever the rate of changes. When the queue is full the oldest or the newest
+ * changes are dropped, or collapsed into a summary of the changes of every object, as configured.
+ * The paths of the slots keep their memory to be reused by the next changes.
+ *
+ */
+class EventRing
+{
+  public:
+    using Key = unsigned long;
+
+    /** \brief Policies when a change doesn't fit in the queue.
+     *
+     */
+    enum class Overflow: char
+    {
+      DROP_OLDEST = 0, /** the oldest queued change is dropped to queue the new one.      */
+      DROP_NEWEST,     /** the new change is dropped.                                      */
+      COLLAPSE         /** the new change is counted in the summary of its object instead. */
+    };
+
+    /** \struct Summary
+     * \brief Changes of an object collapsed while the queue was full.
+     *
+     */
+    struct Summary
+    {
+      Key           key;        /** identifier of the object.         */
+      Events        event;      /** event.                            */
+      unsigned long count;      /** number of collapsed events.       */
+      Properties    properties; /** changed properties of the events. */
+    };
+
+    /** \brief EventRing class constructor.
+     * \param[in] capacity Maximum number of queued changes, rounded up to a power of two.
+     * \param[in] overflow Policy when the queue is full.
+     *
+     */
+    explicit EventRing(const size_t capacity, const Overflow overflow);
+
+    /** \brief Queues a change, applying the overflow policy if the queue is full. Can be called from
+     * any thread.
+     * \param[in] key Identifier of the object of the change.
+     * \param[in] object Path of the changed object, the new path if renamed.
+     * \param[in] oldName Old path of the object if renamed, empty otherwise.
+     * \param[in] e Event.
+     * \param[in] count Number of merged events.
+     * \param[in] properties Changed properties if it's a modification.
+     * \param[in] time Microseconds since the epoch when notified.
+     *
+     */
+    void push(const Key key, std::wstring_view object, std::wstring_view oldName, const Events e, const unsigned long count,
+              const Properties properties, const long long time = 0);
+
+    /** \brief Moves the queued changes to the batch and the collapsed ones to the summaries, in
+     * the consumer thread. Returns true if there were changes and false otherwise.
+     * \param[out] batch Queued changes in order.
+     * \param[out] summaries Collapsed changes.
+     *
+     */
+    bool drain(EventBatch &batch, std::vector<Summary> &summaries);
+
+    /** \brief Returns the number of changes dropped because the queue was full.
+     *
+     */
+    unsigned long long dropped() const
+    { return m_dropped.load(std::memory_order_relaxed); }
+
+    /** \brief Returns the number of changes collapsed into summaries because the queue was full.
+     *
+     */
+    unsigned long long collapsed() const
+    { return m_collapsed.load(std::memory_order_relaxed); }
+
+    /** \brief Returns the maximum number of queued changes.
+     *
+     */
+    size_t capacity() const
+    { return m_mask + 1; }
+
+  private:
+    /** \struct Slot
+     * \brief Queued change. The sequence tells if the slot is free for the producers or full for
+     * the consumer in the current lap of the ring.
+     *
+     */
+    struct Slot
+    {
+      std::atomic<size_t> sequence;   /** position of the next use of the slot. */
+      Key                 key;        /** identifier of the object.             */
+      std::wstring        object;     /** path of the changed object.           */
+      std::wstring        oldName;    /** old path of a renamed object.         */
+      Events              event;      /** event.                                */
+      unsigned long       count;      /** number of merged events.              */
+      Properties          properties; /** changed properties.                   */
+      long long           time;       /** notification time.                    */
+    };
+
+    /** \brief Queues the change if there is a free slot. Returns true on success and false if full.
+     * \param[in] key Identifier of the object of the change.
+     * \param[in] object Path of the changed object.
+     * \param[in] oldName Old path of a renamed object.
+     * \param[in] e Event.
+     * \param[in] count Number of merged events.
+     * \param[in] properties Changed properties.
+     * \param[in] time Notification time.
+     *
+     */
+    bool tryPush(const Key key, std::wstring_view object, std::wstring_view oldName, const Events e, const unsigned long count,
+                 const Properties properties, const long long time);
+
+    /** \brief Returns the slot of the oldest change and claims it, or nullptr if empty. The slot must
+     * be released after reading it.
+     * \param[out] position Position of the claimed slot.
+     *
+     */
+    Slot *claim(size_t &position);
+
+    /** \brief Makes the claimed slot free for the producers.
+     * \param[in] slot Claimed slot.
+     * \param[in] position Position of the claimed slot.
+     *
+     */
+    void release(Slot &slot, const size_t position);
+
+    /** \brief Counts the change in the summary of its object.
+     * \param[in] key Identifier of the object.
+     * \param[in] e Event.
+     * \param[in] count Number of merged events.
+     * \param[in] properties Changed properties.
+     *
+     */
+    void collapse(const Key key, const Events e, const unsigned long count, const Properties properties);
+
+    std::unique_ptr<Slot[]>         m_slots;      /** changes storage.                                     */
+    const size_t                    m_mask;       /** capacity minus one, to wrap the positions.           */
+    const Overflow                  m_overflow;   /** policy when the queue is full.                       */
+    alignas(64) std::atomic<size_t> m_head;       /** position of the oldest change, read by the consumer. */
+    alignas(64) std::atomic<size_t> m_tail;       /** position of the next change, claimed by producers.   */
+    std::atomic<unsigned long long> m_dropped;    /** changes dropped when full.                           */
+    std::atomic<unsigned long long> m_collapsed;  /** changes collapsed when full.                         */
+    std::atomic<bool>               m_summarized; /** true if there are summaries to drain.                */
+    QMutex                          m_mutex;      /** protects the summaries, only used when full.         */
+    std::vector<Summary>            m_summaries;  /** collapsed changes of the objects.                    */
+};
+
+#endif // EVENTRING_H_
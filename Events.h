@@ -0,0 +1,68 @@
+/*
+ File: Events.h
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EVENTS_H_
+#define EVENTS_H_
+
+// C++
+#include <type_traits>
+
+enum class Events: char
+{
+  NONE        = 0,
+  ADDED       = 0b00000001,
+  REMOVED     = 0b00000010,
+  MODIFIED    = 0b00000100,
+  RENAMED_OLD = 0b00001000,
+  RENAMED_NEW = 0b00010000,
+  RECURSIVE   = 0b00100000, /** added by me for UI reasons, not in the api. */
+  LOST        = 0b01000000  /** notifications buffer overflowed and events were lost, not in the api. */
+};
+
+inline Events operator|(Events lhs, Events rhs)
+{ return static_cast<Events>(static_cast<std::underlying_type_t<Events>>(lhs)|static_cast<std::underlying_type_t<Events>>(rhs)); }
+
+inline Events operator&(Events lhs, Events rhs)
+{ return static_cast<Events>(static_cast<std::underlying_type_t<Events>>(lhs)&static_cast<std::underlying_type_t<Events>>(rhs)); }
+
+inline Events operator|=(Events &lhs, Events rhs)
+{ lhs = lhs|rhs; return lhs; }
+
+/** \brief Properties of a file that changed in a modification. */
+enum class Properties: char
+{
+  NONE       = 0,
+  SIZE       = 0b00000001,
+  WRITE_TIME = 0b00000010,
+  ATTRIBUTES = 0b00000100,
+  SECURITY   = 0b00001000, /** owner or permissions. */
+  OTHER      = 0b00010000, /** access time or a change not recorded by the file metadata. */
+  ALL        = 0b00011111  /** also used when the changed properties are unknown. */
+};
+
+inline Properties operator|(Properties lhs, Properties rhs)
+{ return static_cast<Properties>(static_cast<std::underlying_type_t<Properties>>(lhs)|static_cast<std::underlying_type_t<Properties>>(rhs)); }
+
+inline Properties operator&(Properties lhs, Properties rhs)
+{ return static_cast<Properties>(static_cast<std::underlying_type_t<Properties>>(lhs)&static_cast<std::underlying_type_t<Properties>>(rhs)); }
+
+inline Properties operator|=(Properties &lhs, Properties rhs)
+{ lhs = lhs|rhs; return lhs; }
+
+#endif // EVENTS_H_
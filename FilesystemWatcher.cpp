@@ -22,6 +22,7 @@
 #include <AboutDialog.h>
 #include <ObjectsTableModel.h>
 #include <LogiLED.h>
+#include <WatchSettings.h>
 
 // Qt
 #include <QMenu>
@@ -30,44 +31,62 @@
 #include <QSettings>
 #include <QMessageBox>
 #include <QTimer>
-#include <QSoundEffect>
-#include <QTemporaryFile>
 #include <QClipboard>
 #include <QGuiApplication>
 #include <QDateTime>
 #include <QTextBlock>
+#include <QApplication>
 
 // C++
+#include <algorithm>
 #include <atomic>
+#include <tuple>
 
 const QString GEOMETRY = "Geometry";
 const QString LAST_DIRECTORY = "Last used directory";
 const QString ALARM_VOLUME = "Alarm volume";
 const QString DEFAULT_ALARMS = "Default alarms";
 const QString DEFAULT_EVENTS = "Default events";
+const QString DEFAULT_PROPERTIES = "Default properties";
+const QString DEFAULT_WINDOW = "Default merge window";
+const QString DEFAULT_INCLUDE = "Default include patterns";
+const QString DEFAULT_EXCLUDE = "Default exclude patterns";
+const QString DEFAULT_GITIGNORE = "Default use gitignore";
+
+const int DRAIN_INTERVAL = 50; /** milliseconds between takes of the queued changes. */
 
 Q_DECLARE_METATYPE(std::wstring);
 Q_DECLARE_METATYPE(Events);
 
 static std::atomic<bool> hasTrayMessage = false;
 
-const QString INI_FILENAME{"FilesystemWatcher.ini"};
-
 //-----------------------------------------------------------------------------
 FilesystemWatcher::FilesystemWatcher(QWidget *p, Qt::WindowFlags f)
 : QDialog(p,f)
 , m_trayIcon{new QSystemTrayIcon(QIcon(":/FilesystemWatcher/eye-1.svg"), this)}
+, m_watcher{new WatchThread(this)}
+, m_journal{nullptr}
+, m_replay{nullptr}
 , m_needsExit{false}
-, m_alarmSound{nullptr}
-, m_soundFile{nullptr}
+, m_sounds{new SoundCache(this)}
 , m_lastDir{QDir::home()}
 , m_alarmVolume{100}
+, m_properties{Properties::ALL}
+, m_window{0}
+, m_gitIgnore{false}
+, m_drainTimer{new QTimer(this)}
+, m_draining{false}
+, m_lost{0}
+, m_queueCapacity{WatchThread::DEFAULT_QUEUE_CAPACITY}
+, m_queueOverflow{EventRing::Overflow::COLLAPSE}
 {
   qRegisterMetaType<std::wstring>();
   qRegisterMetaType<Events>();
 
   setupUi(this);
 
+  m_dropped->setVisible(false);
+
   m_objectsTable->setModel(new ObjectsTableModel());
   m_objectsTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::ResizeMode::Stretch);
   m_objectsTable->horizontalHeader()->setSectionResizeMode(1, QHeaderView::ResizeMode::Stretch);
@@ -82,6 +101,10 @@ FilesystemWatcher::FilesystemWatcher(QWidget *p, Qt::WindowFlags f)
   loadSettings();
 
   m_tabWidget->setCurrentIndex(0);
+
+  m_drainTimer->start(DRAIN_INTERVAL);
+  if(m_journal) m_journal->start();
+  m_watcher->start();
 }
 
 //-----------------------------------------------------------------------------
@@ -89,11 +112,21 @@ FilesystemWatcher::~FilesystemWatcher()
 {
   saveSettings();
 
-  auto stopThread = [](Object &o)
+  if(m_replay)
+  {
+    m_replay->abort();
+    m_replay->wait();
+  }
+
+  m_watcher->abort();
+  m_watcher->wait();
+
+  // after the watcher, so its last changes are recorded.
+  if(m_journal)
   {
-    o.thread->abort();
-  };
-  std::for_each(m_objects.begin(), m_objects.end(), stopThread);
+    m_journal->abort();
+    m_journal->wait();
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -119,6 +152,12 @@ void FilesystemWatcher::connectSignals()
 
   connect(m_objectsTable, SIGNAL(customContextMenuRequested(const QPoint &)),
           this,           SLOT(onCustomMenuRequested(const QPoint &)));
+
+  connect(m_watcher, SIGNAL(error(const QString)),
+          this,      SLOT(onWatcherError(const QString)));
+
+  connect(m_drainTimer, SIGNAL(timeout()),
+          this,         SLOT(onDrainTimeout()));
 }
 
 //-----------------------------------------------------------------------------
@@ -174,6 +213,84 @@ void FilesystemWatcher::loadSettings()
   m_alarmVolume = static_cast<unsigned char>(settings->value(ALARM_VOLUME, 100).toInt());
   m_alarmFlags = static_cast<AlarmFlags>(settings->value(DEFAULT_ALARMS, 7).toInt());
   m_events = static_cast<Events>(settings->value(DEFAULT_EVENTS, 63).toInt());
+  m_properties = static_cast<Properties>(settings->value(DEFAULT_PROPERTIES, 31).toInt());
+  m_window = settings->value(DEFAULT_WINDOW, 250).toUInt();
+  m_include = settings->value(DEFAULT_INCLUDE, QString()).toString();
+  m_exclude = settings->value(DEFAULT_EXCLUDE, QString()).toString();
+  m_gitIgnore = settings->value(DEFAULT_GITIGNORE, false).toBool();
+  WatchSettings::loadQueue(*settings, m_queueCapacity, m_queueOverflow);
+
+  // the watcher thread hasn't started yet.
+  m_watcher->setQueue(m_queueCapacity, m_queueOverflow);
+
+  m_journal = WatchSettings::createJournal(*settings, this);
+  if(m_journal)
+  {
+    m_watcher->setJournal(m_journal);
+
+    connect(m_journal, SIGNAL(error(const QString)),
+            this,      SLOT(onWatcherError(const QString)));
+  }
+
+  restoreObjects(*settings);
+}
+
+//-----------------------------------------------------------------------------
+void FilesystemWatcher::restoreObjects(QSettings &settings)
+{
+  auto objects = WatchSettings::loadObjects(settings);
+
+  std::vector<WatchedObject> restored;
+  std::vector<bool> directories;
+  restored.reserve(objects.size());
+  directories.reserve(objects.size());
+
+  for(auto &object: objects)
+  {
+    std::error_code error;
+    const auto status = std::filesystem::status(object.path, error);
+    if(!std::filesystem::exists(status))
+    {
+      log(tr("Cannot find object <b>'%1'</b>, it's no longer watched.").arg(QString::fromStdWString(object.path.wstring())));
+      continue;
+    }
+
+    if(m_router.find(object.path.wstring(), true) >= 0) continue;
+
+    const bool isDirectory = std::filesystem::is_directory(status);
+    m_router.insert(object.path.wstring(), static_cast<int>(m_objects.size() + restored.size()), isDirectory);
+
+    directories.push_back(isDirectory);
+    restored.push_back(std::move(object));
+  }
+
+  if(restored.empty()) return;
+
+  // all the watches are added by the watcher thread at once, the rows are inserted at once.
+  const auto ids = WatchSettings::addObjects(*m_watcher, restored);
+
+  std::vector<std::pair<QString, QColor>> rows;
+  rows.reserve(restored.size());
+  m_objects.reserve(m_objects.size() + restored.size());
+
+  for(size_t i = 0; i < restored.size(); ++i)
+  {
+    const auto &object = restored.at(i);
+    m_objects.push_back(Object{object, directories.at(i), static_cast<AlarmFlags>(object.alarms), object.color, object.volume, ids.at(i)});
+    if((m_objects.back().alarms & AlarmFlags::SOUND) != AlarmFlags::NONE) m_sounds->load(object.sound);
+    rows.emplace_back(QString::fromStdWString(object.path.wstring()), object.color);
+  }
+
+  auto objectsModel = qobject_cast<ObjectsTableModel*>(m_objectsTable->model());
+  objectsModel->addObjects(rows);
+
+  const auto objectsNum = m_objects.size();
+
+  updateTrayIcon();
+
+  m_trayIcon->setToolTip(tr("Watching %1 object%2").arg(objectsNum).arg(objectsNum > 1 ? "s":""));
+
+  log(tr("Watching %1 restored object%2.").arg(restored.size()).arg(restored.size() > 1 ? "s":""));
 }
 
 //-----------------------------------------------------------------------------
@@ -186,6 +303,25 @@ void FilesystemWatcher::saveSettings()
   settings->setValue(ALARM_VOLUME, m_alarmVolume);
   settings->setValue(DEFAULT_ALARMS, static_cast<int>(m_alarmFlags));
   settings->setValue(DEFAULT_EVENTS, static_cast<int>(m_events));
+  settings->setValue(DEFAULT_PROPERTIES, static_cast<int>(m_properties));
+  settings->setValue(DEFAULT_WINDOW, m_window);
+  settings->setValue(DEFAULT_INCLUDE, m_include);
+  settings->setValue(DEFAULT_EXCLUDE, m_exclude);
+  settings->setValue(DEFAULT_GITIGNORE, m_gitIgnore);
+  WatchSettings::saveQueue(*settings, m_queueCapacity, m_queueOverflow);
+  WatchSettings::saveJournal(*settings, m_journal);
+
+  // restored on the next start, the watch parameters are also read by the headless mode.
+  std::vector<WatchedObject> objects;
+  objects.reserve(m_objects.size());
+  for(const auto &object: m_objects)
+  {
+    objects.push_back(WatchedObject{object.path, object.events, object.recursive, object.window, object.contents, object.properties,
+                                    object.include, object.exclude, object.gitIgnore, static_cast<int>(object.alarms), object.color,
+                                    object.volume, object.sound});
+  }
+  WatchSettings::saveObjects(*settings, objects);
+
   settings->sync();
 }
 
@@ -212,7 +348,8 @@ void FilesystemWatcher::onSelectionChanged()
 //-----------------------------------------------------------------------------
 void FilesystemWatcher::onAddObjectButtonClicked()
 {
-  AddObjectDialog dialog(m_lastDir, m_alarmVolume, m_alarmFlags, m_events, m_objects, this);
+  AddObjectDialog dialog(m_lastDir, m_alarmVolume, m_alarmFlags, m_events, m_properties, m_window, m_include, m_exclude, m_gitIgnore, m_objects,
+                         *m_sounds, this);
 
   if(QDialog::Accepted == dialog.exec())
   {
@@ -225,9 +362,7 @@ void FilesystemWatcher::onAddObjectButtonClicked()
       return;
     }
 
-    auto equalPath = [&objectPath](const struct Object &o) { return o.path.compare(objectPath) == 0; };
-    auto it = std::find_if(m_objects.cbegin(), m_objects.cend(), equalPath);
-    if(it != m_objects.cend())
+    if(m_router.find(objectPath.wstring(), true) >= 0)
     {
       const auto message = tr("Object '%1' is already being watched.").arg(obj);
       QMessageBox::information(this, tr("Add object"), message, QMessageBox::Ok);
@@ -237,28 +372,27 @@ void FilesystemWatcher::onAddObjectButtonClicked()
     m_alarmVolume = dialog.alarmVolume();
     m_alarmFlags = dialog.objectAlarms();
     m_events = dialog.objectEvents();
+    m_properties = dialog.objectProperties();
+    m_window = dialog.mergeWindow();
 
-    auto thread = new WatchThread(objectPath, dialog.objectEvents(), dialog.isRecursive());
-
-    m_objects.push_back(Object{objectPath, m_alarmFlags, dialog.alarmColor(), m_alarmVolume, dialog.objectEvents(), thread});
-
-    connect(thread, SIGNAL(error(const QString)),
-            this,   SLOT(onWatcherError(const QString)));
+    // the kind of the object doesn't change while watched, even if renamed.
+    const bool isDirectory = std::filesystem::is_directory(objectPath);
+    if(isDirectory)
+    {
+      m_include = dialog.includePatterns();
+      m_exclude = dialog.excludePatterns();
+      m_gitIgnore = dialog.useGitIgnore();
+    }
 
-    connect(thread, SIGNAL(modified(const std::wstring, const Events)),
-            this,   SLOT(onModification(const std::wstring, const Events)));
+    const WatchedObject watched{objectPath, dialog.objectEvents(), dialog.isRecursive(), m_window, dialog.compareContents(), m_properties,
+                                dialog.includePatterns(), dialog.excludePatterns(), dialog.useGitIgnore(), static_cast<int>(m_alarmFlags),
+                                dialog.alarmColor(), m_alarmVolume, dialog.alarmSound()};
+    const auto id = WatchSettings::addObject(*m_watcher, watched);
 
-    connect(thread, SIGNAL(renamed(const std::wstring, const std::wstring)),
-            this,   SLOT(onRename(const std::wstring, const std::wstring)));
+    m_router.insert(objectPath.wstring(), static_cast<int>(m_objects.size()), isDirectory);
+    m_objects.push_back(Object{watched, isDirectory, m_alarmFlags, dialog.alarmColor(), m_alarmVolume, id});
 
     auto objectsModel = qobject_cast<ObjectsTableModel*>(m_objectsTable->model());
-    connect(thread,       SIGNAL(modified(const std::wstring, const Events)),
-            objectsModel, SLOT(modification(const std::wstring, const Events)));
-    connect(thread, SIGNAL(renamed(const std::wstring, const std::wstring)),
-            objectsModel, SLOT(rename(const std::wstring, const std::wstring)));
-
-    thread->start();
-
     objectsModel->addObject(obj, dialog.alarmColor());
 
     const auto objectsNum = m_objects.size();
@@ -330,75 +464,158 @@ void FilesystemWatcher::onWatcherError(const QString message)
 }
 
 //-----------------------------------------------------------------------------
-void FilesystemWatcher::onModification(const std::wstring object, const Events e)
+void FilesystemWatcher::onDrainTimeout()
 {
-  const auto qObject = QString::fromStdWString(object);
+  // the modal dialogs of the alarms run the event loop, the changes wait in the queue meanwhile.
+  if(m_draining) return;
+  m_draining = true;
+
+  m_changes.clear();
+  m_summaries.clear();
 
-  auto matchObj = [&qObject](const Object &o)
+  if(m_watcher->drain(m_changes, m_summaries))
   {
-    const auto obj = QString::fromStdWString(o.path.wstring());
-    if(std::filesystem::is_directory(o.path))
-    {
-      return qObject.startsWith(obj, Qt::CaseInsensitive);
-    }
-    else
-    {
-      return qObject.compare(obj, Qt::CaseInsensitive) == 0;
-    }
-  };
-  auto it = std::find_if(m_objects.begin(), m_objects.end(), matchObj);
+    addSummaries(m_summaries, m_changes);
+    onChanges(m_changes);
+  }
+
+  updateDropped();
+
+  m_draining = false;
+}
 
-  if(it != m_objects.end())
+//-----------------------------------------------------------------------------
+void FilesystemWatcher::replay(const QString &journal, const double speed)
+{
+  if(m_replay)
   {
-    auto &data = *it;
-    data.eventsNumber += 1;
+    m_replay->abort();
+    m_replay->wait();
+    delete m_replay;
+  }
 
-    const bool hasSound  = (data.alarms & AlarmFlags::SOUND) != AlarmFlags::NONE;
-    const bool hasLights = (data.alarms & AlarmFlags::LIGHTS) != AlarmFlags::NONE;
-    const bool hasMessage = (data.alarms & AlarmFlags::MESSAGE) != AlarmFlags::NONE;
+  // the replayed changes take the same queue as the watched ones.
+  m_replay = new JournalReplay(journal, m_watcher->queue(), speed, this);
 
-    if(!m_mute->isChecked() && (hasSound || hasLights || hasMessage))
-    {
-      soundAlarms(hasSound, hasLights, hasMessage, data, e);
-    }
+  connect(m_replay, SIGNAL(error(const QString)),
+          this,     SLOT(onWatcherError(const QString)));
+  connect(m_replay, SIGNAL(finished()),
+          this,     SLOT(onReplayFinished()));
+
+  log(tr("Replaying the journal <b>'%1'</b>.").arg(QDir::toNativeSeparators(journal)));
 
-    m_copy->setEnabled(true);
-    m_reset->setEnabled(true);
-  }    
+  m_replay->start();
 }
 
 //-----------------------------------------------------------------------------
-void FilesystemWatcher::onRename(const std::wstring oldName, const std::wstring newName)
+void FilesystemWatcher::onReplayFinished()
 {
-  auto qOldName = QString::fromStdWString(oldName);
+  if(!m_replay) return;
+
+  log(tr("Replay finished: %1 events replayed.").arg(m_replay->replayed()));
+}
 
-  auto findName = [&qOldName](Object &o)
+//-----------------------------------------------------------------------------
+void FilesystemWatcher::addSummaries(const std::vector<EventRing::Summary> &summaries, EventBatch &batch) const
+{
+  for(const auto &summary: summaries)
   {
-    const auto name = QString::fromStdWString(o.path.wstring());
-    return (name.compare(qOldName, Qt::CaseInsensitive) == 0);
-  };
-  auto it = std::find_if(m_objects.begin(), m_objects.end(), findName);
+    auto sameId = [&summary](const Object &o) { return o.id == summary.key; };
+    const auto it = std::find_if(m_objects.cbegin(), m_objects.cend(), sameId);
+    if(it == m_objects.cend()) continue;
+
+    batch.add(it->getPath().wstring(), std::wstring_view(), summary.event, summary.count, summary.properties, 0, summary.key);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void FilesystemWatcher::updateDropped()
+{
+  const auto &queue = m_watcher->queue();
+  const auto dropped = queue.dropped();
+  const auto collapsed = queue.collapsed();
+  if(dropped + collapsed == m_lost) return;
+
+  const auto message = tr("The events queue was full: %1 events dropped, %2 events collapsed.").arg(dropped).arg(collapsed);
+  if(m_lost == 0) log(message);
+
+  m_lost = dropped + collapsed;
+  m_dropped->setText(tr("Dropped: %1 Collapsed: %2").arg(dropped).arg(collapsed));
+  m_dropped->setVisible(true);
+}
 
-  if(it != m_objects.end())
+//-----------------------------------------------------------------------------
+void FilesystemWatcher::onChanges(const EventBatch &batch)
+{
+  if(!m_router.route(batch, *this)) return;
+
+  m_copy->setEnabled(true);
+  m_reset->setEnabled(true);
+}
+
+//-----------------------------------------------------------------------------
+void FilesystemWatcher::onModification(const int row, std::wstring_view object, const Events e, const unsigned long count,
+                                       const Properties properties)
+{
+  auto &data = m_objects.at(row);
+  data.eventsNumber += count;
+
+  auto objectsModel = qobject_cast<ObjectsTableModel*>(m_objectsTable->model());
+  objectsModel->modification(row, e, count, properties);
+
+  if(e == Events::LOST)
   {
-    auto &data = *it;
-    data.path = std::filesystem::path{newName};
-    data.eventsNumber += 1;
+    data.overflowsNumber += 1;
 
-    auto message = tr("File <b>'%2'</b> renamed to <b>'%3'</b>.").arg(QString::fromStdWString(oldName)).arg(QString::fromStdWString(newName));
+    const auto message = tr("Notifications of <b>'%1'</b> overflowed and some events were lost (%2 time%3).")
+                         .arg(QString::fromWCharArray(object.data(), object.size())).arg(data.overflowsNumber).arg(data.overflowsNumber > 1 ? "s" : "");
     log(message);
+  }
+}
 
-    const bool hasSound  = (data.alarms & AlarmFlags::SOUND) != AlarmFlags::NONE;
-    const bool hasLights = (data.alarms & AlarmFlags::LIGHTS) != AlarmFlags::NONE;
-    const bool hasMessage = (data.alarms & AlarmFlags::MESSAGE) != AlarmFlags::NONE;
+//-----------------------------------------------------------------------------
+void FilesystemWatcher::onRename(const int row, std::wstring_view oldName, std::wstring_view newName, const bool isObject)
+{
+  auto &data = m_objects.at(row);
+  data.eventsNumber += 1;
 
-    if(!m_mute->isChecked() && (hasSound || hasLights || hasMessage))
-    {
-      soundAlarms(hasSound, hasLights, hasMessage, data, Events::RENAMED_OLD);
-    }
+  auto objectsModel = qobject_cast<ObjectsTableModel*>(m_objectsTable->model());
+  if(isObject)
+  {
+    data.path = std::filesystem::path{newName};
 
-    m_copy->setEnabled(true);
-    m_reset->setEnabled(true);
+    objectsModel->rename(row, newName);
+  }
+  else
+  {
+    objectsModel->modification(row, Events::RENAMED_NEW, 1);
+  }
+
+  const auto qOldName = QString::fromWCharArray(oldName.data(), oldName.size());
+  const auto qNewName = QString::fromWCharArray(newName.data(), newName.size());
+  auto message = tr("File <b>'%2'</b> renamed to <b>'%3'</b>.").arg(qOldName).arg(qNewName);
+  log(message);
+}
+
+//-----------------------------------------------------------------------------
+void FilesystemWatcher::onRowsChanged(const int first, const int last, const bool renamed)
+{
+  auto objectsModel = qobject_cast<ObjectsTableModel*>(m_objectsTable->model());
+  objectsModel->updateRows(first, last, renamed);
+}
+
+//-----------------------------------------------------------------------------
+void FilesystemWatcher::onAlarm(const int row, const Events e, const Properties properties)
+{
+  auto &obj = m_objects.at(row);
+
+  const bool hasSound  = (obj.alarms & AlarmFlags::SOUND) != AlarmFlags::NONE;
+  const bool hasLights = (obj.alarms & AlarmFlags::LIGHTS) != AlarmFlags::NONE;
+  const bool hasMessage = (obj.alarms & AlarmFlags::MESSAGE) != AlarmFlags::NONE;
+
+  if(!m_mute->isChecked() && (hasSound || hasLights || hasMessage))
+  {
+    soundAlarms(hasSound, hasLights, hasMessage, obj, e, properties);
   }
 }
 
@@ -442,14 +659,7 @@ void FilesystemWatcher::stopAlarms()
   if(!inUse.exchange(true))
   {
     if(LogiLED::getInstance().isInUse()) LogiLED::getInstance().stopLights();
-    if(m_alarmSound && m_soundFile)
-    {
-      m_alarmSound->stop();
-      delete m_alarmSound;
-      m_alarmSound = nullptr;
-      delete m_soundFile;
-      m_soundFile = nullptr;
-    }
+    m_sounds->stopAlarm();
 
     m_stopAction->setVisible(false);
     m_stopButton->setEnabled(false);
@@ -481,7 +691,7 @@ void FilesystemWatcher::onResetButtonClicked()
       data.eventsNumber = 0;
 
       auto objectsModel = qobject_cast<ObjectsTableModel*>(m_objectsTable->model());
-      objectsModel->resetObject(data.path.wstring());
+      objectsModel->resetObject(index.row());
 
       m_reset->setEnabled(false);
 
@@ -507,12 +717,13 @@ void FilesystemWatcher::onRemoveButtonClicked()
       auto &data = m_objects.at(index.row());
       const auto message = tr("Stopped watching object \"%1\".").arg(QString::fromStdWString(data.path.wstring()));
       auto objectsModel = qobject_cast<ObjectsTableModel*>(m_objectsTable->model());
-      objectsModel->removeObject(data.path.wstring());
+      objectsModel->removeObject(index.row());
 
       if(data.isInAlarm()) stopAlarms();
       
-      data.thread->abort();
+      m_watcher->removeObject(data.id);
 
+      m_router.removeRow(index.row());
       m_objects.erase(m_objects.begin() + index.row());
 
       log(message);
@@ -622,20 +833,16 @@ bool FilesystemWatcher::showMessage(const QString title, const QString message)
 }
 
 //-----------------------------------------------------------------------------
-void FilesystemWatcher::soundAlarms(bool hasSound, bool hasLights, bool hasMessage, Object &obj, const Events type)
+void FilesystemWatcher::soundAlarms(bool hasSound, bool hasLights, bool hasMessage, Object &obj, const Events type,
+                                    const Properties properties)
 {
   if(m_mute->isChecked()) return;
 
-  if(hasSound && !m_alarmSound && !m_soundFile)
+  if(hasSound && !m_sounds->isAlarmPlaying())
   {
     obj.setIsInAlarm(true);
 
-    m_alarmSound = new QSoundEffect(this);
-    m_soundFile = QTemporaryFile::createNativeFile(":/FilesystemWatcher/Beeper.wav");
-    m_alarmSound->setSource(QUrl::fromLocalFile(m_soundFile->fileName()));
-    m_alarmSound->setLoopCount(QSoundEffect::Infinite);
-    m_alarmSound->setVolume(static_cast<double>(obj.volume)/100.0);
-    m_alarmSound->play();
+    m_sounds->playAlarm(obj.sound, obj.volume);
   }
 
   if(hasLights)
@@ -661,7 +868,7 @@ void FilesystemWatcher::soundAlarms(bool hasSound, bool hasLights, bool hasMessa
         message = tr("Added %2").arg(suffix);
         break;
       case Events::MODIFIED:
-        message = tr("Modified %2").arg(suffix);
+        message = tr("Modified %1%2").arg(ObjectsTableModel::propertiesText(properties)).arg(suffix);
         break;
       case Events::REMOVED:
         message = tr("Removed %2").arg(suffix);
@@ -669,6 +876,9 @@ void FilesystemWatcher::soundAlarms(bool hasSound, bool hasLights, bool hasMessa
       case Events::RENAMED_NEW:
         message = tr("Renamed a file to %2").arg(suffix);
         break;
+      case Events::LOST:
+        message = tr("Lost events of %2").arg(suffix);
+        break;
       case Events::RENAMED_OLD:
       // no break
       default:
@@ -706,11 +916,5 @@ void FilesystemWatcher::soundAlarms(bool hasSound, bool hasLights, bool hasMessa
 //-----------------------------------------------------------------------------
 std::unique_ptr<QSettings> FilesystemWatcher::applicationSettings() const
 {
-  QDir applicationDir{QCoreApplication::applicationDirPath()};
-  if(applicationDir.exists(INI_FILENAME))
-  {
-    return std::make_unique<QSettings>(INI_FILENAME, QSettings::IniFormat);
-  }
-
-  return std::make_unique<QSettings>("Felix de las Pozas Alvarez", "FilesystemWatcher");
+  return WatchSettings::applicationSettings();
 }
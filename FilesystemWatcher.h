@@ -20,7 +20,7 @@
 #ifndef FILESYSTEMWATCHER_H_
 #define FILESYSTEMWATCHER_H_
 
-#include "ui_filesystemWatcher.h"
+#include "ui_FilesystemWatcher.h"
 
 // Qt
 #include <QDialog>
@@ -28,12 +28,15 @@
 
 // Project
 #include "AddObjectDialog.h"
+#include "ChangeRouter.h"
+#include "JournalReplay.h"
+#include "SoundCache.h"
 #include "WatchThread.h"
+#include "WatchSettings.h"
 
 class QCloseEvent;
 class QSettings;
-class QSoundEffect;
-class QTemporaryFile;
+class QTimer;
 class Object;
 
 /** \class FilesystemWatcher
@@ -43,6 +46,7 @@ class Object;
 class FilesystemWatcher
 : public QDialog
 , private Ui::FilesystemWatcher
+, private ChangeRouter::Listener
 {
     Q_OBJECT
   public:
@@ -58,6 +62,14 @@ class FilesystemWatcher
      */
     virtual ~FilesystemWatcher();
 
+    /** \brief Replays the changes recorded in the journal as if they were notified now. The objects
+     * are matched by path, so the replayed changes of objects not being watched are ignored.
+     * \param[in] journal Path of a segment file or of the directory of the segments of a journal.
+     * \param[in] speed Factor of the recorded speed, 0 to replay as fast as possible.
+     *
+     */
+    void replay(const QString &journal, const double speed);
+
   protected:
     virtual void closeEvent(QCloseEvent *e);
 
@@ -104,19 +116,15 @@ class FilesystemWatcher
      */
     void onWatcherError(const QString message);
 
-    /** \brief Alarms the user about an event.
-     * \param[in] object Object name.
-     * \param[in] e Event.
+    /** \brief Takes the changes queued by the watcher thread and shows the number of lost ones.
      *
      */
-    void onModification(const std::wstring object, const Events e);
+    void onDrainTimeout();
 
-    /** \brief Updates the internal data about the object and warns the user of an event.
-     * \param[in] oldName Object old name.
-     * \param[in] newName Object new name.
+    /** \brief Logs the end of the replay of a journal.
      *
      */
-    void onRename(const std::wstring oldName, const std::wstring newName);
+    void onReplayFinished();
 
     /** \brief Animates the tray icon.
      *
@@ -175,6 +183,42 @@ class FilesystemWatcher
      */
     void saveSettings();
 
+    /** \brief Watches again the objects saved in the settings. The watches are added at once by the
+     * watcher thread and the rows are inserted in a single step.
+     * \param[in] settings Application settings.
+     *
+     */
+    void restoreObjects(QSettings &settings);
+
+    virtual void onModification(const int row, std::wstring_view object, const Events e, const unsigned long count,
+                                const Properties properties) override;
+
+    virtual void onRename(const int row, std::wstring_view oldName, std::wstring_view newName, const bool isObject) override;
+
+    virtual void onRowsChanged(const int first, const int last, const bool renamed) override;
+
+    virtual void onAlarm(const int row, const Events e, const Properties properties) override;
+
+    /** \brief Updates the internal data about the changed objects and alarms the user once for every
+     * changed object.
+     * \param[in] batch Changes of the watched objects.
+     *
+     */
+    void onChanges(const EventBatch &batch);
+
+    /** \brief Adds the changes of the objects collapsed when the queue was full to the batch, as
+     * changes of the objects themselves.
+     * \param[in] summaries Collapsed changes of the objects.
+     * \param[out] batch Changes of the watched objects.
+     *
+     */
+    void addSummaries(const std::vector<EventRing::Summary> &summaries, EventBatch &batch) const;
+
+    /** \brief Shows the number of changes lost because the queue was full, if any.
+     *
+     */
+    void updateDropped();
+
     /** \brief Writes the given message to the log tab.
      * \param[in] message Text message.
      *
@@ -194,25 +238,42 @@ class FilesystemWatcher
      * \param[in] hasMessage True if the event has message alarm. 
      * \param[in] obj Object of the event.
      * \param[in] type Event type. 
+     * \param[in] properties Changed properties if a modification.
      * 
      */
-    void soundAlarms(bool hasSound, bool hasLights, bool hasMessage, Object &obj, const Events type);
+    void soundAlarms(bool hasSound, bool hasLights, bool hasMessage, Object &obj, const Events type,
+                     const Properties properties);
 
     /** \brief Helper method to return the correct QSettings depending on the presence of INI file.
      *
      */
     std::unique_ptr<QSettings> applicationSettings() const;
 
-    QSystemTrayIcon    *m_trayIcon;    /** tray icon.                                      */
-    bool                m_needsExit;   /** true to close the application, false otherwise. */
-    std::vector<Object> m_objects;     /** list of watched objects.                        */
-    QAction            *m_stopAction;  /** stop alarms tray menu action.                   */
-    QSoundEffect       *m_alarmSound;  /** alarm sound.                                    */
-    QTemporaryFile     *m_soundFile;   /** temporary file for alarm wav file.              */
-    QDir                m_lastDir;     /** last opened dir to select objects.              */
-    unsigned char       m_alarmVolume; /** volume of the sound alarm [0-100].              */
-    AlarmFlags          m_alarmFlags;  /** default alarms for add object dialog.           */
-    Events              m_events;      /** default events for add object dialog.           */
+    QSystemTrayIcon                *m_trayIcon;      /** tray icon.                                      */
+    WatchThread                    *m_watcher;       /** thread watching all the objects.                */
+    EventJournal                   *m_journal;       /** thread recording the changes, if enabled.       */
+    JournalReplay                  *m_replay;        /** thread replaying a journal, if any.             */
+    bool                            m_needsExit;     /** true to close the application, false otherwise. */
+    std::vector<Object>             m_objects;       /** list of watched objects.                        */
+    ChangeRouter                    m_router;        /** routes the changes to the objects owning them.  */
+    QAction                        *m_stopAction;    /** stop alarms tray menu action.                   */
+    SoundCache                     *m_sounds;        /** alarm sounds decoded in memory.                 */
+    QDir                            m_lastDir;       /** last opened dir to select objects.              */
+    unsigned char                   m_alarmVolume;   /** volume of the sound alarm [0-100].              */
+    AlarmFlags                      m_alarmFlags;    /** default alarms for add object dialog.           */
+    Events                          m_events;        /** default events for add object dialog.           */
+    Properties                      m_properties;    /** default properties for add object dialog.       */
+    unsigned int                    m_window;        /** default merge window for add object dialog.     */
+    QString                         m_include;       /** default included paths for add object dialog.   */
+    QString                         m_exclude;       /** default excluded paths for add object dialog.   */
+    bool                            m_gitIgnore;     /** default .gitignore use for add object dialog.   */
+    QTimer                         *m_drainTimer;    /** timer to take the queued changes.               */
+    bool                            m_draining;      /** true while processing the queued changes.       */
+    EventBatch                      m_changes;       /** buffer of the queued changes.                   */
+    std::vector<EventRing::Summary> m_summaries;     /** buffer of the collapsed changes.                */
+    unsigned long long              m_lost;          /** changes dropped or collapsed when last shown.   */
+    size_t                          m_queueCapacity; /** maximum number of queued changes.               */
+    EventRing::Overflow             m_queueOverflow; /** policy when the queue of changes is full.       */
 };
 
 /** \class Object
@@ -252,6 +313,24 @@ class Object
     std::filesystem::path getPath() const
     { return path; }
 
+    /** \brief Returns true if the object is a directory and false if it's a file.
+     *
+     */
+    bool isDirectory() const
+    { return directory; }
+
+    /** \brief Returns the time in milliseconds to merge repeated events.
+     *
+     */
+    unsigned int getWindow() const
+    { return window; }
+
+    /** \brief Returns the number of times the notifications of the object overflowed and events were lost.
+     *
+     */
+    unsigned long getOverflowsNumber() const
+    { return overflowsNumber; }
+
     /** \brief Returns the volume of the sound alarm.
      *
      */
@@ -273,30 +352,42 @@ class Object
 
   private:
     /** \brief Object class constructor.
-     * \param[in] objectPath  Filesystem path of the object.
+     * \param[in] watched     Watch parameters of the object.
+     * \param[in] isDirectory True if the object is a directory.
      * \param[in] alarmFlags  Alarms to trigger when the object changes.
      * \param[in] lightsColor Color to use for the keyboard alarm.
      * \param[in] alarmVolume Volume of the sound alarm.
-     * \param[in] watchEvents Events to watch for modification.
-     * \param[in] t           Pointer to the watcher thread.
+     * \param[in] watchId     Identifier of the object in the watcher thread.
      *
      */
-    Object(const std::wstring &objectPath, const AlarmFlags alarmFlags,
+    Object(const WatchedObject &watched, const bool isDirectory, const AlarmFlags alarmFlags,
            const QColor &lightsColor, const unsigned char alarmVolume,
-           const Events watchEvents, WatchThread *t)
-    : path{objectPath}, alarms{alarmFlags}, color{lightsColor},
-      volume{alarmVolume}, events{watchEvents}, thread{t},
-      eventsNumber{0}, inAlarm{false}
+           const WatchThread::ObjectId watchId)
+    : path{watched.path}, directory{isDirectory}, alarms{alarmFlags}, color{lightsColor},
+      volume{alarmVolume}, sound{watched.sound}, events{watched.events}, window{watched.window}, recursive{watched.recursive},
+      contents{watched.contents}, properties{watched.properties}, include{watched.include},
+      exclude{watched.exclude}, gitIgnore{watched.gitIgnore}, id{watchId},
+      eventsNumber{0}, overflowsNumber{0}, inAlarm{false}
       {};
 
-    std::filesystem::path path;         /** object path.                      */
-    AlarmFlags            alarms;       /** alarms for the user.              */
-    QColor                color;        /** color for keyboard alarm.         */
-    unsigned char         volume;       /** volume of sound alarm in [1-100]. */
-    Events                events;       /** events to watch.                  */
-    WatchThread          *thread;       /** watcher thread.                   */
-    unsigned long         eventsNumber; /** number of registed events.        */
-    bool                  inAlarm;      /** true if currently in alarm mode.  */
+    std::filesystem::path path;            /** object path.                      */
+    bool                  directory;       /** true if a directory, not a file.  */
+    AlarmFlags            alarms;          /** alarms for the user.              */
+    QColor                color;           /** color for keyboard alarm.         */
+    unsigned char         volume;          /** volume of sound alarm in [1-100]. */
+    QString               sound;           /** sound file, empty for default.    */
+    Events                events;          /** events to watch.                  */
+    unsigned int          window;          /** merge window in milliseconds.     */
+    bool                  recursive;       /** true to watch the subtree.        */
+    bool                  contents;        /** true to compare the contents.     */
+    Properties            properties;      /** watched modified properties.      */
+    QString               include;         /** included path patterns.           */
+    QString               exclude;         /** excluded path patterns.           */
+    bool                  gitIgnore;       /** true to use the '.gitignore'.     */
+    WatchThread::ObjectId id;              /** identifier in the watcher thread. */
+    unsigned long         eventsNumber;    /** number of registed events.        */
+    unsigned long         overflowsNumber; /** number of notification overflows. */
+    bool                  inAlarm;         /** true if currently in alarm mode.  */
 
     friend class FilesystemWatcher;
 };
@@ -0,0 +1,187 @@
+/*
+ File: GitIgnore.cpp
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <GitIgnore.h>
+
+// Qt
+#include <QFile>
+#include <QString>
+
+const std::wstring IGNORE_FILE = L".gitignore";
+const std::wstring GIT_DIRECTORY = L".git";
+
+//-----------------------------------------------------------------------------
+GitIgnore::GitIgnore(const std::filesystem::path &root)
+: m_root{root}
+{
+}
+
+//-----------------------------------------------------------------------------
+bool GitIgnore::isIgnored(std::wstring_view path)
+{
+  m_path.assign(path);
+  for(auto &c: m_path) c = PathFilter::fold(c);
+
+  std::wstring_view folded{m_path};
+  while(!folded.empty() && folded.back() == L'/') folded.remove_suffix(1);
+
+  // the path and its parent directories, from the root down, an ignored directory ignores its contents.
+  for(size_t begin = 0; begin < folded.size();)
+  {
+    auto end = folded.find(L'/', begin);
+    if(end == std::wstring_view::npos) end = folded.size();
+
+    const auto prefix = folded.substr(0, end);
+    const auto name = folded.substr(begin, end - begin);
+    if(name == GIT_DIRECTORY) return true;
+
+    // the parents are directories, the path itself is only read if a rule needs it.
+    int isDirectory = end < folded.size() ? 1 : -1;
+    auto checkDirectory = [&]()
+    {
+      if(isDirectory < 0)
+      {
+        std::error_code ec;
+        isDirectory = std::filesystem::is_directory(m_root / path, ec) ? 1 : 0;
+      }
+      return isDirectory == 1;
+    };
+
+    // the rules of the deeper directories come later and take precedence.
+    bool ignored = false;
+    for(size_t directory = 0; ;)
+    {
+      const auto relative = directory == 0 ? prefix : prefix.substr(directory + 1);
+
+      for(const auto &rule: rules(prefix.substr(0, directory)).rules)
+      {
+        if(ignored != rule.negate) continue;
+        if(!rule.glob.matches(rule.isPath ? relative : name)) continue;
+        if(rule.directoryOnly && !checkDirectory()) continue;
+
+        ignored = !rule.negate;
+      }
+
+      directory = prefix.find(L'/', directory == 0 ? 0 : directory + 1);
+      if(directory == std::wstring_view::npos) break;
+    }
+
+    if(ignored) return true;
+
+    begin = end + 1;
+  }
+
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+void GitIgnore::update(std::wstring_view path)
+{
+  if(m_rules.empty()) return;
+
+  m_path.assign(path);
+  for(auto &c: m_path) c = PathFilter::fold(c);
+
+  std::wstring_view folded{m_path};
+  while(!folded.empty() && folded.back() == L'/') folded.remove_suffix(1);
+
+  // a changed ignore file changes the rules of its directory, a changed directory may have other rules.
+  auto directory = folded;
+  const auto separator = folded.rfind(L'/');
+  const auto name = separator == std::wstring_view::npos ? folded : folded.substr(separator + 1);
+  if(name == IGNORE_FILE) directory = separator == std::wstring_view::npos ? std::wstring_view() : folded.substr(0, separator);
+
+  if(folded == L".git/info/exclude") directory = std::wstring_view();
+
+  const auto range = m_rules.equal_range(hash(directory));
+  for(auto it = range.first; it != range.second; ++it)
+  {
+    if(it->second.directory == directory)
+    {
+      m_rules.erase(it);
+      return;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void GitIgnore::clear()
+{
+  m_rules.clear();
+}
+
+//-----------------------------------------------------------------------------
+const GitIgnore::Rules &GitIgnore::rules(std::wstring_view directory)
+{
+  const auto key = hash(directory);
+
+  const auto range = m_rules.equal_range(key);
+  for(auto it = range.first; it != range.second; ++it)
+  {
+    if(it->second.directory == directory) return it->second;
+  }
+
+  Rules rules;
+  rules.directory = directory;
+
+  // the exclusions of the repository come before the ones of its files.
+  const auto path = directory.empty() ? m_root : m_root / directory;
+  if(directory.empty()) read(m_root / GIT_DIRECTORY / L"info" / L"exclude", rules.rules);
+  read(path / IGNORE_FILE, rules.rules);
+
+  return m_rules.emplace(key, std::move(rules))->second;
+}
+
+//-----------------------------------------------------------------------------
+void GitIgnore::read(const std::filesystem::path &file, std::vector<Rule> &rules)
+{
+  QFile ignoreFile(QString::fromStdWString(file.wstring()));
+  if(!ignoreFile.open(QIODevice::ReadOnly)) return;
+
+  while(!ignoreFile.atEnd())
+  {
+    auto line = QString::fromUtf8(ignoreFile.readLine()).toStdWString();
+
+    while(!line.empty() && (line.back() == L'\n' || line.back() == L'\r')) line.pop_back();
+
+    // trailing spaces are ignored unless escaped.
+    while(!line.empty() && line.back() == L' ' && (line.size() < 2 || line[line.size() - 2] != L'\\')) line.pop_back();
+    if(line.size() > 1 && line.back() == L' ') line.erase(line.size() - 2, 1);
+
+    if(line.empty() || line.front() == L'#') continue;
+
+    const bool negate = line.front() == L'!';
+    if(negate) line.erase(0, 1);
+    else if(line.size() > 1 && line.front() == L'\\' && (line[1] == L'!' || line[1] == L'#')) line.erase(0, 1);
+
+    const bool directoryOnly = !line.empty() && line.back() == L'/';
+    while(!line.empty() && line.back() == L'/') line.pop_back();
+
+    // a separator anywhere but at the end makes the pattern relative to the directory of the file.
+    const bool isPath = line.find(L'/') != std::wstring::npos;
+    while(!line.empty() && line.front() == L'/') line.erase(0, 1);
+
+    if(line.empty()) continue;
+
+    for(auto &c: line) c = PathFilter::fold(c);
+
+    rules.push_back(Rule{PathFilter::Glob(line), negate, directoryOnly, isPath});
+  }
+}
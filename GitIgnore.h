@@ -0,0 +1,117 @@
+/*
+ File: GitIgnore.h
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GITIGNORE_H_
+#define GITIGNORE_H_
+
+// Project
+#include <PathFilter.h>
+
+// C++
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/** \class GitIgnore
+ * \brief Decides which paths of a source tree are ignored by its hierarchical '.gitignore' files,
+ * the '.git/info/exclude' file of the tree and the '.git' directories. The rules of a directory are
+ * read the first time a path inside it is checked and kept until its '.gitignore' changes. As in
+ * git, the last matching rule of the deepest file wins and the contents of an ignored directory
+ * can't be included again.
+ *
+ */
+class GitIgnore
+{
+  public:
+    /** \brief GitIgnore class constructor.
+     * \param[in] root Path of the root directory of the tree.
+     *
+     */
+    explicit GitIgnore(const std::filesystem::path &root);
+
+    /** \brief Returns true if the path is ignored.
+     * \param[in] path Path relative to the root directory.
+     *
+     */
+    bool isIgnored(std::wstring_view path);
+
+    /** \brief Forgets the rules affected by the change of the path, so they are read again when needed.
+     * \param[in] path Path of the changed object relative to the root directory.
+     *
+     */
+    void update(std::wstring_view path);
+
+    /** \brief Forgets the rules of all the directories.
+     *
+     */
+    void clear();
+
+  private:
+    /** \struct Rule
+     * \brief Pattern of an ignore file.
+     *
+     */
+    struct Rule
+    {
+      PathFilter::Glob glob;          /** compiled pattern.                                             */
+      bool             negate;        /** true if the pattern includes the paths again.                 */
+      bool             directoryOnly; /** true if the pattern only matches directories.                 */
+      bool             isPath;        /** true if matched against the path relative to the ignore file's
+                                          directory and false if matched against the name.              */
+    };
+
+    /** \struct Rules
+     * \brief Rules of a directory of the tree.
+     *
+     */
+    struct Rules
+    {
+      std::wstring      directory; /** folded path of the directory relative to the root. */
+      std::vector<Rule> rules;     /** rules in file order.                               */
+    };
+
+    /** \brief Returns the rules of the directory, reading them if not known.
+     * \param[in] directory Folded path of the directory relative to the root, empty for the root.
+     *
+     */
+    const Rules &rules(std::wstring_view directory);
+
+    /** \brief Adds the rules of the ignore file, if it exists.
+     * \param[in] file Path of the ignore file.
+     * \param[out] rules Rules of the directory.
+     *
+     */
+    static void read(const std::filesystem::path &file, std::vector<Rule> &rules);
+
+    /** \brief Returns the hash of the directory path.
+     * \param[in] directory Folded path of the directory relative to the root.
+     *
+     */
+    static size_t hash(std::wstring_view directory)
+    { return std::hash<std::wstring_view>()(directory); }
+
+    std::filesystem::path                  m_root;  /** root directory of the tree.                         */
+    std::unordered_multimap<size_t, Rules> m_rules; /** hash of a directory path to the rules of the
+                                                        directories with that hash.                     */
+    std::wstring                           m_path;  /** buffer of the folded path.                          */
+};
+
+#endif // GITIGNORE_H_
@@ -0,0 +1,301 @@
+/*
+ File: HeadlessWatcher.cpp
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <HeadlessWatcher.h>
+#include <EventJournal.h>
+#include <WatchSettings.h>
+
+// Qt
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSettings>
+#include <QTimer>
+
+// C++
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <filesystem>
+
+const int DRAIN_INTERVAL = 50; /** milliseconds between takes of the queued changes. */
+
+static std::atomic<bool> stopRequested = false;
+
+//-----------------------------------------------------------------------------
+static void onStopSignal(int)
+{
+  stopRequested = true;
+}
+
+//-----------------------------------------------------------------------------
+HeadlessWatcher::HeadlessWatcher(QObject *p)
+: QObject{p}
+, m_watcher{new WatchThread(this)}
+, m_journal{nullptr}
+, m_drainTimer{new QTimer(this)}
+, m_lost{0}
+{
+  connect(m_watcher, SIGNAL(error(const QString)),
+          this,      SLOT(onError(const QString)));
+
+  connect(m_drainTimer, SIGNAL(timeout()),
+          this,         SLOT(onDrainTimeout()));
+}
+
+//-----------------------------------------------------------------------------
+HeadlessWatcher::~HeadlessWatcher()
+{
+  m_drainTimer->stop();
+
+  m_watcher->abort();
+  m_watcher->wait();
+
+  // the last changes of the watcher.
+  if(m_output.isOpen()) onDrainTimeout();
+
+  if(m_journal)
+  {
+    m_journal->abort();
+    m_journal->wait();
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool HeadlessWatcher::start(const QString &output, QString &error)
+{
+  if(output.isEmpty())
+  {
+    m_output.open(stdout, QIODevice::WriteOnly);
+  }
+  else
+  {
+    m_output.setFileName(output);
+    m_output.open(QIODevice::WriteOnly|QIODevice::Append);
+  }
+
+  if(!m_output.isOpen())
+  {
+    error = tr("Unable to open the output '%1': %2").arg(QDir::toNativeSeparators(output)).arg(m_output.errorString());
+    return false;
+  }
+
+  const auto settings = WatchSettings::applicationSettings();
+
+  const auto objects = WatchSettings::loadObjects(*settings);
+  if(objects.empty())
+  {
+    error = tr("There are no objects to watch in the settings '%1'.").arg(QDir::toNativeSeparators(settings->fileName()));
+    return false;
+  }
+
+  size_t capacity = WatchThread::DEFAULT_QUEUE_CAPACITY;
+  EventRing::Overflow overflow = EventRing::Overflow::COLLAPSE;
+  WatchSettings::loadQueue(*settings, capacity, overflow);
+  m_watcher->setQueue(capacity, overflow);
+
+  m_journal = WatchSettings::createJournal(*settings, this);
+  if(m_journal)
+  {
+    m_watcher->setJournal(m_journal);
+
+    connect(m_journal, SIGNAL(error(const QString)),
+            this,      SLOT(onError(const QString)));
+  }
+
+  std::vector<WatchedObject> existing;
+  existing.reserve(objects.size());
+
+  for(const auto &object: objects)
+  {
+    if(!std::filesystem::exists(object.path))
+    {
+      onError(tr("Cannot find object '%1'.").arg(QDir::toNativeSeparators(QString::fromStdWString(object.path.wstring()))));
+      continue;
+    }
+
+    existing.push_back(object);
+  }
+
+  const auto ids = WatchSettings::addObjects(*m_watcher, existing);
+  for(size_t i = 0; i < ids.size(); ++i)
+  {
+    m_objects.emplace(ids.at(i), QString::fromStdWString(existing.at(i).path.wstring()));
+  }
+
+  // a service is stopped with a signal, the last changes are written before quitting.
+  std::signal(SIGINT, onStopSignal);
+  std::signal(SIGTERM, onStopSignal);
+
+  m_drainTimer->start(DRAIN_INTERVAL);
+  if(m_journal) m_journal->start();
+  m_watcher->start();
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void HeadlessWatcher::onDrainTimeout()
+{
+  m_changes.clear();
+  m_summaries.clear();
+
+  if(m_watcher->drain(m_changes, m_summaries))
+  {
+    for(const auto event: m_changes) write(event);
+
+    for(const auto &summary: m_summaries)
+    {
+      const auto object = m_objects.find(summary.key);
+      if(object == m_objects.end()) continue;
+
+      QJsonObject line;
+      line["time"] = timeText(0);
+      line["object"] = object->second;
+      line["path"] = object->second;
+      line["event"] = eventText(summary.event);
+      line["count"] = static_cast<qint64>(summary.count);
+      line["collapsed"] = true;
+
+      append(line);
+    }
+  }
+
+  writeDropped();
+  flush();
+
+  if(stopRequested) QCoreApplication::quit();
+}
+
+//-----------------------------------------------------------------------------
+void HeadlessWatcher::onError(const QString message)
+{
+  QJsonObject line;
+  line["time"] = timeText(0);
+  line["error"] = message;
+
+  append(line);
+  flush();
+}
+
+//-----------------------------------------------------------------------------
+void HeadlessWatcher::write(const Event &event)
+{
+  QJsonObject line;
+  line["time"] = timeText(event.time);
+
+  const auto object = m_objects.find(event.id);
+  if(object != m_objects.end()) line["object"] = object->second;
+
+  line["path"] = QString::fromWCharArray(event.object.data(), event.object.size());
+  if(!event.oldName.empty()) line["oldPath"] = QString::fromWCharArray(event.oldName.data(), event.oldName.size());
+
+  line["event"] = eventText(event.event);
+  line["count"] = static_cast<qint64>(event.count);
+
+  // all the properties are the unknown ones.
+  if(event.event == Events::MODIFIED && event.properties != Properties::ALL)
+  {
+    QJsonArray properties;
+    if((event.properties & Properties::SIZE) != Properties::NONE)       properties.append("size");
+    if((event.properties & Properties::WRITE_TIME) != Properties::NONE) properties.append("write time");
+    if((event.properties & Properties::ATTRIBUTES) != Properties::NONE) properties.append("attributes");
+    if((event.properties & Properties::SECURITY) != Properties::NONE)   properties.append("security");
+    if((event.properties & Properties::OTHER) != Properties::NONE)      properties.append("other");
+
+    line["properties"] = properties;
+  }
+
+  append(line);
+}
+
+//-----------------------------------------------------------------------------
+void HeadlessWatcher::writeDropped()
+{
+  const auto &queue = m_watcher->queue();
+  const auto dropped = queue.dropped();
+  const auto collapsed = queue.collapsed();
+  if(dropped + collapsed == m_lost) return;
+
+  m_lost = dropped + collapsed;
+
+  QJsonObject line;
+  line["time"] = timeText(0);
+  line["dropped"] = static_cast<qint64>(dropped);
+  line["collapsed"] = static_cast<qint64>(collapsed);
+
+  append(line);
+}
+
+//-----------------------------------------------------------------------------
+void HeadlessWatcher::append(const QJsonObject &line)
+{
+  m_buffer.append(QJsonDocument(line).toJson(QJsonDocument::Compact));
+  m_buffer.append('\n');
+}
+
+//-----------------------------------------------------------------------------
+void HeadlessWatcher::flush()
+{
+  if(m_buffer.isEmpty()) return;
+
+  m_output.write(m_buffer);
+  m_output.flush();
+  m_buffer.clear();
+}
+
+//-----------------------------------------------------------------------------
+QString HeadlessWatcher::timeText(const long long time)
+{
+  const auto dateTime = time > 0 ? QDateTime::fromMSecsSinceEpoch(time / 1000).toUTC() : QDateTime::currentDateTimeUtc();
+
+  return dateTime.toString(Qt::ISODateWithMs);
+}
+
+//-----------------------------------------------------------------------------
+QString HeadlessWatcher::eventText(const Events e)
+{
+  switch(e)
+  {
+    case Events::ADDED:
+      return "added";
+      break;
+    case Events::REMOVED:
+      return "removed";
+      break;
+    case Events::MODIFIED:
+      return "modified";
+      break;
+    case Events::RENAMED_OLD:
+    case Events::RENAMED_NEW:
+      return "renamed";
+      break;
+    case Events::LOST:
+      return "lost";
+      break;
+    default:
+      break;
+  }
+
+  return "unknown";
+}
@@ -0,0 +1,131 @@
+/*
+ File: HeadlessWatcher.h
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HEADLESSWATCHER_H_
+#define HEADLESSWATCHER_H_
+
+// Project
+#include <EventBatch.h>
+#include <EventRing.h>
+#include <WatchThread.h>
+
+// Qt
+#include <QObject>
+#include <QFile>
+#include <QByteArray>
+#include <QString>
+
+// C++
+#include <unordered_map>
+#include <vector>
+
+class EventJournal;
+class QJsonObject;
+class QTimer;
+
+/** \class HeadlessWatcher
+ * \brief Watches the objects of the application settings without a GUI and writes the changes as
+ * JSON lines, one object per line, to the standard output or a file. There are no alarms, the
+ * changes are only written and recorded in the journal if enabled.
+ *
+ */
+class HeadlessWatcher
+: public QObject
+{
+    Q_OBJECT
+  public:
+    /** \brief HeadlessWatcher class constructor.
+     * \param[in] p Raw pointer of the object parent of this one.
+     *
+     */
+    explicit HeadlessWatcher(QObject *p = nullptr);
+
+    /** \brief HeadlessWatcher class virtual destructor. Stops the threads.
+     *
+     */
+    virtual ~HeadlessWatcher();
+
+    /** \brief Opens the output and starts watching the objects of the settings. Returns true on
+     * success and false otherwise.
+     * \param[in] output Path of the file to append the changes to, empty for the standard output.
+     * \param[out] error Error message in case of failure.
+     *
+     */
+    bool start(const QString &output, QString &error);
+
+  private slots:
+    /** \brief Takes the changes queued by the watcher thread and writes them.
+     *
+     */
+    void onDrainTimeout();
+
+    /** \brief Writes the error of a thread.
+     * \param[in] message Error message.
+     *
+     */
+    void onError(const QString message);
+
+  private:
+    /** \brief Writes the change as a line.
+     * \param[in] event Change of a watched object.
+     *
+     */
+    void write(const Event &event);
+
+    /** \brief Writes the number of changes lost because the queue was full, if changed.
+     *
+     */
+    void writeDropped();
+
+    /** \brief Adds the line of the given object to the buffer.
+     * \param[in] line JSON object of the line.
+     *
+     */
+    void append(const QJsonObject &line);
+
+    /** \brief Writes the buffer to the output.
+     *
+     */
+    void flush();
+
+    /** \brief Returns the time of the line of the given time in microseconds since the epoch, or of
+     * now if 0.
+     * \param[in] time Microseconds since the epoch.
+     *
+     */
+    static QString timeText(const long long time);
+
+    /** \brief Returns the name of the event in the lines.
+     * \param[in] e Event.
+     *
+     */
+    static QString eventText(const Events e);
+
+    WatchThread                                        *m_watcher;    /** thread watching all the objects.                */
+    EventJournal                                       *m_journal;    /** thread recording the changes, if enabled.       */
+    QTimer                                             *m_drainTimer; /** timer to take the queued changes.               */
+    QFile                                               m_output;     /** output of the lines.                            */
+    QByteArray                                          m_buffer;     /** lines not yet written.                          */
+    std::unordered_map<WatchThread::ObjectId, QString>  m_objects;    /** path of every watched object.                   */
+    EventBatch                                          m_changes;    /** buffer of the queued changes.                   */
+    std::vector<EventRing::Summary>                     m_summaries;  /** buffer of the collapsed changes.                */
+    unsigned long long                                  m_lost;       /** changes dropped or collapsed when last written. */
+};
+
+#endif // HEADLESSWATCHER_H_
@@ -0,0 +1,1088 @@
+/*
+ File: InotifyWatchBackend.cpp
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <InotifyWatchBackend.h>
+
+// Qt
+#include <QObject>
+
+// C++
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <climits>
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#ifdef WITH_FANOTIFY
+#include <sys/fanotify.h>
+#include <sys/statfs.h>
+#endif
+
+const uint32_t InotifyWatchBackend::watchFlags =
+  IN_ONLYDIR    | /** Only watch pathname if it is a directory.                              */
+  IN_DONT_FOLLOW; /** Don't dereference pathname if it is a symbolic link.                   */
+
+const size_t InotifyWatchBackend::INITIAL_BUFFER_SIZE = 64 * (sizeof(struct inotify_event) + NAME_MAX + 1);
+const size_t InotifyWatchBackend::MAXIMUM_BUFFER_SIZE = 1024 * 1024;
+
+#ifdef WITH_FANOTIFY
+const uint64_t InotifyWatchBackend::fanotifyProperties =
+  FAN_DELETE     | /** File/directory deleted from a directory of the filesystem.                */
+  FAN_MOVED_FROM | /** File/directory moved from a directory of the filesystem.                 */
+  FAN_MOVED_TO   | /** File/directory moved to a directory of the filesystem.                   */
+  FAN_ONDIR;       /** Also report the changes of directories, not only of files.              */
+
+const size_t InotifyWatchBackend::MAXIMUM_HANDLES = 65536;
+
+#ifdef FAN_RENAME
+const uint64_t InotifyWatchBackend::renameMask = FAN_RENAME;
+#else
+const uint64_t InotifyWatchBackend::renameMask = 0;
+#endif
+#endif
+
+//-----------------------------------------------------------------------------
+InotifyWatchBackend::InotifyWatchBackend()
+: m_epollFd{-1}
+, m_fd{-1}
+, m_wakeFd{-1}
+, m_buffer(INITIAL_BUFFER_SIZE, 0)
+#ifdef WITH_FANOTIFY
+, m_fanotifyFd{-1}
+#endif
+{
+}
+
+//-----------------------------------------------------------------------------
+InotifyWatchBackend::~InotifyWatchBackend()
+{
+#ifdef WITH_FANOTIFY
+  for(const auto &filesystem: m_filesystems) close(filesystem.second.fd);
+
+  if(m_fanotifyFd != -1) close(m_fanotifyFd);
+#endif
+
+  // closing the descriptors removes all the watches and marks.
+  for(auto fd: {m_fd, m_wakeFd, m_epollFd})
+  {
+    if(fd != -1) close(fd);
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool InotifyWatchBackend::open(QString &error)
+{
+  auto systemError = [&error](const QString &message)
+  {
+    error = message.arg(QString::fromLocal8Bit(strerror(errno)));
+    return false;
+  };
+
+  m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+  if(m_epollFd == -1) return systemError(QObject::tr("Unable to create epoll instance. Error: %1"));
+
+  m_wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if(m_wakeFd == -1) return systemError(QObject::tr("Unable to create signal event descriptor. Error: %1"));
+
+  m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if(m_fd == -1) return systemError(QObject::tr("Unable to create inotify instance. Error: %1"));
+
+  std::vector<int> descriptors{m_wakeFd, m_fd};
+
+#ifdef WITH_FANOTIFY
+  // needs CAP_SYS_ADMIN, without it the recursive watches use inotify.
+  m_fanotifyFd = fanotify_init(FAN_CLASS_NOTIF | FAN_CLOEXEC | FAN_NONBLOCK | FAN_REPORT_DFID_NAME, O_RDONLY | O_LARGEFILE);
+  if(m_fanotifyFd != -1) descriptors.push_back(m_fanotifyFd);
+#endif
+
+  for(auto fd: descriptors)
+  {
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+
+    if(epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) == -1)
+      return systemError(QObject::tr("Unable to add descriptor to epoll instance. Error: %1"));
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool InotifyWatchBackend::addWatch(const WatchId id, const std::filesystem::path &directory, bool recursive,
+                                   const Events events, const Properties properties, QString &error)
+{
+  m_watches[id] = Watch{directory, recursive, false, inotifyMask(events, properties)};
+
+#ifdef WITH_FANOTIFY
+  auto &watch = m_watches.at(id);
+  watch.fanMask = fanotifyMask(events, properties);
+
+  if(recursive && m_fanotifyFd != -1)
+  {
+    // filesystems that can't report file handles can't be marked, those are watched with inotify.
+    QString markError;
+    if(addFilesystemMark(watch, markError)) return true;
+  }
+#endif
+
+  if(!addDescriptors(id, std::filesystem::path(), error))
+  {
+    removeWatch(id);
+    return false;
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool InotifyWatchBackend::updateWatch(const WatchId id, const Events events, const Properties properties, QString &error)
+{
+  const auto it = m_watches.find(id);
+  if(it == m_watches.end()) return true;
+
+  auto &watch = it->second;
+  const auto mask = watch.mask;
+  watch.mask = inotifyMask(events, properties);
+
+#ifdef WITH_FANOTIFY
+  const auto fanMask = watch.fanMask;
+  watch.fanMask = fanotifyMask(events, properties);
+
+  if(watch.fanotify)
+  {
+    if(updateFilesystemMark(watch.fsid, error)) return true;
+
+    watch.mask = mask;
+    watch.fanMask = fanMask;
+    return false;
+  }
+#endif
+
+  bool success = true;
+  auto sameId = [id](const Subscriber &s) { return s.id == id; };
+  for(const auto &descriptor: m_descriptors)
+  {
+    const auto &subscribers = descriptor.second;
+    if(std::any_of(subscribers.cbegin(), subscribers.cend(), sameId)) success = success && updateDescriptor(descriptor.first, error);
+  }
+
+  // the descriptors already updated only wake up for more changes than needed.
+  if(!success) watch.mask = mask;
+
+  return success;
+}
+
+//-----------------------------------------------------------------------------
+void InotifyWatchBackend::removeWatch(const WatchId id)
+{
+#ifdef WITH_FANOTIFY
+  const auto it = m_watches.find(id);
+  if(it != m_watches.end() && it->second.fanotify)
+  {
+    // the mark keeps the events of the remaining watches of the filesystem.
+    const auto watch = it->second;
+    m_watches.erase(it);
+
+    removeFilesystemMark(watch);
+    return;
+  }
+#endif
+
+  removeDescriptors(id, std::filesystem::path());
+  m_watches.erase(id);
+}
+
+#ifdef WITH_FANOTIFY
+//-----------------------------------------------------------------------------
+bool InotifyWatchBackend::isFilesystemWatch(const WatchId id) const
+{
+  const auto it = m_watches.find(id);
+  return it != m_watches.end() && it->second.fanotify;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+bool InotifyWatchBackend::wait(Listener &listener, QString &error, const int timeout)
+{
+  std::array<struct epoll_event, 3> events;
+
+  int count = 0;
+  while((count = epoll_wait(m_epollFd, events.data(), events.size(), timeout)) == -1)
+  {
+    if(errno != EINTR)
+    {
+      error = QObject::tr("Unable to wait for changes. Error: %1").arg(QString::fromLocal8Bit(strerror(errno)));
+      return false;
+    }
+  }
+
+  for(int i = 0; i < count; ++i)
+  {
+    if(events[i].data.fd == m_wakeFd)
+    {
+      uint64_t value = 0;
+      [[maybe_unused]] const auto result = ::read(m_wakeFd, &value, sizeof(value));
+      continue;
+    }
+
+#ifdef WITH_FANOTIFY
+    if(events[i].data.fd == m_fanotifyFd)
+    {
+      if(!readFanotify(listener, error)) return false;
+      continue;
+    }
+#endif
+
+    if(!readInotify(listener, error)) return false;
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool InotifyWatchBackend::readInotify(Listener &listener, QString &error)
+{
+  const auto length = ::read(m_fd, m_buffer.data(), m_buffer.size());
+  if(length == -1)
+  {
+    if(errno == EAGAIN || errno == EINTR) return true;
+
+    error = QObject::tr("Unable to read changes. Error: %1").arg(QString::fromLocal8Bit(strerror(errno)));
+    return false;
+  }
+
+  // Renames are reported as a IN_MOVED_FROM, IN_MOVED_TO pair with the same cookie. An unpaired
+  // event is a file moved out or into the watched directories.
+  const struct inotify_event *movedFrom = nullptr;
+  for(auto position = m_buffer.data(); position < m_buffer.data() + length;)
+  {
+    const auto event = reinterpret_cast<const struct inotify_event *>(position);
+    position += sizeof(struct inotify_event) + event->len;
+
+    if(event->mask & IN_Q_OVERFLOW)
+    {
+      processOverflow(listener, false);
+      continue;
+    }
+
+    if(event->mask & IN_MOVED_FROM)
+    {
+      if(movedFrom) processMove(movedFrom, nullptr, listener);
+      movedFrom = event;
+      continue;
+    }
+
+    if(event->mask & IN_MOVED_TO)
+    {
+      if(movedFrom && movedFrom->cookie == event->cookie)
+      {
+        processMove(movedFrom, event, listener);
+      }
+      else
+      {
+        if(movedFrom) processMove(movedFrom, nullptr, listener);
+        processMove(nullptr, event, listener);
+      }
+      movedFrom = nullptr;
+      continue;
+    }
+
+    if(movedFrom)
+    {
+      processMove(movedFrom, nullptr, listener);
+      movedFrom = nullptr;
+    }
+
+    processEvent(event, listener);
+  }
+
+  if(movedFrom) processMove(movedFrom, nullptr, listener);
+
+  adjustBuffer(length);
+
+  return true;
+}
+
+#ifdef WITH_FANOTIFY
+//-----------------------------------------------------------------------------
+bool InotifyWatchBackend::readFanotify(Listener &listener, QString &error)
+{
+  const auto length = ::read(m_fanotifyFd, m_buffer.data(), m_buffer.size());
+  if(length == -1)
+  {
+    if(errno == EAGAIN || errno == EINTR) return true;
+
+    error = QObject::tr("Unable to read changes. Error: %1").arg(QString::fromLocal8Bit(strerror(errno)));
+    return false;
+  }
+
+  auto remaining = length;
+  for(auto metadata = reinterpret_cast<struct fanotify_event_metadata *>(m_buffer.data());
+      FAN_EVENT_OK(metadata, remaining);
+      metadata = FAN_EVENT_NEXT(metadata, remaining))
+  {
+    if(metadata->vers != FANOTIFY_METADATA_VERSION)
+    {
+      error = QObject::tr("Unable to read changes. Error: %1").arg(QObject::tr("unknown fanotify version %1.").arg(metadata->vers));
+      return false;
+    }
+
+    if(metadata->mask & FAN_Q_OVERFLOW)
+    {
+      processOverflow(listener, true);
+      continue;
+    }
+
+    // the directory of the change and the name of the changed object in it, the old and new ones if renamed.
+    // Directories removed before their changes are read can't be resolved, their removal is reported.
+    std::filesystem::path path, oldPath;
+    bool resolved = true;
+    for(size_t offset = sizeof(*metadata); offset + sizeof(struct fanotify_event_info_header) <= metadata->event_len;)
+    {
+      auto info = reinterpret_cast<struct fanotify_event_info_fid *>(reinterpret_cast<char *>(metadata) + offset);
+      if(info->hdr.len == 0) break;
+      offset += info->hdr.len;
+
+      switch(info->hdr.info_type)
+      {
+        case FAN_EVENT_INFO_TYPE_DFID_NAME:
+#ifdef FAN_RENAME
+        case FAN_EVENT_INFO_TYPE_NEW_DFID_NAME:
+#endif
+          resolved &= resolvePath(info, path);
+          break;
+#ifdef FAN_RENAME
+        case FAN_EVENT_INFO_TYPE_OLD_DFID_NAME:
+          resolved &= resolvePath(info, oldPath);
+          break;
+#endif
+        default:
+          break;
+      }
+    }
+
+    if(!resolved || path.empty()) continue;
+
+    // the paths of the directories below a moved or removed one are no longer valid.
+    if((metadata->mask & FAN_ONDIR) && (metadata->mask & (FAN_MOVED_FROM | FAN_MOVED_TO | FAN_DELETE | renameMask))) m_handles.clear();
+
+    if(metadata->mask & renameMask)
+    {
+      processFanotifyMove(oldPath, path, listener);
+    }
+    else
+    {
+      processFanotifyEvent(path, metadata->mask, listener);
+    }
+  }
+
+  adjustBuffer(length);
+
+  return true;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+void InotifyWatchBackend::adjustBuffer(const size_t length)
+{
+  // read in bigger chunks if changes arrive faster than they are read.
+  if(length > (m_buffer.size() * 3) / 4 && m_buffer.size() < MAXIMUM_BUFFER_SIZE)
+  {
+    m_buffer.resize(std::min(m_buffer.size() * 2, MAXIMUM_BUFFER_SIZE), 0);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void InotifyWatchBackend::wakeUp()
+{
+  const uint64_t value = 1;
+  [[maybe_unused]] const auto result = write(m_wakeFd, &value, sizeof(value));
+}
+
+//-----------------------------------------------------------------------------
+void InotifyWatchBackend::processOverflow(Listener &listener, bool fanotify)
+{
+  // the kernel queue is shared by all the watches of the instance, all of them lost changes.
+  std::vector<WatchId> ids;
+  for(const auto &watch: m_watches)
+  {
+    if(watch.second.fanotify == fanotify) ids.push_back(watch.first);
+  }
+
+  for(const auto id: ids)
+  {
+    if(!fanotify && m_watches.at(id).recursive) resyncDescriptors(id);
+    listener.onOverflow(id);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void InotifyWatchBackend::resyncDescriptors(const WatchId id)
+{
+  const auto &watch = m_watches.at(id);
+
+  // adding is idempotent for the directories that already have a descriptor.
+  QString ignored;
+  addDescriptors(id, std::filesystem::path(), ignored);
+
+  for(auto it = m_descriptors.begin(); it != m_descriptors.end();)
+  {
+    auto &subscribers = it->second;
+    auto isRemoved = [id, &watch](const Subscriber &s)
+    {
+      std::error_code ec;
+      return s.id == id && !std::filesystem::is_directory(watch.directory / s.relative, ec);
+    };
+    subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(), isRemoved), subscribers.end());
+
+    if(subscribers.empty())
+    {
+      inotify_rm_watch(m_fd, it->first);
+      it = m_descriptors.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void InotifyWatchBackend::processEvent(const struct inotify_event *event, Listener &listener)
+{
+  const auto it = m_descriptors.find(event->wd);
+  if(it == m_descriptors.end()) return;
+
+  if(event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF))
+  {
+    // failing a watch removes its subscriptions, the watches of the directory are taken first.
+    std::vector<WatchId> failed;
+    for(const auto &subscriber: it->second)
+    {
+      if(subscriber.relative.empty()) failed.push_back(subscriber.id);
+    }
+
+    for(const auto id: failed) failWatch(id, listener);
+
+    if(event->mask & IN_IGNORED) m_descriptors.erase(event->wd);
+    return;
+  }
+
+  // changes of the watched directories themselves are not reported, same as ReadDirectoryChangesW.
+  if(event->len == 0) return;
+
+  const bool isDirectory = (event->mask & IN_ISDIR) != 0;
+  const auto name = std::filesystem::path(event->name).wstring();
+
+  // not copied, the subscribers are looked up again for every one of them because the new directories
+  // and the listener can change the descriptors.
+  QString ignored;
+  for(size_t i = 0; ; ++i)
+  {
+    const auto descriptor = m_descriptors.find(event->wd);
+    if(descriptor == m_descriptors.end() || i >= descriptor->second.size()) break;
+
+    const auto &subscriber = descriptor->second[i];
+    const auto id = subscriber.id;
+    const auto watch = m_watches.find(id);
+    if(watch == m_watches.end()) continue;
+
+    m_name.assign(subscriber.prefix).append(name);
+
+    std::vector<std::filesystem::path> created;
+    if((event->mask & IN_CREATE) && isDirectory && watch->second.recursive) addDescriptors(id, subscriber.relative / event->name, ignored, &created);
+
+    // the descriptor can be shared with watches that need other changes.
+    if((event->mask & watch->second.mask) == 0) continue;
+
+    if(event->mask & IN_CREATE)
+    {
+      listener.onChange(id, m_name, Events::ADDED);
+
+      // the entries created before the descriptors of the new directories were added have no events
+      // of their own. One created while adding them can be reported twice.
+      for(const auto &entry: created) listener.onChange(id, entry.wstring(), Events::ADDED);
+    }
+    else if(event->mask & IN_DELETE)
+    {
+      listener.onChange(id, m_name, Events::REMOVED);
+    }
+    else if(event->mask & (IN_MODIFY | IN_ATTRIB))
+    {
+      listener.onChange(id, m_name, Events::MODIFIED);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void InotifyWatchBackend::processMove(const struct inotify_event *from, const struct inotify_event *to, Listener &listener)
+{
+  auto subscribersOf = [this](const struct inotify_event *event)
+  {
+    Subscribers result;
+    if(event)
+    {
+      const auto it = m_descriptors.find(event->wd);
+      if(it != m_descriptors.end()) result = it->second;
+    }
+    return result;
+  };
+
+  const auto fromSubscribers = subscribersOf(from);
+  const auto toSubscribers = subscribersOf(to);
+  const bool isDirectory = ((from ? from->mask : to->mask) & IN_ISDIR) != 0;
+
+  auto hasId = [](const Subscribers &subscribers, const WatchId id)
+  {
+    auto sameId = [id](const Subscriber &s) { return s.id == id; };
+    return std::find_if(subscribers.cbegin(), subscribers.cend(), sameId);
+  };
+
+  // the recursive watches follow the moved directories even if they don't report moves.
+  auto reportsMoves = [this](const WatchId id)
+  {
+    const auto watch = m_watches.find(id);
+    return watch != m_watches.end() && (watch->second.mask & (IN_MOVED_FROM | IN_MOVED_TO)) != 0;
+  };
+
+  for(const auto &subscriber: fromSubscribers)
+  {
+    const auto oldPath = subscriber.relative / from->name;
+    const bool reported = reportsMoves(subscriber.id);
+
+    const auto match = hasId(toSubscribers, subscriber.id);
+    if(match != toSubscribers.cend())
+    {
+      const auto newPath = match->relative / to->name;
+      if(isDirectory) renameDescriptors(subscriber.id, oldPath, newPath);
+      if(!reported) continue;
+
+      listener.onChange(subscriber.id, oldPath.wstring(), Events::RENAMED_OLD);
+      listener.onChange(subscriber.id, newPath.wstring(), Events::RENAMED_NEW);
+    }
+    else
+    {
+      if(isDirectory) removeDescriptors(subscriber.id, oldPath);
+      if(reported) listener.onChange(subscriber.id, oldPath.wstring(), Events::REMOVED);
+    }
+  }
+
+  QString ignored;
+  for(const auto &subscriber: toSubscribers)
+  {
+    if(hasId(fromSubscribers, subscriber.id) != fromSubscribers.cend()) continue;
+
+    const auto newPath = subscriber.relative / to->name;
+    const auto watch = m_watches.find(subscriber.id);
+    if(isDirectory && watch != m_watches.end() && watch->second.recursive) addDescriptors(subscriber.id, newPath, ignored);
+    if(reportsMoves(subscriber.id)) listener.onChange(subscriber.id, newPath.wstring(), Events::ADDED);
+  }
+}
+
+#ifdef WITH_FANOTIFY
+//-----------------------------------------------------------------------------
+void InotifyWatchBackend::processFanotifyEvent(const std::filesystem::path &path, const uint64_t mask, Listener &listener)
+{
+  // consecutive changes of the same object are merged in a single event, the current state of the
+  // object tells if it was removed and created again or created and then removed.
+  const bool appeared = (mask & (FAN_CREATE | FAN_MOVED_TO)) != 0;
+  const bool disappeared = (mask & (FAN_DELETE | FAN_MOVED_FROM)) != 0;
+
+  bool replaced = false;
+  if(appeared && disappeared)
+  {
+    std::error_code ec;
+    replaced = std::filesystem::exists(std::filesystem::symlink_status(path, ec));
+  }
+
+  std::vector<WatchId> failed;
+  std::filesystem::path relative;
+
+  for(const auto &watch: m_watches)
+  {
+    if(!watch.second.fanotify) continue;
+
+    // the watched directory or one of its parents was moved or removed, the watch path is no longer valid.
+    if(disappeared && (path == watch.second.canonical || relativePath(path, watch.second.canonical, relative)))
+    {
+      failed.push_back(watch.first);
+      continue;
+    }
+
+    // the mark of the filesystem has the changes needed by all its watches.
+    if((mask & watch.second.fanMask) == 0) continue;
+
+    // changes of the watched directories themselves are not reported, same as ReadDirectoryChangesW.
+    if(!relativePath(watch.second.canonical, path, relative)) continue;
+
+    const auto name = relative.wstring();
+    if(replaced)                         listener.onChange(watch.first, name, Events::REMOVED);
+    if(appeared)                         listener.onChange(watch.first, name, Events::ADDED);
+    if(mask & (FAN_MODIFY | FAN_ATTRIB)) listener.onChange(watch.first, name, Events::MODIFIED);
+    if(disappeared && !replaced)         listener.onChange(watch.first, name, Events::REMOVED);
+  }
+
+  for(const auto id: failed) failWatch(id, listener);
+}
+
+//-----------------------------------------------------------------------------
+void InotifyWatchBackend::processFanotifyMove(const std::filesystem::path &from, const std::filesystem::path &to, Listener &listener)
+{
+  std::vector<WatchId> failed;
+  std::filesystem::path oldPath, newPath;
+
+  for(const auto &watch: m_watches)
+  {
+    if(!watch.second.fanotify) continue;
+
+    // the watched directory or one of its parents was moved, the watch path is no longer valid.
+    if(!from.empty() && (from == watch.second.canonical || relativePath(from, watch.second.canonical, oldPath)))
+    {
+      failed.push_back(watch.first);
+      continue;
+    }
+
+    // the mark of the filesystem always has the moves, needed to follow the watched directories.
+    if((watch.second.fanMask & (FAN_MOVED_FROM | FAN_MOVED_TO)) == 0) continue;
+
+    const bool hasFrom = !from.empty() && relativePath(watch.second.canonical, from, oldPath);
+    const bool hasTo = !to.empty() && relativePath(watch.second.canonical, to, newPath);
+
+    if(hasFrom && hasTo)
+    {
+      listener.onChange(watch.first, oldPath.wstring(), Events::RENAMED_OLD);
+      listener.onChange(watch.first, newPath.wstring(), Events::RENAMED_NEW);
+    }
+    else if(hasFrom)
+    {
+      listener.onChange(watch.first, oldPath.wstring(), Events::REMOVED);
+    }
+    else if(hasTo)
+    {
+      listener.onChange(watch.first, newPath.wstring(), Events::ADDED);
+    }
+  }
+
+  for(const auto id: failed) failWatch(id, listener);
+}
+
+//-----------------------------------------------------------------------------
+bool InotifyWatchBackend::addFilesystemMark(Watch &watch, QString &error)
+{
+  auto systemError = [&error, &watch](const QString &message)
+  {
+    const auto errorString = QString::fromLocal8Bit(strerror(errno));
+    error = message.arg(QString::fromStdWString(watch.directory.wstring())).arg(errorString);
+    return false;
+  };
+
+  // fanotify reports the resolved paths.
+  std::error_code ec;
+  watch.canonical = std::filesystem::canonical(watch.directory, ec);
+  if(ec)
+  {
+    error = QObject::tr("Unable to watch directory '%1'. Error: %2").arg(QString::fromStdWString(watch.directory.wstring()))
+                                                                     .arg(QString::fromStdString(ec.message()));
+    return false;
+  }
+
+  struct statfs info;
+  if(statfs(watch.canonical.c_str(), &info) == -1) return systemError(QObject::tr("Unable to watch directory '%1'. Error: %2"));
+
+  uint64_t fsid = 0;
+  memcpy(&fsid, &info.f_fsid, sizeof(fsid));
+
+  auto it = m_filesystems.find(fsid);
+  if(it == m_filesystems.end())
+  {
+    const auto fd = ::open(watch.canonical.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if(fd == -1) return systemError(QObject::tr("Unable to watch directory '%1'. Error: %2"));
+
+    // since Linux 5.17 a rename is a single event with both names, older kernels report each side apart.
+    auto mask = ((fanotifyProperties | watch.fanMask) & ~(FAN_MOVED_FROM | FAN_MOVED_TO)) | renameMask;
+    if(renameMask == 0 || fanotify_mark(m_fanotifyFd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, mask, fd, nullptr) == -1)
+    {
+      mask = fanotifyProperties | watch.fanMask;
+      if(fanotify_mark(m_fanotifyFd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, mask, fd, nullptr) == -1)
+      {
+        systemError(QObject::tr("Unable to mark the filesystem of directory '%1'. Error: %2"));
+        close(fd);
+        return false;
+      }
+    }
+
+    it = m_filesystems.emplace(fsid, Filesystem{fd, mask, 0}).first;
+  }
+
+  ++it->second.users;
+  watch.fsid = fsid;
+  watch.fanotify = true;
+
+  // an existing mark may need the changes of the new watch.
+  if(!updateFilesystemMark(fsid, error))
+  {
+    --it->second.users;
+    watch.fanotify = false;
+    return false;
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void InotifyWatchBackend::removeFilesystemMark(const Watch &watch)
+{
+  auto it = m_filesystems.find(watch.fsid);
+  if(it == m_filesystems.end()) return;
+
+  if(--it->second.users > 0)
+  {
+    QString ignored;
+    updateFilesystemMark(watch.fsid, ignored);
+    return;
+  }
+
+  fanotify_mark(m_fanotifyFd, FAN_MARK_REMOVE | FAN_MARK_FILESYSTEM, it->second.mask, it->second.fd, nullptr);
+  close(it->second.fd);
+  m_filesystems.erase(it);
+
+  m_handles.clear();
+}
+
+//-----------------------------------------------------------------------------
+bool InotifyWatchBackend::updateFilesystemMark(const uint64_t fsid, QString &error)
+{
+  auto it = m_filesystems.find(fsid);
+  if(it == m_filesystems.end()) return true;
+
+  auto &filesystem = it->second;
+
+  uint64_t mask = fanotifyProperties;
+  for(const auto &watch: m_watches)
+  {
+    if(watch.second.fanotify && watch.second.fsid == fsid) mask |= watch.second.fanMask;
+  }
+
+  // the kind of rename events was chosen when the filesystem was marked.
+  if(filesystem.mask & renameMask) mask = (mask & ~(FAN_MOVED_FROM | FAN_MOVED_TO)) | renameMask;
+
+  const auto added = mask & ~filesystem.mask;
+  const auto removed = filesystem.mask & ~mask;
+
+  if(added != 0 && fanotify_mark(m_fanotifyFd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, added | FAN_ONDIR, filesystem.fd, nullptr) == -1)
+  {
+    error = QObject::tr("Unable to mark the filesystem. Error: %1").arg(QString::fromLocal8Bit(strerror(errno)));
+    return false;
+  }
+
+  if(removed != 0) fanotify_mark(m_fanotifyFd, FAN_MARK_REMOVE | FAN_MARK_FILESYSTEM, removed, filesystem.fd, nullptr);
+
+  filesystem.mask = mask;
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool InotifyWatchBackend::resolvePath(struct fanotify_event_info_fid *info, std::filesystem::path &path)
+{
+  auto handle = reinterpret_cast<struct file_handle *>(info->handle);
+  const auto name = reinterpret_cast<const char *>(handle->f_handle + handle->handle_bytes);
+
+  uint64_t fsid = 0;
+  memcpy(&fsid, &info->fsid, sizeof(fsid));
+
+  m_handleKey.assign(reinterpret_cast<const char *>(&fsid), sizeof(fsid));
+  m_handleKey.append(reinterpret_cast<const char *>(&handle->handle_type), sizeof(handle->handle_type));
+  m_handleKey.append(reinterpret_cast<const char *>(handle->f_handle), handle->handle_bytes);
+
+  auto cached = m_handles.find(m_handleKey);
+  if(cached == m_handles.end())
+  {
+    // changes queued before the mark of their filesystem was removed.
+    const auto filesystem = m_filesystems.find(fsid);
+    if(filesystem == m_filesystems.end()) return false;
+
+    const auto fd = open_by_handle_at(filesystem->second.fd, handle, O_PATH | O_CLOEXEC);
+    if(fd == -1) return false;
+
+    char buffer[PATH_MAX];
+    const auto link = "/proc/self/fd/" + std::to_string(fd);
+    const auto length = readlink(link.c_str(), buffer, sizeof(buffer));
+    close(fd);
+
+    if(length <= 0) return false;
+
+    if(m_handles.size() >= MAXIMUM_HANDLES) m_handles.clear();
+    cached = m_handles.emplace(m_handleKey, std::string(buffer, length)).first;
+  }
+
+  // changes of a directory itself are reported on it with the "." name.
+  path = cached->second;
+  if(strcmp(name, ".") != 0) path /= name;
+
+  return true;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+void InotifyWatchBackend::failWatch(const WatchId id, Listener &listener)
+{
+  const auto it = m_watches.find(id);
+  if(it == m_watches.end()) return;
+
+  const auto directory = QString::fromStdWString(it->second.directory.wstring());
+  removeWatch(id);
+
+  listener.onError(id, QObject::tr("Watched directory '%1' no longer exists.").arg(directory));
+}
+
+//-----------------------------------------------------------------------------
+bool InotifyWatchBackend::addDescriptors(const WatchId id, const std::filesystem::path &relative, QString &error,
+                                         std::vector<std::filesystem::path> *entries)
+{
+  const auto &watch = m_watches.at(id);
+  const auto path = relative.empty() ? watch.directory : watch.directory / relative;
+
+  // the descriptor of a directory can be shared, its events are added to the ones it already has.
+  const auto mask = watchFlags | IN_MASK_ADD | descriptorMask(watch);
+
+  auto addDescriptor = [this, id, mask, &error](const std::filesystem::path &directory, const std::filesystem::path &name)
+  {
+    const auto wd = inotify_add_watch(m_fd, directory.c_str(), mask);
+    if(wd == -1)
+    {
+      const auto errorString = QString::fromLocal8Bit(strerror(errno));
+      error = QObject::tr("Unable to watch directory '%1'. Error: %2").arg(QString::fromStdWString(directory.wstring())).arg(errorString);
+      return false;
+    }
+
+    auto &subscribers = m_descriptors[wd];
+    auto sameId = [id](const Subscriber &s) { return s.id == id; };
+    auto it = std::find_if(subscribers.begin(), subscribers.end(), sameId);
+    if(it == subscribers.end())
+    {
+      subscribers.push_back(Subscriber{id, name, prefix(name)});
+    }
+    else
+    {
+      it->relative = name;
+      it->prefix = prefix(name);
+    }
+
+    return true;
+  };
+
+  if(!addDescriptor(path, relative)) return false;
+
+  if(watch.recursive)
+  {
+    std::error_code ec;
+    const auto options = std::filesystem::directory_options::skip_permission_denied;
+    for(auto it = std::filesystem::recursive_directory_iterator(path, options, ec);
+        !ec && it != std::filesystem::recursive_directory_iterator();
+        it.increment(ec))
+    {
+      // listed after the descriptor of their directory, the later changes have events.
+      if(entries) entries->push_back(it->path().lexically_relative(watch.directory));
+
+      if(it->is_directory(ec) && !it->is_symlink(ec))
+      {
+        if(!addDescriptor(it->path(), it->path().lexically_relative(watch.directory))) return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void InotifyWatchBackend::removeDescriptors(const WatchId id, const std::filesystem::path &relative)
+{
+  for(auto it = m_descriptors.begin(); it != m_descriptors.end();)
+  {
+    auto &subscribers = it->second;
+    auto isRemoved = [id, &relative](const Subscriber &s) { return s.id == id && isInside(s.relative, relative); };
+    const auto removed = std::remove_if(subscribers.begin(), subscribers.end(), isRemoved);
+    const bool changed = removed != subscribers.end();
+    subscribers.erase(removed, subscribers.end());
+
+    if(subscribers.empty())
+    {
+      inotify_rm_watch(m_fd, it->first);
+      it = m_descriptors.erase(it);
+    }
+    else
+    {
+      // the remaining subscribers may need less changes.
+      QString ignored;
+      if(changed) updateDescriptor(it->first, ignored);
+      ++it;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool InotifyWatchBackend::updateDescriptor(const int wd, QString &error)
+{
+  const auto it = m_descriptors.find(wd);
+  if(it == m_descriptors.end() || it->second.empty()) return true;
+
+  uint32_t mask = 0;
+  for(const auto &subscriber: it->second) mask |= descriptorMask(m_watches.at(subscriber.id));
+
+  // adding the directory again replaces the events of its descriptor.
+  const auto &subscriber = it->second.front();
+  const auto &directory = m_watches.at(subscriber.id).directory;
+  const auto path = subscriber.relative.empty() ? directory : directory / subscriber.relative;
+
+  const auto result = inotify_add_watch(m_fd, path.c_str(), watchFlags | mask);
+  if(result == -1)
+  {
+    const auto errorString = QString::fromLocal8Bit(strerror(errno));
+    error = QObject::tr("Unable to watch directory '%1'. Error: %2").arg(QString::fromStdWString(path.wstring())).arg(errorString);
+    return false;
+  }
+
+  // the directory was replaced by another one whose changes haven't been read yet.
+  if(result != wd && m_descriptors.find(result) == m_descriptors.end()) inotify_rm_watch(m_fd, result);
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+uint32_t InotifyWatchBackend::descriptorMask(const Watch &watch)
+{
+  auto mask = watch.mask;
+
+  // the descriptors of the subtree follow the directories created, moved and removed.
+  if(watch.recursive) mask |= IN_CREATE | IN_MOVED_FROM | IN_MOVED_TO;
+
+  // a descriptor needs some event, the removal of the directory is also reported with IN_IGNORED.
+  if(mask == 0) mask = IN_DELETE_SELF;
+
+  return mask;
+}
+
+//-----------------------------------------------------------------------------
+uint32_t InotifyWatchBackend::inotifyMask(const Events events, const Properties properties)
+{
+  uint32_t mask = 0;
+
+  // File/directory created in watched directory.
+  if((events & Events::ADDED) != Events::NONE) mask |= IN_CREATE;
+
+  // File/directory deleted from watched directory.
+  if((events & Events::REMOVED) != Events::NONE) mask |= IN_DELETE;
+
+  // Both sides of a move are needed to tell a rename from an object moved into or out of the directory.
+  if((events & (Events::ADDED | Events::REMOVED | Events::RENAMED_OLD | Events::RENAMED_NEW)) != Events::NONE) mask |= IN_MOVED_FROM | IN_MOVED_TO;
+
+  if((events & Events::MODIFIED) != Events::NONE)
+  {
+    // File was written or truncated.
+    if((properties & (Properties::SIZE | Properties::WRITE_TIME)) != Properties::NONE) mask |= IN_MODIFY;
+
+    // Metadata changed: permissions, timestamps, extended attributes, link count, user/group ID.
+    if((properties & (Properties::WRITE_TIME | Properties::ATTRIBUTES | Properties::SECURITY | Properties::OTHER)) != Properties::NONE) mask |= IN_ATTRIB;
+  }
+
+  return mask;
+}
+
+#ifdef WITH_FANOTIFY
+//-----------------------------------------------------------------------------
+uint64_t InotifyWatchBackend::fanotifyMask(const Events events, const Properties properties)
+{
+  uint64_t mask = 0;
+
+  if((events & Events::ADDED) != Events::NONE)   mask |= FAN_CREATE;
+  if((events & Events::REMOVED) != Events::NONE) mask |= FAN_DELETE;
+
+  if((events & (Events::ADDED | Events::REMOVED | Events::RENAMED_OLD | Events::RENAMED_NEW)) != Events::NONE) mask |= FAN_MOVED_FROM | FAN_MOVED_TO;
+
+  if((events & Events::MODIFIED) != Events::NONE)
+  {
+    if((properties & (Properties::SIZE | Properties::WRITE_TIME)) != Properties::NONE) mask |= FAN_MODIFY;
+    if((properties & (Properties::WRITE_TIME | Properties::ATTRIBUTES | Properties::SECURITY | Properties::OTHER)) != Properties::NONE) mask |= FAN_ATTRIB;
+  }
+
+  return mask;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+void InotifyWatchBackend::renameDescriptors(const WatchId id, const std::filesystem::path &from, const std::filesystem::path &to)
+{
+  for(auto &descriptor: m_descriptors)
+  {
+    for(auto &subscriber: descriptor.second)
+    {
+      if(subscriber.id == id && isInside(subscriber.relative, from))
+      {
+        subscriber.relative = to / subscriber.relative.lexically_relative(from);
+        if(subscriber.relative.filename() == ".") subscriber.relative = subscriber.relative.parent_path();
+        subscriber.prefix = prefix(subscriber.relative);
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+std::wstring InotifyWatchBackend::prefix(const std::filesystem::path &relative)
+{
+  if(relative.empty()) return std::wstring();
+
+  return relative.wstring() + static_cast<wchar_t>(std::filesystem::path::preferred_separator);
+}
+
+//-----------------------------------------------------------------------------
+bool InotifyWatchBackend::isInside(const std::filesystem::path &path, const std::filesystem::path &base)
+{
+  auto pathIt = path.begin();
+  for(auto baseIt = base.begin(); baseIt != base.end(); ++baseIt, ++pathIt)
+  {
+    if(pathIt == path.end() || *pathIt != *baseIt) return false;
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool InotifyWatchBackend::relativePath(const std::filesystem::path &base, const std::filesystem::path &path, std::filesystem::path &relative)
+{
+  const auto &baseString = base.native();
+  const auto &pathString = path.native();
+
+  // compared as strings, this is done for every change of the marked filesystems.
+  const auto size = baseString.size();
+  const bool endsWithSeparator = size > 0 && baseString.back() == '/';
+  if(pathString.size() <= size || pathString.compare(0, size, baseString) != 0) return false;
+  if(!endsWithSeparator && pathString[size] != '/') return false;
+
+  relative = pathString.substr(endsWithSeparator ? size : size + 1);
+  return true;
+}
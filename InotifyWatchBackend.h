@@ -0,0 +1,352 @@
+/*
+ File: InotifyWatchBackend.h
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INOTIFYWATCHBACKEND_H_
+#define INOTIFYWATCHBACKEND_H_
+
+// Project
+#include <WatchBackend.h>
+
+// C++
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct inotify_event;
+#ifdef WITH_FANOTIFY
+struct fanotify_event_info_fid;
+#endif
+
+/** \class InotifyWatchBackend
+ * \brief Watches directories using the Linux inotify API. All the watches share a single
+ * inotify instance that is waited for with epoll. Recursive watches add a watch for every
+ * directory of the subtree, and keep them updated when directories are created, moved or
+ * removed. If built with WITH_FANOTIFY and the process has CAP_SYS_ADMIN, recursive watches
+ * instead mark their whole filesystem once with fanotify, reporting the directory and name of
+ * every change, and the changes outside the watched subtrees are filtered out here. That costs
+ * no kernel memory per directory and no walk of the tree.
+ *
+ */
+class InotifyWatchBackend
+: public WatchBackend
+{
+  public:
+    /** \brief InotifyWatchBackend class constructor.
+     *
+     */
+    explicit InotifyWatchBackend();
+
+    /** \brief InotifyWatchBackend class virtual destructor.
+     *
+     */
+    virtual ~InotifyWatchBackend();
+
+    virtual bool open(QString &error) override;
+
+    virtual bool addWatch(const WatchId id, const std::filesystem::path &directory, bool recursive,
+                          const Events events, const Properties properties, QString &error) override;
+
+    virtual bool updateWatch(const WatchId id, const Events events, const Properties properties, QString &error) override;
+
+    virtual void removeWatch(const WatchId id) override;
+
+#ifdef WITH_FANOTIFY
+    virtual bool isFilesystemWatch(const WatchId id) const override;
+#endif
+
+    virtual bool wait(Listener &listener, QString &error, const int timeout = -1) override;
+
+    virtual void wakeUp() override;
+
+  private:
+    /** \struct Watch
+     * \brief Data of a watched directory.
+     *
+     */
+    struct Watch
+    {
+      std::filesystem::path directory; /** path of the watched directory.                               */
+      bool                  recursive; /** true to monitor the directory subtree.                       */
+      bool                  fanotify;  /** true if watched with the fanotify mark of its filesystem.    */
+      uint32_t              mask;      /** inotify events to report.                                    */
+#ifdef WITH_FANOTIFY
+      std::filesystem::path canonical; /** canonical path of the directory, to filter fanotify changes. */
+      uint64_t              fsid;      /** identifier of the filesystem of the directory, if fanotify.  */
+      uint64_t              fanMask;   /** fanotify events to report.                                   */
+#endif
+    };
+
+#ifdef WITH_FANOTIFY
+    /** \struct Filesystem
+     * \brief A filesystem marked with fanotify.
+     *
+     */
+    struct Filesystem
+    {
+      int           fd;    /** descriptor of a directory in the filesystem, to open the reported handles. */
+      uint64_t      mask;  /** events of the mark.                                                        */
+      unsigned long users; /** number of watches in the filesystem.                                       */
+    };
+#endif
+
+    /** \struct Subscriber
+     * \brief A watch interested in the changes of an inotify watch descriptor. Several watches can
+     * share the descriptor of the same directory.
+     *
+     */
+    struct Subscriber
+    {
+      WatchId               id;       /** watch identifier.                                       */
+      std::filesystem::path relative; /** path of the directory relative to the watched directory. */
+      std::wstring          prefix;   /** relative path as the start of the names of its entries. */
+    };
+
+    using Subscribers = std::vector<Subscriber>;
+
+    /** \brief Adds a descriptor for the given directory and, if recursive, for all the directories of its
+     * subtree. Returns true on success and false otherwise.
+     * \param[in] id Watch identifier.
+     * \param[in] relative Path of the directory relative to the watched one.
+     * \param[out] error Error message in case of failure.
+     * \param[out] entries If not null, receives the paths relative to the watched directory of the entries
+     * found in the subtree.
+     *
+     */
+    bool addDescriptors(const WatchId id, const std::filesystem::path &relative, QString &error,
+                        std::vector<std::filesystem::path> *entries = nullptr);
+
+    /** \brief Sets the events of the given descriptor to the ones needed by its subscribers. Returns
+     * true on success and false otherwise.
+     * \param[in] wd inotify watch descriptor.
+     * \param[out] error Error message in case of failure.
+     *
+     */
+    bool updateDescriptor(const int wd, QString &error);
+
+    /** \brief Returns the inotify events the descriptors of the watch need, the ones reported and, if
+     * recursive, the ones that keep the descriptors of the subtree.
+     * \param[in] watch Watch data.
+     *
+     */
+    static uint32_t descriptorMask(const Watch &watch);
+
+    /** \brief Unsubscribes the watch from the descriptors of the given directory and its subtree. Descriptors
+     * without subscribers are removed.
+     * \param[in] id Watch identifier.
+     * \param[in] relative Path of the directory relative to the watched one, empty for the whole watch.
+     *
+     */
+    void removeDescriptors(const WatchId id, const std::filesystem::path &relative);
+
+    /** \brief Updates the paths of the descriptors of a moved directory and its subtree.
+     * \param[in] id Watch identifier.
+     * \param[in] from Old path of the directory relative to the watched one.
+     * \param[in] to New path of the directory relative to the watched one.
+     *
+     */
+    void renameDescriptors(const WatchId id, const std::filesystem::path &from, const std::filesystem::path &to);
+
+    /** \brief Refreshes the descriptors of a recursive watch after events were lost, adding the
+     * directories created and removing the ones deleted since the last change read.
+     * \param[in] id Watch identifier.
+     *
+     */
+    void resyncDescriptors(const WatchId id);
+
+    /** \brief Notifies every watch of the overflowed queue that changes were lost and resynchronizes
+     * the recursive inotify ones.
+     * \param[in] listener Listener of the changes.
+     * \param[in] fanotify True if the fanotify queue overflowed, false if the inotify one.
+     *
+     */
+    void processOverflow(Listener &listener, bool fanotify);
+
+    /** \brief Reads the inotify queue and notifies the listener of the changes. Returns true on success
+     * and false otherwise.
+     * \param[in] listener Listener of the changes.
+     * \param[out] error Error message in case of failure.
+     *
+     */
+    bool readInotify(Listener &listener, QString &error);
+
+#ifdef WITH_FANOTIFY
+    /** \brief Reads the fanotify queue and notifies the listener of the changes inside the watched
+     * subtrees. Returns true on success and false otherwise.
+     * \param[in] listener Listener of the changes.
+     * \param[out] error Error message in case of failure.
+     *
+     */
+    bool readFanotify(Listener &listener, QString &error);
+#endif
+
+    /** \brief Grows the notifications buffer if the last read filled most of it.
+     * \param[in] length Length of the last read.
+     *
+     */
+    void adjustBuffer(const size_t length);
+
+#ifdef WITH_FANOTIFY
+    /** \brief Marks the filesystem of the directory of the watch with fanotify, if not already marked.
+     * Returns true on success and false otherwise.
+     * \param[in] watch Watch data.
+     * \param[out] error Error message in case of failure.
+     *
+     */
+    bool addFilesystemMark(Watch &watch, QString &error);
+
+    /** \brief Removes the fanotify mark of the filesystem of the watch if no other watch uses it.
+     * \param[in] watch Watch data.
+     *
+     */
+    void removeFilesystemMark(const Watch &watch);
+
+    /** \brief Sets the events of the fanotify mark of the filesystem to the ones needed by its watches.
+     * Returns true on success and false otherwise.
+     * \param[in] fsid Identifier of the filesystem.
+     * \param[out] error Error message in case of failure.
+     *
+     */
+    bool updateFilesystemMark(const uint64_t fsid, QString &error);
+
+    /** \brief Gets the path of an object reported by fanotify as a directory file handle and a name. The
+     * path is the one of the directory when the change is read. Returns true on success and false if
+     * the directory no longer exists.
+     * \param[in] info fanotify directory and name record.
+     * \param[out] path Path of the object.
+     *
+     */
+    bool resolvePath(struct fanotify_event_info_fid *info, std::filesystem::path &path);
+
+    /** \brief Notifies the fanotify watches of a change that is not a rename. Moves are reported as
+     * removals and additions if the kernel can't report renames.
+     * \param[in] path Path of the changed object.
+     * \param[in] mask fanotify event mask.
+     * \param[in] listener Listener of the changes.
+     *
+     */
+    void processFanotifyEvent(const std::filesystem::path &path, const uint64_t mask, Listener &listener);
+
+    /** \brief Notifies the fanotify watches of a move. The watches that contain both paths get a rename,
+     * the ones that contain only one get a removal or an addition.
+     * \param[in] from Old path of the object, empty if unknown.
+     * \param[in] to New path of the object, empty if unknown.
+     * \param[in] listener Listener of the changes.
+     *
+     */
+    void processFanotifyMove(const std::filesystem::path &from, const std::filesystem::path &to, Listener &listener);
+#endif
+
+    /** \brief Notifies the listener of a change that is not a move.
+     * \param[in] event inotify event.
+     * \param[in] listener Listener of the changes.
+     *
+     */
+    void processEvent(const struct inotify_event *event, Listener &listener);
+
+    /** \brief Notifies the listener of a move. The watches that see both sides get a rename, the ones
+     * that see only one side get a removal or an addition.
+     * \param[in] from IN_MOVED_FROM event or nullptr if the file was moved from outside the watches.
+     * \param[in] to IN_MOVED_TO event or nullptr if the file was moved outside the watches.
+     * \param[in] listener Listener of the changes.
+     *
+     */
+    void processMove(const struct inotify_event *from, const struct inotify_event *to, Listener &listener);
+
+    /** \brief Removes the watch and notifies the listener that its directory no longer exists.
+     * \param[in] id Watch identifier.
+     * \param[in] listener Listener of the changes.
+     *
+     */
+    void failWatch(const WatchId id, Listener &listener);
+
+    /** \brief Returns true if the 'path' is 'base' or is inside 'base'.
+     * \param[in] path Relative path.
+     * \param[in] base Relative path of a directory.
+     *
+     */
+    static bool isInside(const std::filesystem::path &path, const std::filesystem::path &base);
+
+    /** \brief Returns true if the 'path' is inside the 'base' directory and gets its relative path.
+     * \param[in] base Canonical path of a directory.
+     * \param[in] path Canonical path.
+     * \param[out] relative Path relative to the base directory.
+     *
+     */
+    static bool relativePath(const std::filesystem::path &base, const std::filesystem::path &path, std::filesystem::path &relative);
+
+    /** \brief Returns the relative path of a directory followed by a separator, empty for the watched
+     * one, converted once instead of for every change inside it.
+     * \param[in] relative Path of the directory relative to the watched directory.
+     *
+     */
+    static std::wstring prefix(const std::filesystem::path &relative);
+
+    /** \brief Returns the inotify events needed to report the given events, equivalent to the changes
+     * watched by ReadDirectoryChangesW.
+     * \param[in] events Events to report.
+     * \param[in] properties Properties whose modifications are reported.
+     *
+     */
+    static uint32_t inotifyMask(const Events events, const Properties properties);
+
+#ifdef WITH_FANOTIFY
+    /** \brief Returns the fanotify events needed to report the given events, the same ones watched with
+     * inotify.
+     * \param[in] events Events to report.
+     * \param[in] properties Properties whose modifications are reported.
+     *
+     */
+    static uint64_t fanotifyMask(const Events events, const Properties properties);
+#endif
+
+    /** Flags of every inotify descriptor.
+     *
+     *  From https://man7.org/linux/man-pages/man7/inotify.7.html                                                      */
+    static const uint32_t watchFlags;
+
+#ifdef WITH_FANOTIFY
+    /** Changes of every fanotify filesystem mark, the paths of the watched directories and the cached
+     *  directory handles depend on them.
+     *
+     *  From https://man7.org/linux/man-pages/man2/fanotify_mark.2.html                                                */
+    static const uint64_t fanotifyProperties;
+    static const uint64_t renameMask;      /** FAN_RENAME if the headers define it, 0 otherwise. */
+    static const size_t   MAXIMUM_HANDLES; /** maximum number of cached directory paths.        */
+#endif
+
+    static const size_t INITIAL_BUFFER_SIZE; /** size of the initial notifications buffer. */
+    static const size_t MAXIMUM_BUFFER_SIZE; /** maximum size of the notifications buffer. */
+
+    int                                                    m_epollFd;     /** epoll instance descriptor.                */
+    int                                                    m_fd;          /** inotify instance descriptor.              */
+    int                                                    m_wakeFd;      /** eventfd descriptor to wake up wait().     */
+    std::unordered_map<WatchId, Watch>                     m_watches;     /** watches data.                             */
+    std::unordered_map<int, Subscribers>                   m_descriptors; /** inotify watch descriptor to subscribers.  */
+    std::vector<char>                                      m_buffer;      /** notifications buffer.                     */
+    std::wstring                                           m_name;        /** buffer of the name of the last change.    */
+#ifdef WITH_FANOTIFY
+    int                                                    m_fanotifyFd;  /** fanotify instance descriptor, -1 if none. */
+    std::unordered_map<uint64_t, Filesystem>               m_filesystems; /** marked filesystems by identifier.         */
+    std::unordered_map<std::string, std::filesystem::path> m_handles;     /** directory file handle to its path.        */
+    std::string                                            m_handleKey;   /** buffer of the last looked up handle.      */
+#endif
+};
+
+#endif // INOTIFYWATCHBACKEND_H_
@@ -0,0 +1,177 @@
+/*
+ File: JournalReader.cpp
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <JournalReader.h>
+
+// Qt
+#include <QFileInfo>
+#include <QObject>
+
+// C++
+#include <cstring>
+
+//-----------------------------------------------------------------------------
+JournalReader::JournalReader(const QString &path)
+: m_next{0}
+, m_segment{nullptr}
+, m_size{0}
+, m_offset{0}
+{
+  if(QFileInfo{path}.isDir()) m_segments = EventJournal::segments(path);
+  else                        m_segments << path;
+}
+
+//-----------------------------------------------------------------------------
+JournalReader::~JournalReader()
+{
+  closeSegment();
+}
+
+//-----------------------------------------------------------------------------
+bool JournalReader::next(Event &event)
+{
+  using RecordHeader = EventJournal::RecordHeader;
+  using RecordType = EventJournal::RecordType;
+
+  while(true)
+  {
+    if(!m_segment && !openSegment()) return false;
+
+    // a segment still being written or cut by a crash ends in zeros.
+    if(m_offset + static_cast<long long>(sizeof(RecordHeader)) > m_size)
+    {
+      closeSegment();
+      continue;
+    }
+
+    RecordHeader header;
+    std::memcpy(&header, m_segment + m_offset, sizeof(header));
+    m_offset += sizeof(header);
+
+    switch(static_cast<RecordType>(header.type))
+    {
+      case RecordType::END:
+        closeSegment();
+        break;
+      case RecordType::PATH:
+        {
+          // the journal defines the identifiers in order, any other one is a corrupt record.
+          const auto padded = (static_cast<long long>(header.count) + 7) & ~7ll;
+          if(header.path != m_paths.size() + 1 || m_offset + padded > m_size)
+          {
+            fail(QObject::tr("invalid path record at offset %1").arg(m_offset - static_cast<long long>(sizeof(header))));
+            break;
+          }
+
+          const auto path = QString::fromUtf8(reinterpret_cast<const char *>(m_segment + m_offset), header.count);
+          m_paths.push_back(path.toStdWString());
+
+          m_offset += padded;
+        }
+        break;
+      case RecordType::EVENT:
+        {
+          auto pathOf = [this](const std::uint32_t id)
+          {
+            if(id == EventJournal::NO_PATH || id > m_paths.size()) return std::wstring_view();
+            return std::wstring_view{m_paths[id - 1]};
+          };
+
+          event.object = pathOf(header.path);
+          event.oldName = pathOf(header.oldPath);
+          event.event = static_cast<Events>(header.event);
+          event.count = header.count;
+          event.properties = static_cast<Properties>(header.properties);
+          event.time = header.time;
+          event.id = header.object;
+
+          if(event.object.empty())
+          {
+            fail(QObject::tr("undefined path %1 at offset %2").arg(header.path).arg(m_offset - static_cast<long long>(sizeof(header))));
+            break;
+          }
+        }
+        return true;
+      default:
+        fail(QObject::tr("unknown record type %1 at offset %2").arg(header.type).arg(m_offset - static_cast<long long>(sizeof(header))));
+        break;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool JournalReader::openSegment()
+{
+  using SegmentHeader = EventJournal::SegmentHeader;
+
+  while(m_next < m_segments.size())
+  {
+    m_file.setFileName(m_segments.at(m_next++));
+    if(!m_file.open(QIODevice::ReadOnly))
+    {
+      m_error += QObject::tr("Unable to open the segment '%1': %2\n").arg(m_file.fileName()).arg(m_file.errorString());
+      continue;
+    }
+
+    m_size = m_file.size();
+    m_segment = m_size > 0 ? m_file.map(0, m_size) : nullptr;
+    if(!m_segment)
+    {
+      m_error += QObject::tr("Unable to map the segment '%1': %2\n").arg(m_file.fileName()).arg(m_file.errorString());
+      m_file.close();
+      continue;
+    }
+
+    SegmentHeader header;
+    std::memset(&header, 0, sizeof(header));
+    if(m_size >= static_cast<long long>(sizeof(header))) std::memcpy(&header, m_segment, sizeof(header));
+
+    if(std::memcmp(header.magic, EventJournal::MAGIC, sizeof(header.magic)) != 0 || header.version != EventJournal::VERSION ||
+       header.recordSize != sizeof(EventJournal::RecordHeader) || header.headerSize < sizeof(SegmentHeader))
+    {
+      fail(QObject::tr("not a journal segment of version %1").arg(EventJournal::VERSION));
+      continue;
+    }
+
+    m_offset = header.headerSize;
+    m_paths.clear();
+
+    return true;
+  }
+
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+void JournalReader::closeSegment()
+{
+  if(!m_segment) return;
+
+  m_file.unmap(const_cast<uchar *>(m_segment));
+  m_segment = nullptr;
+  m_file.close();
+}
+
+//-----------------------------------------------------------------------------
+void JournalReader::fail(const QString &message)
+{
+  m_error += QObject::tr("Error reading the segment '%1': %2\n").arg(m_file.fileName()).arg(message);
+  closeSegment();
+}
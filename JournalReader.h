@@ -0,0 +1,96 @@
+/*
+ File: JournalReader.h
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JOURNALREADER_H_
+#define JOURNALREADER_H_
+
+// Project
+#include <EventBatch.h>
+#include <EventJournal.h>
+
+// Qt
+#include <QFile>
+#include <QString>
+#include <QStringList>
+
+// C++
+#include <string>
+#include <vector>
+
+/** \class JournalReader
+ * \brief Reads the changes recorded by an EventJournal in order. The segments are mapped in memory
+ * one at a time and the paths of a segment are decoded once. A segment that can't be read is
+ * skipped and its error kept.
+ *
+ */
+class JournalReader
+{
+  public:
+    /** \brief JournalReader class constructor.
+     * \param[in] path Path of a segment file or of the directory of the segments of a journal.
+     *
+     */
+    explicit JournalReader(const QString &path);
+
+    /** \brief JournalReader class destructor.
+     *
+     */
+    ~JournalReader();
+
+    /** \brief Reads the next change. Returns true on success and false if there are no more. The
+     * paths of the change are valid until the next call.
+     * \param[out] event Change, with the identifier of its object and its notification time.
+     *
+     */
+    bool next(Event &event);
+
+    /** \brief Returns the errors of the segments that couldn't be read, empty if none.
+     *
+     */
+    const QString &errorString() const
+    { return m_error; }
+
+  private:
+    /** \brief Maps the next segment. Returns true on success and false if there are no more.
+     *
+     */
+    bool openSegment();
+
+    /** \brief Unmaps the current segment.
+     *
+     */
+    void closeSegment();
+
+    /** \brief Adds the error of the current segment and unmaps it.
+     * \param[in] message Error message.
+     *
+     */
+    void fail(const QString &message);
+
+    QStringList               m_segments; /** paths of the segments to read.                */
+    int                       m_next;     /** index of the next segment to read.            */
+    QFile                     m_file;     /** current segment file.                         */
+    const uchar              *m_segment;  /** memory of the current segment.                */
+    long long                 m_size;     /** size of the current segment.                  */
+    long long                 m_offset;   /** offset of the next record.                    */
+    std::vector<std::wstring> m_paths;    /** paths of the segment by identifier minus one. */
+    QString                   m_error;    /** errors of the unreadable segments.            */
+};
+
+#endif // JOURNALREADER_H_
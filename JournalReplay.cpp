@@ -0,0 +1,86 @@
+/*
+ File: JournalReplay.cpp
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <JournalReplay.h>
+#include <JournalReader.h>
+
+// C++
+#include <algorithm>
+#include <chrono>
+
+const long long MAXIMUM_WAIT = 50000; /** microseconds of the longest wait, to notice the abort. */
+
+//-----------------------------------------------------------------------------
+JournalReplay::JournalReplay(const QString &journal, EventRing &queue, const double speed, QObject *p)
+: QThread{p}
+, m_journal{journal}
+, m_queue(queue)
+, m_speed{std::max(0.0, speed)}
+, m_replayed{0}
+, m_aborted{false}
+{
+}
+
+//-----------------------------------------------------------------------------
+JournalReplay::~JournalReplay()
+{
+  abort();
+  wait();
+}
+
+//-----------------------------------------------------------------------------
+void JournalReplay::abort()
+{
+  m_aborted = true;
+}
+
+//-----------------------------------------------------------------------------
+void JournalReplay::run()
+{
+  using namespace std::chrono;
+
+  JournalReader reader(m_journal);
+  Event event;
+
+  const auto start = steady_clock::now();
+  long long first = -1;
+
+  while(!m_aborted && reader.next(event))
+  {
+    if(m_speed > 0 && event.time > 0)
+    {
+      if(first < 0) first = event.time;
+
+      const auto due = start + microseconds(static_cast<long long>((event.time - first) / m_speed));
+      for(auto now = steady_clock::now(); !m_aborted && now < due; now = steady_clock::now())
+      {
+        const auto remaining = duration_cast<microseconds>(due - now).count();
+        usleep(static_cast<unsigned long>(std::min<long long>(remaining, MAXIMUM_WAIT)));
+      }
+    }
+
+    const auto now = duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+    m_queue.push(event.id, event.object, event.oldName, event.event, event.count, event.properties, now);
+
+    m_replayed.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  if(!reader.errorString().isEmpty()) emit error(tr("Replay: %1").arg(reader.errorString()));
+}
@@ -0,0 +1,85 @@
+/*
+ File: JournalReplay.h
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JOURNALREPLAY_H_
+#define JOURNALREPLAY_H_
+
+// Project
+#include <EventRing.h>
+
+// Qt
+#include <QThread>
+#include <QString>
+
+// C++
+#include <atomic>
+
+/** \class JournalReplay
+ * \brief Thread replaying the changes recorded in a journal into a queue of changes, as if the
+ * watcher thread notified them again. The changes keep the recorded intervals between them,
+ * divided by the speed, or are queued as fast as possible. The replayed changes are stamped with
+ * the time they are queued, so the consumer can measure its latency. Doesn't need the GUI, so it
+ * can feed the queue of a test.
+ *
+ */
+class JournalReplay
+: public QThread
+{
+    Q_OBJECT
+  public:
+    /** \brief JournalReplay class constructor.
+     * \param[in] journal Path of a segment file or of the directory of the segments of a journal.
+     * \param[in] queue Queue of changes to fill, must outlive the thread.
+     * \param[in] speed Factor of the recorded speed, 0 to replay as fast as possible.
+     * \param[in] p Raw pointer of the object parent of this one.
+     *
+     */
+    explicit JournalReplay(const QString &journal, EventRing &queue, const double speed = 1.0, QObject *p = nullptr);
+
+    /** \brief JournalReplay class virtual destructor. Stops the thread.
+     *
+     */
+    virtual ~JournalReplay();
+
+    /** \brief Stops the replay.
+     *
+     */
+    void abort();
+
+    /** \brief Returns the number of replayed changes.
+     *
+     */
+    unsigned long long replayed() const
+    { return m_replayed.load(std::memory_order_relaxed); }
+
+  signals:
+    void error(const QString message);
+
+  protected:
+    virtual void run() override;
+
+  private:
+    const QString                   m_journal;  /** path of the journal.                           */
+    EventRing                      &m_queue;    /** queue of changes to fill.                      */
+    const double                    m_speed;    /** factor of the recorded speed, 0 for no waits.  */
+    std::atomic<unsigned long long> m_replayed; /** number of replayed changes.                    */
+    std::atomic<bool>               m_aborted;  /** true to stop the thread, false otherwise.      */
+};
+
+#endif // JOURNALREPLAY_H_
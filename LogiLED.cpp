@@ -24,6 +24,7 @@
 #include <chrono>
 #include <thread>
 
+#ifdef _WIN32
 // Logitech gaming SDK
 extern "C"
 {
@@ -31,16 +32,25 @@ extern "C"
 }
 
 using namespace LogiLed;
+#else
+// The Logitech gaming SDK is only available on Windows, keyboard lights are never available.
+static bool LogiLedInitWithName(const char *) { return false; }
+static void LogiLedShutdown() {}
+static void LogiLedPulseLighting(int, int, int, int, int) {}
+static void LogiLedGetSdkVersion(int *major, int *minor, int *build) { *major = *minor = *build = 0; }
+#endif
 
 //--------------------------------------------------------------------
 LogiLED::LogiLED()
 : m_available{LogiLedInitWithName("FilesystemWatcher")}
 , m_inUse{false}
 {
+#ifdef _WIN32
   if(m_available)
   {
     LogiLedSetTargetDevice(LOGI_DEVICETYPE_PERKEY_RGB);
   }
+#endif
 }
 
 //--------------------------------------------------------------------
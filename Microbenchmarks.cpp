@@ -0,0 +1,577 @@
+/*
+ File: Microbenchmarks.cpp
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <DirectorySnapshot.h>
+#include <WatchThread.h>
+#include <ObjectsTableModel.h>
+#include <ChangeRouter.h>
+
+// Qt
+#include <QCoreApplication>
+#include <QTemporaryDir>
+#include <QColor>
+
+// C++
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <malloc.h>
+#endif
+
+Q_DECLARE_METATYPE(std::wstring);
+Q_DECLARE_METATYPE(Events);
+
+const Events ALL_EVENTS = Events::ADDED|Events::REMOVED|Events::MODIFIED|Events::RENAMED_OLD|Events::RENAMED_NEW;
+
+const long long DRAIN_INTERVAL    = 4096; /** changes processed between takes of the queued changes. */
+const int       WALK_CHANGES      = 64;   /** changes read by every wait of the record walk.         */
+const int       TREE_FILES        = 1000; /** files of every directory of the rescanned trees.       */
+const int       RESCAN_CHANGES    = 16;   /** files modified before every rescan.                    */
+const size_t    DELIVERY_CAPACITY = 4096; /** queued changes of the delivery benchmark.              */
+const size_t    ROUTE_CHANGES     = 4096; /** changes of every routed batch.                         */
+
+/** \class WatchThreadBenchmark
+ * \brief Watcher thread with its objects in a temporary directory that processes the changes in the
+ * calling thread, without starting. Directory objects have one file each, file objects are all in
+ * the same directory and share its watch.
+ *
+ */
+class WatchThreadBenchmark
+{
+  public:
+    /** \brief WatchThreadBenchmark class constructor.
+     * \param[in] directories True to watch directory objects, false to watch file objects.
+     * \param[in] objects Number of watched objects.
+     *
+     */
+    explicit WatchThreadBenchmark(const bool directories, const int objects)
+    {
+      const std::filesystem::path root{m_root.path().toStdWString()};
+
+      for(int i = 0; i < objects; ++i)
+      {
+        const auto object = root / (L"object" + std::to_wstring(i));
+        if(directories) std::filesystem::create_directory(object);
+
+        m_files.push_back(directories ? object / L"file" : object);
+        m_names.push_back(m_files.back().filename().wstring());
+        std::ofstream{m_files.back()};
+
+        m_ids.push_back(m_thread.addObject(object, ALL_EVENTS));
+      }
+
+      m_thread.executeCommands();
+
+      for(const auto id: m_ids)
+      {
+        auto it = m_thread.m_watches.find(id);
+        if(it != m_thread.m_watches.end()) m_watches.push_back(&it->second);
+      }
+    }
+
+    /** \brief Returns true if all the objects are watched and false otherwise.
+     *
+     */
+    bool isValid() const
+    { return m_thread.m_backend && m_watches.size() == m_ids.size(); }
+
+    /** \brief Processes the change of the file of the given object as the watcher thread.
+     * \param[in] object Index of the object.
+     * \param[in] e Event.
+     *
+     */
+    bool processEvent(const int object, const Events e)
+    { return m_thread.processEvent(*m_watches[object], m_names[object], e, Properties::ALL); }
+
+    /** \brief Changes the files of the given number of objects, starting with the given one.
+     * \param[in,out] object Index of the first object, the next one on return.
+     * \param[in] count Number of files to change.
+     *
+     */
+    void write(int &object, const int count)
+    {
+      for(int i = 0; i < count; ++i)
+      {
+        std::ofstream{m_files[object], std::ios::app} << '0';
+        if(++object == static_cast<int>(m_files.size())) object = 0;
+      }
+    }
+
+    /** \brief Reads the changes of the backend and processes them as an iteration of the watcher
+     * thread loop. Returns true on success and false otherwise.
+     *
+     */
+    bool walk()
+    {
+      QString error;
+      if(!m_thread.m_backend->wait(m_thread, error, 0)) return false;
+
+      m_thread.flushModifications();
+      m_thread.refreshSnapshots();
+
+      return true;
+    }
+
+    /** \brief Takes the queued changes and refreshes the snapshots, as the consumer and the loop of
+     * the watcher thread do.
+     *
+     */
+    void drain()
+    {
+      m_thread.refreshSnapshots();
+
+      m_batch.clear();
+      m_summaries.clear();
+      m_thread.drain(m_batch, m_summaries);
+    }
+
+  private:
+    QTemporaryDir                      m_root;      /** directory of the objects.                */
+    WatchThread                        m_thread;    /** watcher thread, never started.           */
+    std::vector<std::filesystem::path> m_files;     /** changed file of every object.            */
+    std::vector<std::wstring>          m_names;     /** name of the file relative to the watch.  */
+    std::vector<WatchThread::ObjectId> m_ids;       /** identifiers of the objects.              */
+    std::vector<WatchThread::Watch *>  m_watches;   /** data of the objects in the thread.       */
+    EventBatch                         m_batch;     /** taken changes.                           */
+    std::vector<EventRing::Summary>    m_summaries; /** taken collapsed changes.                 */
+};
+
+/** \class Delivery
+ * \brief Changes of a watched object delivered to the consumer one by one with the single event
+ * signal of the watcher thread, as before the batches, or queued and taken in a batch.
+ *
+ */
+class Delivery
+{
+  public:
+    /** \brief Delivery class constructor.
+     * \param[in] batched True to take the changes in batches, false to receive the signals.
+     *
+     */
+    explicit Delivery(const bool batched)
+    : m_batched{batched}
+    , m_queue{DELIVERY_CAPACITY, EventRing::Overflow::DROP_NEWEST}
+    , m_received{0}
+    {
+      if(!m_batched)
+      {
+        QObject::connect(&m_thread, &WatchThread::modified, &m_receiver,
+                         [this](const std::wstring obj, const Events, const unsigned long count) { m_received += obj.size() + count; },
+                         Qt::QueuedConnection);
+      }
+    }
+
+    /** \brief Delivers a modification of the given path.
+     * \param[in] object Path of the changed object.
+     *
+     */
+    void deliver(const std::wstring &object)
+    {
+      if(m_batched)
+        m_queue.push(1, object, std::wstring_view(), Events::MODIFIED, 1, Properties::ALL);
+      else
+        emit m_thread.modified(object, Events::MODIFIED, 1);
+    }
+
+    /** \brief Takes the delivered changes as the consumer and returns a value computed from them.
+     *
+     */
+    size_t receive()
+    {
+      m_received = 0;
+
+      if(m_batched)
+      {
+        m_batch.clear();
+        m_summaries.clear();
+        m_queue.drain(m_batch, m_summaries);
+
+        for(const auto &change: m_batch) m_received += change.object.size() + change.count;
+      }
+      else
+      {
+        QCoreApplication::sendPostedEvents(&m_receiver);
+      }
+
+      return m_received;
+    }
+
+  private:
+    const bool                      m_batched;   /** true if taken in batches.                 */
+    WatchThread                     m_thread;    /** emitter of the signals, never started.    */
+    QObject                         m_receiver;  /** receiver of the signals.                  */
+    EventRing                       m_queue;     /** queued changes.                           */
+    EventBatch                      m_batch;     /** taken changes.                            */
+    std::vector<EventRing::Summary> m_summaries; /** taken collapsed changes, always empty.    */
+    size_t                          m_received;  /** value computed from the received changes. */
+};
+
+/** \struct Objects
+ * \brief Objects table of the application with the router of the changes to its rows, that does the
+ * same work as the application for every routed change, without the sounds and the tray. The objects
+ * are directories and the changes are of a file inside them.
+ *
+ */
+struct Objects
+: public ChangeRouter::Listener
+{
+  /** \brief Objects struct constructor.
+   * \param[in] objects Number of objects.
+   *
+   */
+  explicit Objects(const int objects)
+  : alarms{0}
+  {
+    for(int i = 0; i < objects; ++i)
+    {
+      const auto path = L"/watched/object" + std::to_wstring(i);
+
+      router.insert(path, i, true);
+      model.addObject(QString::fromStdWString(path), QColor(Qt::white));
+      paths.push_back(path);
+      renamed.push_back(path + L".renamed");
+      changed.push_back(path + L"/file");
+    }
+  }
+
+  virtual void onModification(const int row, std::wstring_view, const Events e, const unsigned long count,
+                              const Properties properties) override
+  { model.modification(row, e, count, properties); }
+
+  virtual void onRename(const int row, std::wstring_view, std::wstring_view newName, const bool isObject) override
+  {
+    if(isObject) model.rename(row, newName);
+    else         model.modification(row, Events::RENAMED_NEW, 1);
+  }
+
+  virtual void onRowsChanged(const int first, const int last, const bool renamed) override
+  { model.updateRows(first, last, renamed); }
+
+  virtual void onAlarm(const int, const Events, const Properties) override
+  { ++alarms; }
+
+  ChangeRouter              router;  /** routes the changes to their rows.    */
+  ObjectsTableModel         model;   /** objects table model.                 */
+  std::vector<std::wstring> paths;   /** path of every object.                */
+  std::vector<std::wstring> renamed; /** path of every object once renamed.   */
+  std::vector<std::wstring> changed; /** path of the changed file of objects. */
+  unsigned long long        alarms;  /** alarms dispatched by the batches.    */
+};
+
+//-----------------------------------------------------------------------------
+static std::filesystem::path tree(const int files)
+{
+  // created once for all the runs, the big ones take a while.
+  static std::map<int, std::unique_ptr<QTemporaryDir>> trees;
+
+  auto &directory = trees[files];
+  if(!directory)
+  {
+    directory = std::make_unique<QTemporaryDir>();
+    const std::filesystem::path root{directory->path().toStdWString()};
+
+    for(int i = 0; i < files; ++i)
+    {
+      const auto subdirectory = root / (L"directory" + std::to_wstring(i / TREE_FILES));
+      if(i % TREE_FILES == 0) std::filesystem::create_directory(subdirectory);
+
+      std::ofstream{subdirectory / (L"file" + std::to_wstring(i % TREE_FILES))};
+    }
+  }
+
+  return std::filesystem::path{directory->path().toStdWString()};
+}
+
+//-----------------------------------------------------------------------------
+static double memory(const std::string &field)
+{
+#ifdef __linux__
+  std::ifstream status{"/proc/self/status"};
+  std::string line;
+  while(std::getline(status, line))
+  {
+    if(line.compare(0, field.size(), field) == 0) return std::stod(line.substr(field.size() + 1)) / 1024.;
+  }
+#endif
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+static double residentMemory()
+{
+#ifdef __linux__
+  // the memory freed by the previous runs would be reused without showing in the resident size.
+  malloc_trim(0);
+#endif
+
+  return memory("VmRSS");
+}
+
+//-----------------------------------------------------------------------------
+static void resetPeakMemory()
+{
+#ifdef __linux__
+  std::ofstream{"/proc/self/clear_refs"} << '5';
+#endif
+}
+
+//-----------------------------------------------------------------------------
+static double peakMemory()
+{
+  return memory("VmHWM");
+}
+
+//-----------------------------------------------------------------------------
+static void BM_ProcessEvent(benchmark::State &state, const bool directories)
+{
+  const auto objects = static_cast<int>(state.range(0));
+
+  WatchThreadBenchmark watcher(directories, objects);
+  if(!watcher.isValid())
+  {
+    state.SkipWithError("Unable to watch the objects.");
+    return;
+  }
+
+  int object = 0;
+  long long processed = 0;
+  for(auto _: state)
+  {
+    benchmark::DoNotOptimize(watcher.processEvent(object, Events::MODIFIED));
+    if(++object == objects) object = 0;
+
+    if(++processed % DRAIN_INTERVAL == 0)
+    {
+      state.PauseTiming();
+      watcher.drain();
+      state.ResumeTiming();
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+//-----------------------------------------------------------------------------
+static void BM_RecordWalk(benchmark::State &state, const bool directories)
+{
+  const auto objects = static_cast<int>(state.range(0));
+
+  WatchThreadBenchmark watcher(directories, objects);
+  if(!watcher.isValid() || !watcher.walk())
+  {
+    state.SkipWithError("Unable to watch the objects.");
+    return;
+  }
+
+  int object = 0;
+  for(auto _: state)
+  {
+    state.PauseTiming();
+    watcher.drain();
+    watcher.write(object, WALK_CHANGES);
+    state.ResumeTiming();
+
+    if(!watcher.walk())
+    {
+      state.SkipWithError("Unable to read the changes.");
+      break;
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * WALK_CHANGES);
+}
+
+//-----------------------------------------------------------------------------
+static void BM_Delivery(benchmark::State &state, const bool batched)
+{
+  const auto records = static_cast<int>(state.range(0));
+  const std::wstring object = L"/watched/object/file";
+
+  Delivery delivery(batched);
+
+  size_t received = 0;
+  for(auto _: state)
+  {
+    for(int i = 0; i < records; ++i) delivery.deliver(object);
+
+    received += delivery.receive();
+  }
+
+  benchmark::DoNotOptimize(received);
+  state.SetItemsProcessed(state.iterations() * records);
+}
+
+//-----------------------------------------------------------------------------
+static void BM_RouteModification(benchmark::State &state)
+{
+  const auto count = static_cast<int>(state.range(0));
+  Objects objects(count);
+
+  // the objects are changed in turn, the alarms of the ones changed more than once are merged.
+  EventBatch batch;
+  for(size_t i = 0; i < ROUTE_CHANGES; ++i)
+  {
+    batch.add(objects.changed[i % count], std::wstring_view(), Events::MODIFIED, 1, Properties::SIZE|Properties::WRITE_TIME);
+  }
+
+  for(auto _: state) objects.router.route(batch, objects);
+
+  state.counters["alarms"] = benchmark::Counter(static_cast<double>(objects.alarms), benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(state.iterations() * batch.size());
+}
+
+//-----------------------------------------------------------------------------
+static void BM_RouteRename(benchmark::State &state)
+{
+  const auto count = static_cast<int>(state.range(0));
+  Objects objects(count);
+
+  // the objects are renamed by one batch and get their names back with the other one.
+  EventBatch batches[2];
+  const auto renames = std::min(static_cast<size_t>(count), ROUTE_CHANGES);
+  for(size_t i = 0; i < renames; ++i)
+  {
+    batches[0].add(objects.renamed[i], objects.paths[i], Events::RENAMED_NEW, 1);
+    batches[1].add(objects.paths[i], objects.renamed[i], Events::RENAMED_NEW, 1);
+  }
+
+  size_t batch = 0;
+  for(auto _: state)
+  {
+    objects.router.route(batches[batch], objects);
+    batch = 1 - batch;
+  }
+
+  state.SetItemsProcessed(state.iterations() * renames);
+}
+
+//-----------------------------------------------------------------------------
+static void BM_ModelModification(benchmark::State &state)
+{
+  const auto count = static_cast<int>(state.range(0));
+  Objects objects(count);
+
+  int row = 0;
+  for(auto _: state)
+  {
+    objects.model.modification(row, Events::MODIFIED, 1, Properties::SIZE|Properties::WRITE_TIME);
+    if(++row == count) row = 0;
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+//-----------------------------------------------------------------------------
+static void BM_ModelRename(benchmark::State &state)
+{
+  const auto count = static_cast<int>(state.range(0));
+  Objects objects(count);
+
+  int row = 0;
+  for(auto _: state)
+  {
+    objects.model.rename(row, objects.renamed[row]);
+    if(++row == count) row = 0;
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+//-----------------------------------------------------------------------------
+static void BM_Rescan(benchmark::State &state)
+{
+  const auto files = static_cast<int>(state.range(0));
+  const auto root = tree(files);
+
+  const auto before = residentMemory();
+
+  DirectorySnapshot snapshot(root, true);
+  QString error;
+  if(!snapshot.scan(error))
+  {
+    state.SkipWithError("Unable to scan the tree.");
+    return;
+  }
+
+  const auto scanned = residentMemory();
+  resetPeakMemory();
+
+  long long changes = 0;
+  int file = 0;
+  auto count = [&changes](const std::wstring &, const Events, const Properties) { ++changes; };
+
+  for(auto _: state)
+  {
+    state.PauseTiming();
+    for(int i = 0; i < RESCAN_CHANGES; ++i, file = (file + 1) % files)
+    {
+      const auto path = root / (L"directory" + std::to_wstring(file / TREE_FILES)) / (L"file" + std::to_wstring(file % TREE_FILES));
+      std::ofstream{path, std::ios::app} << '0';
+    }
+    state.ResumeTiming();
+
+    if(!snapshot.rescan(count, error))
+    {
+      state.SkipWithError("Unable to rescan the tree.");
+      break;
+    }
+  }
+
+  // the rescan only adds the directory being compared to the memory of the snapshot.
+  state.counters["snapshot MB"] = scanned - before;
+  state.counters["rescan MB"] = peakMemory() - scanned;
+  state.counters["changes"] = benchmark::Counter(static_cast<double>(changes), benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(state.iterations() * files);
+}
+
+BENCHMARK_CAPTURE(BM_ProcessEvent, directory, true)->Arg(1)->Arg(100)->Arg(10000);
+BENCHMARK_CAPTURE(BM_ProcessEvent, file, false)->Arg(1)->Arg(100)->Arg(10000);
+BENCHMARK_CAPTURE(BM_RecordWalk, directories, true)->Arg(1)->Arg(100)->Arg(10000);
+BENCHMARK_CAPTURE(BM_RecordWalk, files, false)->Arg(1)->Arg(100)->Arg(10000);
+BENCHMARK_CAPTURE(BM_Delivery, signals, false)->Arg(1)->Arg(64)->Arg(4096);
+BENCHMARK_CAPTURE(BM_Delivery, batch, true)->Arg(1)->Arg(64)->Arg(4096);
+BENCHMARK(BM_RouteModification)->Arg(1)->Arg(100)->Arg(10000);
+BENCHMARK(BM_RouteRename)->Arg(1)->Arg(100)->Arg(10000);
+BENCHMARK(BM_ModelModification)->Arg(1)->Arg(100)->Arg(10000);
+BENCHMARK(BM_ModelRename)->Arg(1)->Arg(100)->Arg(10000);
+BENCHMARK(BM_Rescan)->Arg(10000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+//-----------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+  // the queued signals need the application to be delivered.
+  QCoreApplication app(argc, argv);
+
+  benchmark::Initialize(&argc, argv);
+  if(benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  return 0;
+}
@@ -23,8 +23,12 @@
 
 // Qt
 #include <QString>
+#include <QStringList>
 #include <QColor>
 
+// C++
+#include <string>
+
 //-----------------------------------------------------------------------------
 ObjectsTableModel::ObjectsTableModel(QObject *p)
 : QAbstractTableModel{p}
@@ -76,16 +80,17 @@ QVariant ObjectsTableModel::data(const QModelIndex &index, int role) const
             break;
           case 1:
             {
-              auto text = std::get<1>(m_data.at(index.row()));
-              if(!text.empty()) return QString::fromStdWString(text);
-              else              return QString("Unmodified");
+              // the text is only built for the visible rows, not for every event.
+              const auto &object = m_data.at(index.row());
+              if(std::get<1>(object) != Events::NONE) return eventText(std::get<1>(object), std::get<2>(object));
+              else                                    return QString("Unmodified");
             }
             break;
           case 2:
-            return QString::number(std::get<2>(m_data.at(index.row())));
+            return QString::number(std::get<3>(m_data.at(index.row())));
           case 3:
             {
-              const auto color = std::get<3>(m_data.at(index.row()));
+              const auto color = std::get<4>(m_data.at(index.row()));
               if(!color.isValid()) return tr("None");
             }
             return tr(" ");
@@ -99,13 +104,13 @@ QVariant ObjectsTableModel::data(const QModelIndex &index, int role) const
         {
           case 3:
             {
-              const auto color = std::get<3>(m_data.at(index.row()));
+              const auto color = std::get<4>(m_data.at(index.row()));
               if(color.isValid()) return color;
             }
             break;
           case 1:
             {
-              auto changes = std::get<2>(m_data.at(index.row()));
+              auto changes = std::get<3>(m_data.at(index.row()));
               if(changes > 0) return QColor(200,120,120);
             }
             break;
@@ -155,70 +160,61 @@ QVariant ObjectsTableModel::headerData(int section, Qt::Orientation orientation,
 }
 
 //-----------------------------------------------------------------------------
-void ObjectsTableModel::modification(const std::wstring obj, const Events e)
+void ObjectsTableModel::modification(const int row, const Events e, const unsigned long count, const Properties properties)
 {
-  auto objText = QString::fromStdWString(obj);
-
-  auto matchObj = [&objText](std::tuple<std::wstring, std::wstring, unsigned long, QColor> &p)
-  {
-    auto name = QString::fromStdWString(std::get<0>(p));
-    return objText.startsWith(name);
-  };
-  auto it = std::find_if(m_data.begin(), m_data.end(), matchObj);
-
-  if(it != m_data.end())
-  {
-    auto &data = *it;
-    std::get<1>(data) = eventText(e).toStdWString();
-    std::get<2>(data) += 1;
-
-    const auto distance = std::distance(m_data.begin(), it);
-    auto tl = index(distance, 1);
-    auto br = index(distance, 2);
+  auto &data = m_data.at(row);
+  std::get<1>(data) = e;
+  std::get<2>(data) = properties;
+  std::get<3>(data) += count;
+}
 
-    emit dataChanged(tl, br, { Qt::DisplayRole, Qt::BackgroundRole });
-  }
+//-----------------------------------------------------------------------------
+void ObjectsTableModel::rename(const int row, std::wstring_view newName)
+{
+  auto &data = m_data.at(row);
+  std::get<0>(data).assign(newName);
+  std::get<1>(data) = Events::RENAMED_NEW;
+  std::get<2>(data) = Properties::ALL;
+  std::get<3>(data) += 1;
 }
 
 //-----------------------------------------------------------------------------
-void ObjectsTableModel::rename(const std::wstring oldName, const std::wstring newName)
+void ObjectsTableModel::updateRows(const int firstRow, const int lastRow, const bool renamed)
 {
-  auto objText = QString::fromStdWString(oldName);
+  auto tl = index(firstRow, renamed ? 0 : 1);
+  auto br = index(lastRow, 2);
 
-  auto matchObj = [&objText](std::tuple<std::wstring, std::wstring, unsigned long, QColor> &p)
-  {
-    auto name = QString::fromStdWString(std::get<0>(p));
-    return objText.startsWith(name) || name.compare(objText, Qt::CaseInsensitive) == 0;
-  };
-  auto it = std::find_if(m_data.begin(), m_data.end(), matchObj);
+  emit dataChanged(tl, br, { Qt::DisplayRole, Qt::BackgroundRole });
+}
 
-  if(it != m_data.end())
-  {
-    auto &data = *it;
-    std::get<0>(data) = newName;
-    std::get<1>(data) = eventText(Events::RENAMED_NEW).toStdWString();
-    std::get<2>(data) += 1;
+//-----------------------------------------------------------------------------
+void ObjectsTableModel::addObject(const QString &obj, const QColor &color)
+{
+  beginInsertRows(QModelIndex(), m_data.size(), m_data.size());
 
-    const auto distance = std::distance(m_data.begin(), it);
-    auto tl = index(distance, 0);
-    auto br = index(distance, 2);
+  m_data.emplace_back(obj.toStdWString(), Events::NONE, Properties::ALL, 0, color);
 
-    emit dataChanged(tl, br, { Qt::DisplayRole, Qt::BackgroundRole });
-  }
+  endInsertRows();
 }
 
 //-----------------------------------------------------------------------------
-void ObjectsTableModel::addObject(const QString &obj, const QColor &color)
+void ObjectsTableModel::addObjects(const std::vector<std::pair<QString, QColor>> &objects)
 {
-  beginInsertRows(QModelIndex(), m_data.size(), m_data.size());
+  if(objects.empty()) return;
+
+  beginInsertRows(QModelIndex(), m_data.size(), m_data.size() + objects.size() - 1);
 
-  m_data.emplace_back(obj.toStdWString(), std::wstring(), 0, color);
+  m_data.reserve(m_data.size() + objects.size());
+  for(const auto &object: objects)
+  {
+    m_data.emplace_back(object.first.toStdWString(), Events::NONE, Properties::ALL, 0, object.second);
+  }
 
   endInsertRows();
 }
 
 //-----------------------------------------------------------------------------
-QString ObjectsTableModel::eventText(const Events &e)
+QString ObjectsTableModel::eventText(const Events &e, const Properties properties)
 {
   switch(e)
   {
@@ -226,6 +222,10 @@ QString ObjectsTableModel::eventText(const Events &e)
       return tr("Added file");
       break;
     case Events::MODIFIED:
+      {
+        const auto changed = propertiesText(properties);
+        if(!changed.isEmpty()) return tr("Modified file %1").arg(changed);
+      }
       return tr("Modified file");
       break;
     case Events::REMOVED:
@@ -236,6 +236,9 @@ QString ObjectsTableModel::eventText(const Events &e)
     case Events::RENAMED_NEW:
       return tr("Renamed a file");
       break;
+    case Events::LOST:
+      return tr("Events lost");
+      break;
     default:
       break;
   }
@@ -244,42 +247,42 @@ QString ObjectsTableModel::eventText(const Events &e)
 }
 
 //-----------------------------------------------------------------------------
-void ObjectsTableModel::resetObject(const std::wstring &obj)
+QString ObjectsTableModel::propertiesText(const Properties properties)
 {
-  auto findObject = [&obj](std::tuple<std::wstring, std::wstring, unsigned long, QColor> &p)
-  {
-    return std::get<0>(p).compare(obj) == 0;
-  };
-  auto it = std::find_if(m_data.begin(), m_data.end(), findObject);
+  if(properties == Properties::ALL || properties == Properties::NONE) return QString();
 
-  if(it != m_data.end())
-  {
-    auto &data = *it;
-    std::get<1>(data) = std::wstring();
-    std::get<2>(data) = 0;
+  QStringList names;
+  if((properties & Properties::SIZE) != Properties::NONE)       names << tr("size");
+  if((properties & Properties::WRITE_TIME) != Properties::NONE) names << tr("write time");
+  if((properties & Properties::ATTRIBUTES) != Properties::NONE) names << tr("attributes");
+  if((properties & Properties::SECURITY) != Properties::NONE)   names << tr("security");
+  if((properties & Properties::OTHER) != Properties::NONE)      names << tr("other");
+
+  return tr("(%1)").arg(names.join(", "));
+}
 
-    const auto distance = std::distance(m_data.begin(), it);
-    auto tl = index(distance, 1);
-    auto br = index(distance, 2);
+//-----------------------------------------------------------------------------
+void ObjectsTableModel::resetObject(const int row)
+{
+  if(row < 0 || row >= static_cast<int>(m_data.size())) return;
 
-    emit dataChanged(tl, br, { Qt::DisplayRole, Qt::BackgroundRole });
-  }
+  auto &data = m_data.at(row);
+  std::get<1>(data) = Events::NONE;
+  std::get<2>(data) = Properties::ALL;
+  std::get<3>(data) = 0;
+
+  auto tl = index(row, 1);
+  auto br = index(row, 2);
+
+  emit dataChanged(tl, br, { Qt::DisplayRole, Qt::BackgroundRole });
 }
 
 //-----------------------------------------------------------------------------
-void ObjectsTableModel::removeObject(const std::wstring &obj)
+void ObjectsTableModel::removeObject(const int row)
 {
-  auto findObject = [&obj](std::tuple<std::wstring, std::wstring, unsigned long, QColor> &p)
-  {
-    return std::get<0>(p).compare(obj) == 0;
-  };
-  auto it = std::find_if(m_data.begin(), m_data.end(), findObject);
+  if(row < 0 || row >= static_cast<int>(m_data.size())) return;
 
-  if(it != m_data.end())
-  {
-    const auto distance = std::distance(m_data.begin(), it);
-    beginRemoveRows(QModelIndex(), distance, distance);
-    m_data.erase(it);
-    endRemoveRows();
-  }
+  beginRemoveRows(QModelIndex(), row, row);
+  m_data.erase(m_data.begin() + row);
+  endRemoveRows();
 }
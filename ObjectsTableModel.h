@@ -61,40 +61,65 @@ class ObjectsTableModel
      */
     void addObject(const QString &obj, const QColor &color);
 
-    /** \brief Resets the number of events of the given object.
-     * \param[in] obj Path of object.
+    /** \brief Adds the objects to the table at once, inserting all their rows in one step.
+     * \param[in] objects Paths of the objects and colors of their rows.
      *
      */
-    void resetObject(const std::wstring &obj);
+    void addObjects(const std::vector<std::pair<QString, QColor>> &objects);
 
-    /** \brief Removes the given object from the model.
-     * \param[in] obj Path of object.
+    /** \brief Resets the number of events of the object in the given row.
+     * \param[in] row Row of the object.
      *
      */
-    void removeObject(const std::wstring &obj);
+    void resetObject(const int row);
 
-  public slots:
-    /** \brief Updates the model data.
-     * \param[in] obj Path of modified object.
+    /** \brief Removes the object in the given row from the model.
+     * \param[in] row Row of the object.
+     *
+     */
+    void removeObject(const int row);
+
+    /** \brief Updates the data of the object in the given row after a modification. The view is
+     * updated by updateRows().
+     * \param[in] row Row of the object.
      * \param[in] e Modification event.
+     * \param[in] count Number of merged events.
+     * \param[in] properties Changed properties if it's a modification.
      *
      */
-    void modification(const std::wstring obj, const Events e);
+    void modification(const int row, const Events e, const unsigned long count, const Properties properties = Properties::ALL);
 
-    /** \brief Updates the model data.
-     * \param[in] oldName Path of old object name.
+    /** \brief Updates the data of the object in the given row after it was renamed. The view is
+     * updated by updateRows().
+     * \param[in] row Row of the object.
      * \param[in] newName Path of new object name.
      *
      */
-    void rename(const std::wstring oldName, const std::wstring newName);
+    void rename(const int row, std::wstring_view newName);
+
+    /** \brief Updates the view of the given range of rows after their modifications.
+     * \param[in] firstRow First modified row.
+     * \param[in] lastRow Last modified row.
+     * \param[in] renamed True if an object of the range was renamed.
+     *
+     */
+    void updateRows(const int firstRow, const int lastRow, const bool renamed);
+
+    /** \brief Returns the names of the given properties, empty if all or unknown.
+     * \param[in] properties Changed properties.
+     *
+     */
+    static QString propertiesText(const Properties properties);
 
   private:
     /** \brief Returns the text associated with the event.
+     * \param[in] e Event.
+     * \param[in] properties Changed properties if it's a modification.
      *
      */
-    QString eventText(const Events &e);
+    static QString eventText(const Events &e, const Properties properties = Properties::ALL);
 
-    std::vector<std::tuple<std::wstring, std::wstring, unsigned long, QColor>> m_data; /** model data. */
+    std::vector<std::tuple<std::wstring, Events, Properties, unsigned long, QColor>> m_data; /** model data. */
 };
 
 #endif // OBJECTSTABLEMODEL_H_
@@ -0,0 +1,285 @@
+/*
+ File: PathFilter.cpp
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <PathFilter.h>
+
+// C++
+#include <cwctype>
+#include <functional>
+
+//-----------------------------------------------------------------------------
+PathFilter::PathFilter(const std::vector<std::wstring> &include, const std::vector<std::wstring> &exclude)
+{
+  for(const auto &pattern: include) compile(pattern, m_include);
+  for(const auto &pattern: exclude) compile(pattern, m_exclude);
+}
+
+//-----------------------------------------------------------------------------
+bool PathFilter::matches(std::wstring_view path) const
+{
+  if(isEmpty()) return true;
+
+  m_path.assign(path);
+  for(auto &c: m_path) c = fold(c);
+
+  // trailing separators don't change the path.
+  std::wstring_view folded{m_path};
+  while(!folded.empty() && folded.back() == L'/') folded.remove_suffix(1);
+
+  if(!m_include.isEmpty() && !m_include.matches(folded)) return false;
+
+  return !m_exclude.matches(folded);
+}
+
+//-----------------------------------------------------------------------------
+std::vector<std::wstring> PathFilter::split(std::wstring_view text)
+{
+  std::vector<std::wstring> result;
+
+  while(!text.empty())
+  {
+    const auto end = text.find(L';');
+    auto pattern = text.substr(0, end);
+    text.remove_prefix(end == std::wstring_view::npos ? text.size() : end + 1);
+
+    while(!pattern.empty() && std::iswspace(pattern.front())) pattern.remove_prefix(1);
+    while(!pattern.empty() && std::iswspace(pattern.back())) pattern.remove_suffix(1);
+
+    if(!pattern.empty()) result.emplace_back(pattern);
+  }
+
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+bool PathFilter::Patterns::matches(std::wstring_view path) const
+{
+  if(isEmpty()) return false;
+
+  for(size_t begin = 0; ;)
+  {
+    const auto end = path.find(L'/', begin);
+    const auto name = path.substr(begin, end == std::wstring_view::npos ? end : end - begin);
+
+    if(contains(names, name)) return true;
+
+    const auto dot = name.rfind(L'.');
+    if(dot != std::wstring_view::npos && contains(extensions, name.substr(dot))) return true;
+
+    for(const auto &glob: nameGlobs)
+    {
+      if(glob.matches(name)) return true;
+    }
+
+    const auto parent = path.substr(0, end);
+    for(const auto &glob: pathGlobs)
+    {
+      if(glob.matches(parent)) return true;
+    }
+
+    if(end == std::wstring_view::npos) return false;
+    begin = end + 1;
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool PathFilter::contains(const Names &names, std::wstring_view name)
+{
+  if(names.empty()) return false;
+
+  const auto range = names.equal_range(std::hash<std::wstring_view>()(name));
+  for(auto it = range.first; it != range.second; ++it)
+  {
+    if(it->second == name) return true;
+  }
+
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+void PathFilter::compile(std::wstring_view pattern, Patterns &patterns)
+{
+  std::wstring folded(pattern);
+  for(auto &c: folded) c = fold(c);
+
+  while(!folded.empty() && folded.back() == L'/') folded.pop_back();
+
+  // a leading separator only anchors a name to the watched directory.
+  const bool isPath = folded.find(L'/') != std::wstring::npos;
+  while(!folded.empty() && folded.front() == L'/') folded.erase(0, 1);
+
+  if(folded.empty()) return;
+
+  if(!isPath)
+  {
+    if(folded.find_first_of(L"*?[") == std::wstring::npos)
+    {
+      patterns.names.emplace(std::hash<std::wstring_view>()(folded), folded);
+      return;
+    }
+
+    if(folded.size() > 2 && folded[0] == L'*' && folded[1] == L'.' && folded.find_first_of(L"*?[.", 2) == std::wstring::npos)
+    {
+      const auto extension = folded.substr(1);
+      patterns.extensions.emplace(std::hash<std::wstring_view>()(extension), extension);
+      return;
+    }
+  }
+
+  if(isPath) patterns.pathGlobs.emplace_back(folded);
+  else       patterns.nameGlobs.emplace_back(folded);
+}
+
+//-----------------------------------------------------------------------------
+PathFilter::Glob::Glob(std::wstring_view pattern)
+{
+  auto literal = [this](const wchar_t c)
+  {
+    if(m_tokens.empty() || m_tokens.back().type != Token::Type::LITERAL) m_tokens.push_back(Token{Token::Type::LITERAL, std::wstring(), false});
+    m_tokens.back().text.push_back(c);
+  };
+
+  for(size_t i = 0; i < pattern.size(); ++i)
+  {
+    const auto c = pattern[i];
+    switch(c)
+    {
+      case L'*':
+        {
+          size_t last = i;
+          while(last + 1 < pattern.size() && pattern[last + 1] == L'*') ++last;
+
+          // '**' is only special as a whole path element, it also takes the separator after it.
+          const bool isElement = (i == 0 || pattern[i - 1] == L'/') && (last + 1 == pattern.size() || pattern[last + 1] == L'/');
+          if(last > i && isElement)
+          {
+            m_tokens.push_back(Token{Token::Type::GLOBSTAR, std::wstring(), false});
+            if(last + 1 < pattern.size()) ++last;
+          }
+          else
+          {
+            m_tokens.push_back(Token{Token::Type::STAR, std::wstring(), false});
+          }
+
+          i = last;
+        }
+        break;
+      case L'?':
+        m_tokens.push_back(Token{Token::Type::ANY, std::wstring(), false});
+        break;
+      case L'[':
+        {
+          auto first = i + 1;
+          const bool negate = first < pattern.size() && (pattern[first] == L'!' || pattern[first] == L'^');
+          if(negate) ++first;
+
+          // a ']' right after the opening is part of the set.
+          const auto close = pattern.find(L']', first + 1);
+          if(first >= pattern.size() || close == std::wstring_view::npos)
+          {
+            literal(c);
+            break;
+          }
+
+          m_tokens.push_back(Token{Token::Type::SET, std::wstring(pattern.substr(first, close - first)), negate});
+          i = close;
+        }
+        break;
+      default:
+        literal(c);
+        break;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool PathFilter::Glob::match(size_t token, std::wstring_view text) const
+{
+  for(; token < m_tokens.size(); ++token)
+  {
+    const auto &current = m_tokens[token];
+    switch(current.type)
+    {
+      case Token::Type::LITERAL:
+        if(text.substr(0, current.text.size()) != current.text) return false;
+        text.remove_prefix(current.text.size());
+        break;
+      case Token::Type::ANY:
+        if(text.empty() || text.front() == L'/') return false;
+        text.remove_prefix(1);
+        break;
+      case Token::Type::SET:
+        if(text.empty() || text.front() == L'/' || inSet(current, text.front()) == current.negate) return false;
+        text.remove_prefix(1);
+        break;
+      case Token::Type::STAR:
+        // the shortest match first, without crossing a separator.
+        for(size_t i = 0; ; ++i)
+        {
+          if(match(token + 1, text.substr(i))) return true;
+          if(i == text.size() || text[i] == L'/') return false;
+        }
+        break;
+      case Token::Type::GLOBSTAR:
+        // zero or more whole directories, "a/**/b" also matches "a/b", and everything at the end.
+        if(token + 1 == m_tokens.size()) return true;
+
+        for(size_t i = 0; ; ++i)
+        {
+          if((i == 0 || text[i - 1] == L'/') && match(token + 1, text.substr(i))) return true;
+          if(i == text.size()) return false;
+        }
+        break;
+    }
+  }
+
+  return text.empty();
+}
+
+//-----------------------------------------------------------------------------
+bool PathFilter::Glob::inSet(const Token &token, const wchar_t c)
+{
+  const auto &set = token.text;
+  for(size_t i = 0; i < set.size(); ++i)
+  {
+    if(i + 2 < set.size() && set[i + 1] == L'-')
+    {
+      if(set[i] <= c && c <= set[i + 2]) return true;
+      i += 2;
+    }
+    else
+    {
+      if(set[i] == c) return true;
+    }
+  }
+
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+wchar_t PathFilter::fold(const wchar_t c)
+{
+#ifdef _WIN32
+  if(c == L'\\') return L'/';
+  return static_cast<wchar_t>(std::towlower(c));
+#else
+  return c;
+#endif
+}
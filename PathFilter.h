@@ -0,0 +1,174 @@
+/*
+ File: PathFilter.h
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATHFILTER_H_
+#define PATHFILTER_H_
+
+// C++
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/** \class PathFilter
+ * \brief Decides which paths inside a watched directory are reported, from lists of include and
+ * exclude glob patterns. A path matches a pattern without separators if its name or the name of
+ * one of its parent directories matches, and a pattern with separators if the path relative to
+ * the watched directory or the one of a parent directory matches, so a matched directory also
+ * matches its contents. '*' and '?' don't match separators, '**' matches any number of
+ * directories and '[...]' matches a character of a set. The patterns are compiled once: literal
+ * names and '*.extension' patterns are looked up in hash sets and the rest are matched token by
+ * token. On Windows the match is case-insensitive and both separators are equivalent.
+ *
+ */
+class PathFilter
+{
+  public:
+    /** \class Glob
+     * \brief Compiled glob pattern, matched against folded text.
+     *
+     */
+    class Glob
+    {
+      public:
+        /** \brief Glob class constructor.
+         * \param[in] pattern Folded glob pattern.
+         *
+         */
+        explicit Glob(std::wstring_view pattern);
+
+        /** \brief Returns true if the whole text matches the pattern.
+         * \param[in] text Folded text.
+         *
+         */
+        bool matches(std::wstring_view text) const
+        { return match(0, text); }
+
+      private:
+        /** \struct Token
+         * \brief Element of a compiled glob pattern.
+         *
+         */
+        struct Token
+        {
+          enum class Type: char { LITERAL, ANY, STAR, GLOBSTAR, SET };
+
+          Type         type;   /** kind of element.                                */
+          std::wstring text;   /** literal text or characters and ranges of a set. */
+          bool         negate; /** true if a set matches the characters not in it. */
+        };
+
+        /** \brief Returns true if the text matches the pattern from the given token.
+         * \param[in] token Position of the first token to match.
+         * \param[in] text Folded text.
+         *
+         */
+        bool match(size_t token, std::wstring_view text) const;
+
+        /** \brief Returns true if the character is in the set of the token.
+         * \param[in] token Set token.
+         * \param[in] c Folded character.
+         *
+         */
+        static bool inSet(const Token &token, const wchar_t c);
+
+        std::vector<Token> m_tokens; /** elements of the pattern. */
+    };
+
+    /** \brief PathFilter class constructor.
+     * \param[in] include Patterns of the paths to report, all the paths if empty.
+     * \param[in] exclude Patterns of the paths to not report, even if included.
+     *
+     */
+    explicit PathFilter(const std::vector<std::wstring> &include = std::vector<std::wstring>(),
+                        const std::vector<std::wstring> &exclude = std::vector<std::wstring>());
+
+    /** \brief Returns true if the filter reports all the paths.
+     *
+     */
+    bool isEmpty() const
+    { return m_include.isEmpty() && m_exclude.isEmpty(); }
+
+    /** \brief Returns true if the changes of the path must be reported and false otherwise.
+     * \param[in] path Path relative to the watched directory.
+     *
+     */
+    bool matches(std::wstring_view path) const;
+
+    /** \brief Returns the patterns of a text with the patterns separated by ';'.
+     * \param[in] text Patterns text.
+     *
+     */
+    static std::vector<std::wstring> split(std::wstring_view text);
+
+    /** \brief Returns the character as compared, case-folded on Windows with '/' as separator.
+     * \param[in] c Path character.
+     *
+     */
+    static wchar_t fold(const wchar_t c);
+
+  private:
+    /** hash of a name to the names with that hash, looked up without building a string. */
+    using Names = std::unordered_multimap<size_t, std::wstring>;
+
+    /** \struct Patterns
+     * \brief Compiled list of patterns.
+     *
+     */
+    struct Patterns
+    {
+      Names             names;      /** literal names.                        */
+      Names             extensions; /** extensions of '*.extension' patterns. */
+      std::vector<Glob> nameGlobs;  /** patterns of a name with wildcards.    */
+      std::vector<Glob> pathGlobs;  /** patterns of a path, with separators.  */
+
+      /** \brief Returns true if there are no patterns.
+       *
+       */
+      bool isEmpty() const
+      { return names.empty() && extensions.empty() && nameGlobs.empty() && pathGlobs.empty(); }
+
+      /** \brief Returns true if the path, one of its names or one of its parent directories matches
+       * a pattern.
+       * \param[in] path Folded relative path.
+       *
+       */
+      bool matches(std::wstring_view path) const;
+    };
+
+    /** \brief Returns true if the set has the given name.
+     * \param[in] names Names set.
+     * \param[in] name Folded name.
+     *
+     */
+    static bool contains(const Names &names, std::wstring_view name);
+
+    /** \brief Compiles the pattern and adds it to the list.
+     * \param[in] pattern Glob pattern.
+     * \param[in] patterns Compiled patterns.
+     *
+     */
+    static void compile(std::wstring_view pattern, Patterns &patterns);
+
+    Patterns             m_include; /** patterns of the reported paths.     */
+    Patterns             m_exclude; /** patterns of the not reported paths. */
+    mutable std::wstring m_path;    /** buffer of the folded path.          */
+};
+
+#endif // PATHFILTER_H_
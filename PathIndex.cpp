@@ -0,0 +1,213 @@
+/*
+ File: PathIndex.cpp
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <PathIndex.h>
+
+// C++
+#include <cwctype>
+#include <limits>
+
+const uint32_t PathIndex::NO_NODE = std::numeric_limits<uint32_t>::max();
+
+//-----------------------------------------------------------------------------
+PathIndex::PathIndex()
+: m_nodes{Node{-1, false, 0, 0, 0}}
+{
+}
+
+//-----------------------------------------------------------------------------
+void PathIndex::insert(std::wstring_view path, const int value, const bool isDirectory)
+{
+  uint32_t node = 0;
+  for(const auto c: trimmed(path))
+  {
+    const auto key = childKey(node, fold(c));
+    const auto it = m_children.find(key);
+    if(it != m_children.end())
+    {
+      node = it->second;
+    }
+    else
+    {
+      const Node child{-1, false, node, fold(c), 0};
+      ++m_nodes[node].children;
+
+      if(!m_free.empty())
+      {
+        node = m_free.back();
+        m_free.pop_back();
+        m_nodes[node] = child;
+      }
+      else
+      {
+        m_nodes.push_back(child);
+        node = static_cast<uint32_t>(m_nodes.size() - 1);
+      }
+      m_children.emplace(key, node);
+    }
+  }
+
+  auto &data = m_nodes[node];
+  if(data.value >= 0 && m_values[data.value] == node) m_values[data.value] = NO_NODE;
+
+  data.value = value;
+  data.isDirectory = isDirectory;
+
+  if(static_cast<size_t>(value) >= m_values.size()) m_values.resize(value + 1, NO_NODE);
+  m_values[value] = node;
+}
+
+//-----------------------------------------------------------------------------
+void PathIndex::remove(std::wstring_view path)
+{
+  const auto node = findNode(path);
+  if(node < 0 || m_nodes[node].value < 0) return;
+
+  m_values[m_nodes[node].value] = NO_NODE;
+  removeNode(static_cast<uint32_t>(node));
+}
+
+//-----------------------------------------------------------------------------
+bool PathIndex::rename(std::wstring_view oldPath, std::wstring_view newPath)
+{
+  const auto node = findNode(oldPath);
+  if(node < 0 || m_nodes[node].value < 0) return false;
+
+  const auto data = m_nodes[node];
+  remove(oldPath);
+  insert(newPath, data.value, data.isDirectory);
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void PathIndex::removeValue(const int value)
+{
+  if(value < 0 || static_cast<size_t>(value) >= m_values.size()) return;
+
+  const auto node = m_values[value];
+  m_values.erase(m_values.begin() + value);
+
+  // only the nodes of the greater values are visited.
+  for(auto i = static_cast<size_t>(value); i < m_values.size(); ++i)
+  {
+    if(m_values[i] != NO_NODE) m_nodes[m_values[i]].value = static_cast<int>(i);
+  }
+
+  if(node != NO_NODE) removeNode(node);
+}
+
+//-----------------------------------------------------------------------------
+int PathIndex::find(std::wstring_view path, const bool exact) const
+{
+  if(exact)
+  {
+    const auto node = findNode(path);
+    return node >= 0 ? m_nodes[node].value : -1;
+  }
+
+  path = trimmed(path);
+
+  // the deepest directory ending at a separator of the path, or the whole path.
+  int result = -1;
+  uint32_t node = 0;
+  for(size_t i = 0; ; ++i)
+  {
+    const auto &data = m_nodes[node];
+    if(data.value >= 0 && (i == path.size() || (data.isDirectory && isSeparator(path[i])))) result = data.value;
+
+    if(i == path.size()) break;
+
+    const auto it = m_children.find(childKey(node, fold(path[i])));
+    if(it == m_children.end()) break;
+
+    node = it->second;
+  }
+
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+void PathIndex::clear()
+{
+  m_nodes.assign(1, Node{-1, false, 0, 0, 0});
+  m_children.clear();
+  m_free.clear();
+  m_values.clear();
+}
+
+//-----------------------------------------------------------------------------
+long long PathIndex::findNode(std::wstring_view path) const
+{
+  uint32_t node = 0;
+  for(const auto c: trimmed(path))
+  {
+    const auto it = m_children.find(childKey(node, fold(c)));
+    if(it == m_children.end()) return -1;
+
+    node = it->second;
+  }
+
+  return node;
+}
+
+//-----------------------------------------------------------------------------
+void PathIndex::removeNode(uint32_t node)
+{
+  m_nodes[node].value = -1;
+
+  while(node != 0 && m_nodes[node].value < 0 && m_nodes[node].children == 0)
+  {
+    const auto parent = m_nodes[node].parent;
+    m_children.erase(childKey(parent, m_nodes[node].character));
+    --m_nodes[parent].children;
+
+    m_free.push_back(node);
+    node = parent;
+  }
+}
+
+//-----------------------------------------------------------------------------
+wchar_t PathIndex::fold(const wchar_t c)
+{
+#ifdef _WIN32
+  if(c == L'\\') return L'/';
+  return static_cast<wchar_t>(std::towlower(c));
+#else
+  return c;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+bool PathIndex::isSeparator(const wchar_t c)
+{
+#ifdef _WIN32
+  return c == L'/' || c == L'\\';
+#else
+  return c == L'/';
+#endif
+}
+
+//-----------------------------------------------------------------------------
+std::wstring_view PathIndex::trimmed(std::wstring_view path)
+{
+  while(!path.empty() && isSeparator(path.back())) path.remove_suffix(1);
+  return path;
+}
@@ -0,0 +1,147 @@
+/*
+ File: PathIndex.h
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATHINDEX_H_
+#define PATHINDEX_H_
+
+// C++
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/** \class PathIndex
+ * \brief Maps paths to the position of the watched object that owns them. A file object owns its
+ * own path and a directory object also owns every path inside it, the most specific owner is the
+ * one returned when objects are nested. Stored as a character trie, so a lookup costs the length
+ * of the path whatever the number of objects. The nodes no longer used by any path are removed
+ * and reused. On Windows the paths are case-folded and both separators are equivalent.
+ *
+ */
+class PathIndex
+{
+  public:
+    /** \brief PathIndex class constructor.
+     *
+     */
+    explicit PathIndex();
+
+    /** \brief Adds a path to the index, replacing its value if already present.
+     * \param[in] path Path of the object.
+     * \param[in] value Position of the object, must be positive and not used by another path.
+     * \param[in] isDirectory True if the object also owns the paths inside it.
+     *
+     */
+    void insert(std::wstring_view path, const int value, const bool isDirectory);
+
+    /** \brief Removes the path from the index.
+     * \param[in] path Path of the object.
+     *
+     */
+    void remove(std::wstring_view path);
+
+    /** \brief Moves the value of the object with exactly the old path to the new path. Returns true
+     * on success and false if no object has the old path.
+     * \param[in] oldPath Old path of the object.
+     * \param[in] newPath New path of the object.
+     *
+     */
+    bool rename(std::wstring_view oldPath, std::wstring_view newPath);
+
+    /** \brief Removes the path with the given value and decrements the greater values by one, as the
+     * positions of the objects after a removed one.
+     * \param[in] value Position of the removed object.
+     *
+     */
+    void removeValue(const int value);
+
+    /** \brief Returns the value of the object that owns the path or -1 if none.
+     * \param[in] path Path of a changed object.
+     * \param[in] exact True to only return the value of an object with exactly that path.
+     *
+     */
+    int find(std::wstring_view path, const bool exact = false) const;
+
+    /** \brief Removes all the paths.
+     *
+     */
+    void clear();
+
+  private:
+    /** \struct Node
+     * \brief Node of the trie, the end of a stored path if it has a value.
+     *
+     */
+    struct Node
+    {
+      int      value;       /** value of the path ending here, -1 if none.   */
+      bool     isDirectory; /** true if the path owns the paths inside it.   */
+      uint32_t parent;      /** parent node, the root is its own parent.     */
+      wchar_t  character;   /** folded character of the node in its parent. */
+      uint32_t children;    /** number of child nodes.                       */
+    };
+
+    static const uint32_t NO_NODE; /** value without path. */
+
+    /** \brief Returns the node of the given path or -1 if not in the trie.
+     * \param[in] path Path.
+     *
+     */
+    long long findNode(std::wstring_view path) const;
+
+    /** \brief Removes the value of the node and then the node and its ancestors while they have no value
+     * nor children.
+     * \param[in] node Node of a removed path.
+     *
+     */
+    void removeNode(uint32_t node);
+
+    /** \brief Returns the character as stored in the trie.
+     * \param[in] c Path character.
+     *
+     */
+    static wchar_t fold(const wchar_t c);
+
+    /** \brief Returns the path without the trailing separators, that don't change the object.
+     * \param[in] path Path.
+     *
+     */
+    static std::wstring_view trimmed(std::wstring_view path);
+
+    /** \brief Returns true if the character is a path separator.
+     * \param[in] c Path character.
+     *
+     */
+    static bool isSeparator(const wchar_t c);
+
+    /** \brief Returns the key of the child of a node in the children map.
+     * \param[in] node Parent node.
+     * \param[in] c Folded character of the child.
+     *
+     */
+    static uint64_t childKey(const uint32_t node, const wchar_t c)
+    { return (static_cast<uint64_t>(node) << 32) | static_cast<uint32_t>(c); }
+
+    std::vector<Node>                      m_nodes;    /** nodes of the trie, the first is the root.   */
+    std::unordered_map<uint64_t, uint32_t> m_children; /** node and character to child node.           */
+    std::vector<uint32_t>                  m_free;     /** removed nodes to reuse.                     */
+    std::vector<uint32_t>                  m_values;   /** node of the path of every value or NO_NODE. */
+};
+
+#endif // PATHINDEX_H_
@@ -0,0 +1,115 @@
+/*
+ File: SoundCache.cpp
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <SoundCache.h>
+
+// Qt
+#include <QSoundEffect>
+#include <QUrl>
+
+const QUrl DEFAULT_SOUND{"qrc:/FilesystemWatcher/Beeper.wav"};
+const int PREVIEW_LOOPS = 3;
+
+//-----------------------------------------------------------------------------
+SoundCache::SoundCache(QObject *p)
+: QObject{p}
+, m_alarm{nullptr}
+, m_preview{new QSoundEffect(this)}
+{
+  load(QString());
+
+  m_preview->setLoopCount(PREVIEW_LOOPS);
+}
+
+//-----------------------------------------------------------------------------
+void SoundCache::load(const QString &file)
+{
+  sound(file);
+}
+
+//-----------------------------------------------------------------------------
+void SoundCache::playAlarm(const QString &file, const unsigned char volume)
+{
+  auto effect = sound(file);
+  if(effect->status() == QSoundEffect::Error) effect = sound(QString());
+
+  if(m_alarm && m_alarm != effect) m_alarm->stop();
+
+  m_alarm = effect;
+  m_alarm->setLoopCount(QSoundEffect::Infinite);
+  m_alarm->setVolume(static_cast<float>(volume)/100.f);
+  if(!m_alarm->isPlaying()) m_alarm->play();
+}
+
+//-----------------------------------------------------------------------------
+void SoundCache::stopAlarm()
+{
+  if(m_alarm)
+  {
+    m_alarm->stop();
+    m_alarm = nullptr;
+  }
+}
+
+//-----------------------------------------------------------------------------
+void SoundCache::preview(const QString &file, const unsigned char volume)
+{
+  // the cached sound tells if the file can be decoded, and is ready if the file becomes an alarm.
+  const auto effect = sound(file);
+  const auto source = effect->status() == QSoundEffect::Error ? DEFAULT_SOUND : effect->source();
+
+  m_preview->stop();
+  if(m_preview->source() != source) m_preview->setSource(source);
+  m_preview->setVolume(static_cast<float>(volume)/100.f);
+  m_preview->play();
+}
+
+//-----------------------------------------------------------------------------
+void SoundCache::setPreviewVolume(const unsigned char volume)
+{
+  m_preview->setVolume(static_cast<float>(volume)/100.f);
+}
+
+//-----------------------------------------------------------------------------
+void SoundCache::stopPreview()
+{
+  m_preview->stop();
+}
+
+//-----------------------------------------------------------------------------
+bool SoundCache::isPreviewPlaying() const
+{
+  return m_preview->isPlaying();
+}
+
+//-----------------------------------------------------------------------------
+QSoundEffect *SoundCache::sound(const QString &file)
+{
+  auto it = m_sounds.find(file);
+  if(it != m_sounds.end()) return it->second;
+
+  // the resource is read directly, without the temporary file.
+  auto effect = new QSoundEffect(this);
+  effect->setSource(file.isEmpty() ? DEFAULT_SOUND : QUrl::fromLocalFile(file));
+
+  m_sounds.emplace(file, effect);
+
+  return effect;
+}
@@ -0,0 +1,118 @@
+/*
+ File: SoundCache.h
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SOUNDCACHE_H_
+#define SOUNDCACHE_H_
+
+// Qt
+#include <QObject>
+#include <QString>
+
+// C++
+#include <map>
+
+class QSoundEffect;
+
+/** \class SoundCache
+ * \brief Keeps the alarm sounds decoded in memory, each one is loaded once and played from there.
+ * An empty sound file name is the default alarm sound of the application. The alarm and the preview
+ * of a sound in a dialog play separately, one never stops or changes the other.
+ *
+ */
+class SoundCache
+: public QObject
+{
+    Q_OBJECT
+  public:
+    /** \brief SoundCache class constructor. Loads the default alarm sound.
+     * \param[in] p Raw pointer of the object parent of this one.
+     *
+     */
+    explicit SoundCache(QObject *p = nullptr);
+
+    /** \brief SoundCache class virtual destructor.
+     *
+     */
+    virtual ~SoundCache()
+    {};
+
+    /** \brief Loads the sound if it's not in the cache. The sounds are decoded in the background,
+     * loading them in advance leaves only the start of the playback for the alarm.
+     * \param[in] file Sound file name, empty for the default sound.
+     *
+     */
+    void load(const QString &file);
+
+    /** \brief Plays the sound of the alarm until stopped, stopping the alarm sound being played if
+     * different. The default sound is played instead if the file can't be decoded.
+     * \param[in] file Sound file name, empty for the default sound.
+     * \param[in] volume Volume in [1-100].
+     *
+     */
+    void playAlarm(const QString &file, const unsigned char volume);
+
+    /** \brief Stops the sound of the alarm.
+     *
+     */
+    void stopAlarm();
+
+    /** \brief Returns true if an alarm was started and not stopped, even between the loops of its
+     * sound, and false otherwise.
+     *
+     */
+    bool isAlarmPlaying() const
+    { return m_alarm != nullptr; }
+
+    /** \brief Plays the sound a few times to try it, restarting the preview being played. The default
+     * sound is played instead if the file can't be decoded.
+     * \param[in] file Sound file name, empty for the default sound.
+     * \param[in] volume Volume in [1-100].
+     *
+     */
+    void preview(const QString &file, const unsigned char volume);
+
+    /** \brief Changes the volume of the preview.
+     * \param[in] volume Volume in [1-100].
+     *
+     */
+    void setPreviewVolume(const unsigned char volume);
+
+    /** \brief Stops the preview.
+     *
+     */
+    void stopPreview();
+
+    /** \brief Returns true if a preview is being played and false otherwise.
+     *
+     */
+    bool isPreviewPlaying() const;
+
+  private:
+    /** \brief Returns the sound of the file, loading it if not in the cache.
+     * \param[in] file Sound file name, empty for the default sound.
+     *
+     */
+    QSoundEffect *sound(const QString &file);
+
+    std::map<QString, QSoundEffect *> m_sounds;  /** sound file name to its decoded sound.          */
+    QSoundEffect                     *m_alarm;   /** sound of the alarm, nullptr if none.           */
+    QSoundEffect                     *m_preview; /** sound of the preview, separate from the alarm. */
+};
+
+#endif // SOUNDCACHE_H_
@@ -0,0 +1,339 @@
+/*
+ File: Tests.cpp
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <EventRing.h>
+#include <GitIgnore.h>
+#include <PathFilter.h>
+#include <PathIndex.h>
+
+// Qt
+#include <QObject>
+#include <QTemporaryDir>
+#include <QtTest>
+
+// C++
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/** \class Tests
+ * \brief Unit tests of the path filters, the .gitignore rules, the index of the watched paths and
+ * the overflow policies of the queue of changes.
+ *
+ */
+class Tests
+: public QObject
+{
+    Q_OBJECT
+  private slots:
+    void filterGlob();
+    void filterGlobstar();
+    void filterSets();
+    void filterExclude();
+    void gitIgnoreNegation();
+    void gitIgnoreDirectoryOnly();
+    void gitIgnoreAnchoring();
+    void gitIgnoreNested();
+    void indexOwners();
+    void indexRename();
+    void indexRemoveValue();
+    void ringDropNewest();
+    void ringDropOldest();
+    void ringCollapse();
+
+  private:
+    /** \brief Creates the file with the given contents, and its parent directories.
+     * \param[in] path Path of the file.
+     * \param[in] contents Contents of the file.
+     *
+     */
+    static void createFile(const std::filesystem::path &path, const std::string &contents = std::string());
+
+    /** \brief Returns the paths of the changes of the batch, in order.
+     * \param[in] batch Changes.
+     *
+     */
+    static std::vector<std::wstring> paths(const EventBatch &batch);
+};
+
+//-----------------------------------------------------------------------------
+void Tests::createFile(const std::filesystem::path &path, const std::string &contents)
+{
+  std::filesystem::create_directories(path.parent_path());
+  std::ofstream{path} << contents;
+}
+
+//-----------------------------------------------------------------------------
+std::vector<std::wstring> Tests::paths(const EventBatch &batch)
+{
+  std::vector<std::wstring> result;
+  for(const auto event: batch) result.emplace_back(event.object);
+
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+void Tests::filterGlob()
+{
+  const PathFilter filter({L"*.txt", L"a?.log"});
+
+  QVERIFY(filter.matches(L"a.txt"));
+  QVERIFY(filter.matches(L"dir/a.txt"));
+  QVERIFY(!filter.matches(L"a.cpp"));
+  QVERIFY(filter.matches(L"ab.log"));
+  QVERIFY(!filter.matches(L"abc.log"));
+
+  // the contents of a matched directory match too.
+  QVERIFY(filter.matches(L"notes.txt/a.cpp"));
+}
+
+//-----------------------------------------------------------------------------
+void Tests::filterGlobstar()
+{
+  const PathFilter filter({L"src/**/*.h"});
+
+  QVERIFY(filter.matches(L"src/a.h"));
+  QVERIFY(filter.matches(L"src/x/y/a.h"));
+  QVERIFY(!filter.matches(L"lib/a.h"));
+  QVERIFY(!filter.matches(L"src/x/a.cpp"));
+
+  // '*' doesn't match separators.
+  const PathFilter single({L"src/*.h"});
+  QVERIFY(single.matches(L"src/a.h"));
+  QVERIFY(!single.matches(L"src/x/a.h"));
+}
+
+//-----------------------------------------------------------------------------
+void Tests::filterSets()
+{
+  const PathFilter digits({L"file[0-9].txt"});
+  QVERIFY(digits.matches(L"file1.txt"));
+  QVERIFY(!digits.matches(L"filea.txt"));
+
+  const PathFilter others({L"file[!0-9].txt"});
+  QVERIFY(others.matches(L"filea.txt"));
+  QVERIFY(!others.matches(L"file1.txt"));
+}
+
+//-----------------------------------------------------------------------------
+void Tests::filterExclude()
+{
+  const PathFilter filter({}, {L"build", L"*.o"});
+
+  QVERIFY(filter.matches(L"src/main.cpp"));
+  QVERIFY(filter.matches(L"src/build.cpp"));
+  QVERIFY(!filter.matches(L"build/main.cpp"));
+  QVERIFY(!filter.matches(L"src/main.o"));
+
+  // the excluded paths are not reported even if included.
+  const PathFilter both({L"*.cpp"}, {L"generated"});
+  QVERIFY(both.matches(L"src/main.cpp"));
+  QVERIFY(!both.matches(L"generated/main.cpp"));
+  QVERIFY(!both.matches(L"src/main.h"));
+}
+
+//-----------------------------------------------------------------------------
+void Tests::gitIgnoreNegation()
+{
+  QTemporaryDir directory;
+  const std::filesystem::path root{directory.path().toStdWString()};
+  createFile(root / ".gitignore", "*.log\n!keep.log\n");
+
+  GitIgnore ignore(root);
+  QVERIFY(ignore.isIgnored(L"a.log"));
+  QVERIFY(ignore.isIgnored(L"dir/a.log"));
+  QVERIFY(!ignore.isIgnored(L"keep.log"));
+  QVERIFY(!ignore.isIgnored(L"a.txt"));
+  QVERIFY(ignore.isIgnored(L".git/config"));
+}
+
+//-----------------------------------------------------------------------------
+void Tests::gitIgnoreDirectoryOnly()
+{
+  QTemporaryDir directory;
+  const std::filesystem::path root{directory.path().toStdWString()};
+  createFile(root / ".gitignore", "tmp/\n");
+  createFile(root / "a" / "tmp" / "file");
+  createFile(root / "b" / "tmp");
+
+  GitIgnore ignore(root);
+  QVERIFY(ignore.isIgnored(L"a/tmp"));
+  QVERIFY(ignore.isIgnored(L"a/tmp/file"));
+  QVERIFY(!ignore.isIgnored(L"b/tmp"));
+}
+
+//-----------------------------------------------------------------------------
+void Tests::gitIgnoreAnchoring()
+{
+  QTemporaryDir directory;
+  const std::filesystem::path root{directory.path().toStdWString()};
+  createFile(root / ".gitignore", "/build\ndoc/*.txt\n");
+
+  GitIgnore ignore(root);
+  QVERIFY(ignore.isIgnored(L"build"));
+  QVERIFY(ignore.isIgnored(L"build/main.o"));
+  QVERIFY(!ignore.isIgnored(L"src/build"));
+  QVERIFY(ignore.isIgnored(L"doc/a.txt"));
+  QVERIFY(!ignore.isIgnored(L"src/doc/a.txt"));
+}
+
+//-----------------------------------------------------------------------------
+void Tests::gitIgnoreNested()
+{
+  QTemporaryDir directory;
+  const std::filesystem::path root{directory.path().toStdWString()};
+  createFile(root / ".gitignore", "*.log\n");
+  createFile(root / "sub" / ".gitignore", "!*.log\n");
+
+  GitIgnore ignore(root);
+  QVERIFY(ignore.isIgnored(L"a.log"));
+  QVERIFY(!ignore.isIgnored(L"sub/a.log"));
+
+  // the rules are read again once their file changes.
+  createFile(root / "sub" / ".gitignore", "");
+  ignore.update(L"sub/.gitignore");
+  QVERIFY(ignore.isIgnored(L"sub/a.log"));
+}
+
+//-----------------------------------------------------------------------------
+void Tests::indexOwners()
+{
+  PathIndex index;
+  index.insert(L"/w", 0, true);
+  index.insert(L"/w/a", 1, true);
+  index.insert(L"/w/a/f", 2, false);
+
+  QCOMPARE(index.find(L"/w/x"), 0);
+  QCOMPARE(index.find(L"/w/a/y"), 1);
+  QCOMPARE(index.find(L"/w/a/f"), 2);
+  QCOMPARE(index.find(L"/w/a/"), 1);
+  QCOMPARE(index.find(L"/wx"), -1);
+
+  // a file object doesn't own the paths that start with its own.
+  QCOMPARE(index.find(L"/w/a/f2"), 1);
+
+  QCOMPARE(index.find(L"/w/a/y", true), -1);
+  QCOMPARE(index.find(L"/w/a", true), 1);
+
+  index.remove(L"/w/a");
+  QCOMPARE(index.find(L"/w/a/y"), 0);
+  QCOMPARE(index.find(L"/w/a/f"), 2);
+}
+
+//-----------------------------------------------------------------------------
+void Tests::indexRename()
+{
+  PathIndex index;
+  index.insert(L"/w", 0, true);
+  index.insert(L"/w/a", 1, true);
+
+  QVERIFY(index.rename(L"/w/a", L"/w/b"));
+  QCOMPARE(index.find(L"/w/b/y"), 1);
+  QCOMPARE(index.find(L"/w/a/y"), 0);
+
+  QVERIFY(!index.rename(L"/w/a", L"/w/c"));
+}
+
+//-----------------------------------------------------------------------------
+void Tests::indexRemoveValue()
+{
+  PathIndex index;
+  index.insert(L"/a", 0, true);
+  index.insert(L"/b", 1, true);
+  index.insert(L"/c", 2, false);
+
+  index.removeValue(0);
+  QCOMPARE(index.find(L"/a/x"), -1);
+  QCOMPARE(index.find(L"/b/x"), 0);
+  QCOMPARE(index.find(L"/c"), 1);
+
+  // the freed nodes are reused by the next paths.
+  index.insert(L"/a", 2, true);
+  QCOMPARE(index.find(L"/a/x"), 2);
+}
+
+//-----------------------------------------------------------------------------
+void Tests::ringDropNewest()
+{
+  EventRing ring(2, EventRing::Overflow::DROP_NEWEST);
+  QCOMPARE(ring.capacity(), size_t{2});
+
+  for(const auto path: {L"/a", L"/b", L"/c"}) ring.push(1, path, std::wstring_view(), Events::MODIFIED, 1, Properties::ALL);
+
+  EventBatch batch;
+  std::vector<EventRing::Summary> summaries;
+  QVERIFY(ring.drain(batch, summaries));
+  QCOMPARE(paths(batch), (std::vector<std::wstring>{L"/a", L"/b"}));
+  QVERIFY(summaries.empty());
+  QCOMPARE(ring.dropped(), 1ull);
+
+  batch.clear();
+  QVERIFY(!ring.drain(batch, summaries));
+}
+
+//-----------------------------------------------------------------------------
+void Tests::ringDropOldest()
+{
+  EventRing ring(3, EventRing::Overflow::DROP_OLDEST);
+  QCOMPARE(ring.capacity(), size_t{4});
+
+  for(const auto path: {L"/a", L"/b", L"/c", L"/d", L"/e", L"/f"}) ring.push(1, path, std::wstring_view(), Events::MODIFIED, 1, Properties::ALL);
+
+  EventBatch batch;
+  std::vector<EventRing::Summary> summaries;
+  QVERIFY(ring.drain(batch, summaries));
+  QCOMPARE(paths(batch), (std::vector<std::wstring>{L"/c", L"/d", L"/e", L"/f"}));
+  QCOMPARE(ring.dropped(), 2ull);
+}
+
+//-----------------------------------------------------------------------------
+void Tests::ringCollapse()
+{
+  EventRing ring(2, EventRing::Overflow::COLLAPSE);
+
+  ring.push(1, L"/a", std::wstring_view(), Events::MODIFIED, 1, Properties::SIZE);
+  ring.push(1, L"/a", std::wstring_view(), Events::MODIFIED, 1, Properties::SIZE);
+  ring.push(1, L"/a", std::wstring_view(), Events::MODIFIED, 2, Properties::WRITE_TIME);
+  ring.push(1, L"/a", std::wstring_view(), Events::MODIFIED, 1, Properties::SIZE);
+  ring.push(2, L"/b", std::wstring_view(), Events::ADDED, 1, Properties::ALL);
+
+  EventBatch batch;
+  std::vector<EventRing::Summary> summaries;
+  QVERIFY(ring.drain(batch, summaries));
+  QCOMPARE(batch.size(), size_t{2});
+  QCOMPARE(ring.collapsed(), 3ull);
+
+  // one summary for every object and event, with the events and properties of all its changes.
+  QCOMPARE(summaries.size(), size_t{2});
+  QCOMPARE(summaries[0].key, EventRing::Key{1});
+  QCOMPARE(summaries[0].count, 3ul);
+  QVERIFY(summaries[0].properties == (Properties::SIZE|Properties::WRITE_TIME));
+  QCOMPARE(summaries[1].key, EventRing::Key{2});
+  QVERIFY(summaries[1].event == Events::ADDED);
+
+  // the summaries are taken once.
+  batch.clear();
+  summaries.clear();
+  QVERIFY(!ring.drain(batch, summaries));
+}
+
+QTEST_APPLESS_MAIN(Tests)
+#include "Tests.moc"
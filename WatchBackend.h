@@ -0,0 +1,152 @@
+/*
+ File: WatchBackend.h
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WATCHBACKEND_H_
+#define WATCHBACKEND_H_
+
+// Project
+#include <Events.h>
+
+// Qt
+#include <QString>
+
+// C++
+#include <filesystem>
+#include <memory>
+#include <string_view>
+
+/** \class WatchBackend
+ * \brief Interface of the operating system specific part of the directory watching. A backend
+ * multiplexes any number of directory watches and waits for the changes of all of them at once.
+ *
+ */
+class WatchBackend
+{
+  public:
+    using WatchId = unsigned long;
+
+    /** \class Listener
+     * \brief Receives the changes read by the backend.
+     *
+     */
+    class Listener
+    {
+      public:
+        /** \brief Listener class virtual destructor.
+         *
+         */
+        virtual ~Listener()
+        {};
+
+        /** \brief Called for every change read.
+         * \param[in] id Watch identifier.
+         * \param[in] name Name of the changed object relative to the watched directory.
+         * \param[in] e Event.
+         *
+         */
+        virtual void onChange(const WatchId id, std::wstring_view name, const Events e) = 0;
+
+        /** \brief Called when the notifications of a watch overflowed and an unknown number of changes
+         * were lost. The watch continues.
+         * \param[in] id Watch identifier.
+         *
+         */
+        virtual void onOverflow(const WatchId id) = 0;
+
+        /** \brief Called when a watch fails. The watch has already been removed from the backend.
+         * \param[in] id Watch identifier.
+         * \param[in] message Error message.
+         *
+         */
+        virtual void onError(const WatchId id, const QString &message) = 0;
+    };
+
+    /** \brief Returns the backend of the current platform.
+     *
+     */
+    static std::unique_ptr<WatchBackend> create();
+
+    /** \brief WatchBackend class virtual destructor.
+     *
+     */
+    virtual ~WatchBackend()
+    {};
+
+    /** \brief Acquires the system resources needed to wait for changes. Returns true on success
+     * and false otherwise.
+     * \param[out] error Error message in case of failure.
+     *
+     */
+    virtual bool open(QString &error) = 0;
+
+    /** \brief Starts watching the given directory. Returns true on success and false otherwise. Only the
+     * changes needed to report the given events are requested to the system, but other changes can still
+     * be reported.
+     * \param[in] id Watch identifier, unique for the backend.
+     * \param[in] directory Path of the directory to watch.
+     * \param[in] recursive True to monitor the directory subtree, false to only monitor the directory files.
+     * \param[in] events Events to report.
+     * \param[in] properties Properties whose modifications are reported, if modifications are reported.
+     * \param[out] error Error message in case of failure.
+     *
+     */
+    virtual bool addWatch(const WatchId id, const std::filesystem::path &directory, bool recursive,
+                          const Events events, const Properties properties, QString &error) = 0;
+
+    /** \brief Changes the events reported by the given watch. Returns true on success and false otherwise,
+     * in which case the watch keeps reporting the previous events.
+     * \param[in] id Watch identifier.
+     * \param[in] events Events to report.
+     * \param[in] properties Properties whose modifications are reported, if modifications are reported.
+     * \param[out] error Error message in case of failure.
+     *
+     */
+    virtual bool updateWatch(const WatchId id, const Events events, const Properties properties, QString &error) = 0;
+
+    /** \brief Stops watching the directory of the given watch.
+     * \param[in] id Watch identifier.
+     *
+     */
+    virtual void removeWatch(const WatchId id) = 0;
+
+    /** \brief Returns true if the changes of the given watch come from a mark of its whole filesystem,
+     * that costs the same whatever the size of the watched directory tree.
+     * \param[in] id Watch identifier.
+     *
+     */
+    virtual bool isFilesystemWatch(const WatchId id) const
+    { return false; }
+
+    /** \brief Blocks until there are changes in any of the watched directories, wakeUp() is called or the
+     * timeout expires, and notifies the listener of the changes read. Returns false if the backend has failed,
+     * in which case the error message will not be empty, and true otherwise.
+     * \param[in] listener Listener of the changes.
+     * \param[out] error Error message in case of failure.
+     * \param[in] timeout Maximum time to wait in milliseconds, or -1 to wait without limit.
+     *
+     */
+    virtual bool wait(Listener &listener, QString &error, const int timeout = -1) = 0;
+
+    /** \brief Makes a blocked or the next wait() return. Can be called from any thread.
+     *
+     */
+    virtual void wakeUp() = 0;
+};
+
+#endif // WATCHBACKEND_H_
@@ -0,0 +1,205 @@
+/*
+ File: WatchSettings.cpp
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <WatchSettings.h>
+#include <EventJournal.h>
+#include <PathFilter.h>
+
+// Qt
+#include <QCoreApplication>
+#include <QDir>
+#include <QSettings>
+#include <QStandardPaths>
+
+// C++
+#include <algorithm>
+
+const QString INI_FILENAME{"FilesystemWatcher.ini"};
+
+const QString QUEUE_CAPACITY = "Events queue capacity";
+const QString QUEUE_OVERFLOW = "Events queue overflow";
+const QString JOURNAL_ENABLED = "Journal enabled";
+const QString JOURNAL_DIRECTORY = "Journal directory";
+const QString JOURNAL_SEGMENT_SIZE = "Journal segment size";
+const QString JOURNAL_MAXIMUM_SIZE = "Journal maximum size";
+const QString JOURNAL_MAXIMUM_AGE = "Journal maximum age";
+const QString OBJECTS = "Objects";
+const QString OBJECT_PATH = "Path";
+const QString OBJECT_EVENTS = "Events";
+const QString OBJECT_RECURSIVE = "Recursive";
+const QString OBJECT_WINDOW = "Merge window";
+const QString OBJECT_CONTENTS = "Compare contents";
+const QString OBJECT_PROPERTIES = "Properties";
+const QString OBJECT_INCLUDE = "Include patterns";
+const QString OBJECT_EXCLUDE = "Exclude patterns";
+const QString OBJECT_GITIGNORE = "Use gitignore";
+const QString OBJECT_ALARMS = "Alarms";
+const QString OBJECT_COLOR = "Color";
+const QString OBJECT_VOLUME = "Volume";
+const QString OBJECT_SOUND = "Sound";
+
+const long long MEGABYTE = 1024 * 1024;
+const long long DAY = 24 * 3600;
+
+//-----------------------------------------------------------------------------
+std::unique_ptr<QSettings> WatchSettings::applicationSettings()
+{
+  QDir applicationDir{QCoreApplication::applicationDirPath()};
+  if(applicationDir.exists(INI_FILENAME))
+  {
+    return std::make_unique<QSettings>(INI_FILENAME, QSettings::IniFormat);
+  }
+
+  return std::make_unique<QSettings>("Felix de las Pozas Alvarez", "FilesystemWatcher");
+}
+
+//-----------------------------------------------------------------------------
+std::vector<WatchedObject> WatchSettings::loadObjects(QSettings &settings)
+{
+  std::vector<WatchedObject> objects;
+
+  const auto count = settings.beginReadArray(OBJECTS);
+  objects.reserve(count);
+
+  for(int i = 0; i < count; ++i)
+  {
+    settings.setArrayIndex(i);
+
+    const auto path = settings.value(OBJECT_PATH).toString();
+    if(path.isEmpty()) continue;
+
+    WatchedObject object;
+    object.path = std::filesystem::path{path.toStdWString()};
+    object.events = static_cast<Events>(settings.value(OBJECT_EVENTS, 63).toInt());
+    object.recursive = settings.value(OBJECT_RECURSIVE, false).toBool();
+    object.window = settings.value(OBJECT_WINDOW, 0).toUInt();
+    object.contents = settings.value(OBJECT_CONTENTS, false).toBool();
+    object.properties = static_cast<Properties>(settings.value(OBJECT_PROPERTIES, 31).toInt());
+    object.include = settings.value(OBJECT_INCLUDE, QString()).toString();
+    object.exclude = settings.value(OBJECT_EXCLUDE, QString()).toString();
+    object.gitIgnore = settings.value(OBJECT_GITIGNORE, false).toBool();
+    object.alarms = settings.value(OBJECT_ALARMS, 7).toInt();
+    object.color = QColor(settings.value(OBJECT_COLOR, QColor(Qt::white).name()).toString());
+    object.volume = static_cast<unsigned char>(std::min(100, std::max(1, settings.value(OBJECT_VOLUME, 100).toInt())));
+    object.sound = settings.value(OBJECT_SOUND, QString()).toString();
+
+    objects.push_back(std::move(object));
+  }
+
+  settings.endArray();
+
+  return objects;
+}
+
+//-----------------------------------------------------------------------------
+void WatchSettings::saveObjects(QSettings &settings, const std::vector<WatchedObject> &objects)
+{
+  // the array is removed first, a shorter one would keep the last entries.
+  settings.remove(OBJECTS);
+
+  settings.beginWriteArray(OBJECTS, static_cast<int>(objects.size()));
+  for(int i = 0; i < static_cast<int>(objects.size()); ++i)
+  {
+    const auto &object = objects.at(i);
+
+    settings.setArrayIndex(i);
+    settings.setValue(OBJECT_PATH, QString::fromStdWString(object.path.wstring()));
+    settings.setValue(OBJECT_EVENTS, static_cast<int>(object.events));
+    settings.setValue(OBJECT_RECURSIVE, object.recursive);
+    settings.setValue(OBJECT_WINDOW, object.window);
+    settings.setValue(OBJECT_CONTENTS, object.contents);
+    settings.setValue(OBJECT_PROPERTIES, static_cast<int>(object.properties));
+    settings.setValue(OBJECT_INCLUDE, object.include);
+    settings.setValue(OBJECT_EXCLUDE, object.exclude);
+    settings.setValue(OBJECT_GITIGNORE, object.gitIgnore);
+    settings.setValue(OBJECT_ALARMS, object.alarms);
+    settings.setValue(OBJECT_COLOR, object.color.name());
+    settings.setValue(OBJECT_VOLUME, object.volume);
+    settings.setValue(OBJECT_SOUND, object.sound);
+  }
+  settings.endArray();
+}
+
+//-----------------------------------------------------------------------------
+void WatchSettings::loadQueue(const QSettings &settings, size_t &capacity, EventRing::Overflow &overflow)
+{
+  capacity = std::max(1024u, settings.value(QUEUE_CAPACITY, static_cast<unsigned int>(WatchThread::DEFAULT_QUEUE_CAPACITY)).toUInt());
+  overflow = static_cast<EventRing::Overflow>(std::min(2, std::max(0, settings.value(QUEUE_OVERFLOW, 2).toInt())));
+}
+
+//-----------------------------------------------------------------------------
+void WatchSettings::saveQueue(QSettings &settings, const size_t capacity, const EventRing::Overflow overflow)
+{
+  settings.setValue(QUEUE_CAPACITY, static_cast<unsigned int>(capacity));
+  settings.setValue(QUEUE_OVERFLOW, static_cast<int>(overflow));
+}
+
+//-----------------------------------------------------------------------------
+EventJournal *WatchSettings::createJournal(const QSettings &settings, QObject *parent)
+{
+  if(!settings.value(JOURNAL_ENABLED, true).toBool()) return nullptr;
+
+  const auto defaultDirectory = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/journal";
+  const auto directory = settings.value(JOURNAL_DIRECTORY, defaultDirectory).toString();
+  const auto segmentSize = settings.value(JOURNAL_SEGMENT_SIZE, EventJournal::DEFAULT_SEGMENT_SIZE / MEGABYTE).toLongLong();
+  const auto maximumSize = settings.value(JOURNAL_MAXIMUM_SIZE, EventJournal::DEFAULT_MAXIMUM_SIZE / MEGABYTE).toLongLong();
+  const auto maximumAge = settings.value(JOURNAL_MAXIMUM_AGE, EventJournal::DEFAULT_MAXIMUM_AGE / DAY).toLongLong();
+
+  return new EventJournal(directory, segmentSize * MEGABYTE, maximumSize * MEGABYTE, maximumAge * DAY, parent);
+}
+
+//-----------------------------------------------------------------------------
+void WatchSettings::saveJournal(QSettings &settings, const EventJournal *journal)
+{
+  settings.setValue(JOURNAL_ENABLED, journal != nullptr);
+  if(journal)
+  {
+    settings.setValue(JOURNAL_DIRECTORY, journal->directory());
+    settings.setValue(JOURNAL_SEGMENT_SIZE, journal->segmentSize() / MEGABYTE);
+    settings.setValue(JOURNAL_MAXIMUM_SIZE, journal->maximumSize() / MEGABYTE);
+    settings.setValue(JOURNAL_MAXIMUM_AGE, journal->maximumAge() / DAY);
+  }
+}
+
+//-----------------------------------------------------------------------------
+WatchThread::ObjectId WatchSettings::addObject(WatchThread &watcher, const WatchedObject &object)
+{
+  return watcher.addObjects({parameters(object)}).front();
+}
+
+//-----------------------------------------------------------------------------
+std::vector<WatchThread::ObjectId> WatchSettings::addObjects(WatchThread &watcher, const std::vector<WatchedObject> &objects)
+{
+  std::vector<WatchThread::ObjectParameters> parametersList;
+  parametersList.reserve(objects.size());
+
+  for(const auto &object: objects) parametersList.push_back(parameters(object));
+
+  return watcher.addObjects(parametersList);
+}
+
+//-----------------------------------------------------------------------------
+WatchThread::ObjectParameters WatchSettings::parameters(const WatchedObject &object)
+{
+  const PathFilter filter(PathFilter::split(object.include.toStdWString()), PathFilter::split(object.exclude.toStdWString()));
+
+  return WatchThread::ObjectParameters{object.path, object.events, object.recursive, object.window, object.contents, object.properties, filter,
+                                       object.gitIgnore};
+}
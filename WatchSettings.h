@@ -0,0 +1,142 @@
+/*
+ File: WatchSettings.h
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WATCHSETTINGS_H_
+#define WATCHSETTINGS_H_
+
+// Project
+#include <EventRing.h>
+#include <Events.h>
+#include <WatchThread.h>
+
+// Qt
+#include <QColor>
+#include <QString>
+
+// C++
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+class EventJournal;
+class QObject;
+class QSettings;
+
+/** \struct WatchedObject
+ * \brief Parameters of an object saved in the settings. The alarms are only used by the application
+ * dialog.
+ *
+ */
+struct WatchedObject
+{
+  std::filesystem::path path;       /** path of the object.                                   */
+  Events                events;     /** events to watch.                                      */
+  bool                  recursive;  /** true to monitor the directory subtree.                */
+  unsigned int          window;     /** time in milliseconds to merge repeated events.        */
+  bool                  contents;   /** true to only notify modifications of the contents.    */
+  Properties            properties; /** properties whose modifications are notified.          */
+  QString               include;    /** included path patterns of a directory.                */
+  QString               exclude;    /** excluded path patterns of a directory.                */
+  bool                  gitIgnore;  /** true to ignore the paths in the '.gitignore' files.   */
+  int                   alarms;     /** alarms of the object, AlarmFlags values.              */
+  QColor                color;      /** color of the keyboard lights alarm.                   */
+  unsigned char         volume;     /** volume of the sound alarm in [1-100].                 */
+  QString               sound;      /** sound file of the alarm, empty for the default one.   */
+};
+
+/** \class WatchSettings
+ * \brief Settings of the watch engine shared by the application dialog and the headless mode: the
+ * watched objects, the queue of changes and the journal.
+ *
+ */
+class WatchSettings
+{
+  public:
+    /** \brief Returns the settings of the application, the INI file next to the executable if it
+     * exists or the ones of the user otherwise.
+     *
+     */
+    static std::unique_ptr<QSettings> applicationSettings();
+
+    /** \brief Returns the watched objects in the settings.
+     * \param[in] settings Application settings.
+     *
+     */
+    static std::vector<WatchedObject> loadObjects(QSettings &settings);
+
+    /** \brief Saves the watched objects in the settings, replacing the previous ones.
+     * \param[in] settings Application settings.
+     * \param[in] objects Watched objects.
+     *
+     */
+    static void saveObjects(QSettings &settings, const std::vector<WatchedObject> &objects);
+
+    /** \brief Reads the parameters of the queue of changes.
+     * \param[in] settings Application settings.
+     * \param[out] capacity Maximum number of queued changes.
+     * \param[out] overflow Policy when the queue is full.
+     *
+     */
+    static void loadQueue(const QSettings &settings, size_t &capacity, EventRing::Overflow &overflow);
+
+    /** \brief Saves the parameters of the queue of changes.
+     * \param[in] settings Application settings.
+     * \param[in] capacity Maximum number of queued changes.
+     * \param[in] overflow Policy when the queue is full.
+     *
+     */
+    static void saveQueue(QSettings &settings, const size_t capacity, const EventRing::Overflow overflow);
+
+    /** \brief Returns a new journal with the parameters of the settings, or nullptr if disabled.
+     * \param[in] settings Application settings.
+     * \param[in] parent Raw pointer of the object parent of the journal.
+     *
+     */
+    static EventJournal *createJournal(const QSettings &settings, QObject *parent);
+
+    /** \brief Saves the parameters of the journal.
+     * \param[in] settings Application settings.
+     * \param[in] journal Raw pointer of the journal, nullptr if disabled.
+     *
+     */
+    static void saveJournal(QSettings &settings, const EventJournal *journal);
+
+    /** \brief Starts watching the object and returns its identifier.
+     * \param[in] watcher Watcher thread.
+     * \param[in] object Watch parameters of the object.
+     *
+     */
+    static WatchThread::ObjectId addObject(WatchThread &watcher, const WatchedObject &object);
+
+    /** \brief Starts watching the objects at once and returns their identifiers in the same order.
+     * \param[in] watcher Watcher thread.
+     * \param[in] objects Watch parameters of the objects.
+     *
+     */
+    static std::vector<WatchThread::ObjectId> addObjects(WatchThread &watcher, const std::vector<WatchedObject> &objects);
+
+  private:
+    /** \brief Returns the parameters of the watcher thread of the object.
+     * \param[in] object Watch parameters of the object.
+     *
+     */
+    static WatchThread::ObjectParameters parameters(const WatchedObject &object);
+};
+
+#endif // WATCHSETTINGS_H_
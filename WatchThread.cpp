@@ -19,190 +19,1150 @@
 
 // Project
 #include <WatchThread.h>
+#include <ContentHash.h>
+
+// Qt
+#include <QMetaMethod>
+#include <QMutexLocker>
+#include <QSemaphore>
 
 // C++
-#include <cassert>
-#include <winapifamily.h>
-#include <shlwapi.h>
-#include <windows.h>
-#include <fileapi.h>
-#include <array>
+#include <algorithm>
+#include <unordered_set>
 
 //-----------------------------------------------------------------------------
-WatchThread::WatchThread(const std::filesystem::path &object, const Events events, bool recursive, QObject *p)
+WatchThread::WatchThread(QObject *p)
 : QThread{p}
-, m_object(object)
-, m_events{events}
-, m_stopHandle{0}
-, m_isDirectory{std::filesystem::is_directory(object)}
-, m_isRename{false}
-, m_recursive{recursive}
+, m_backend{WatchBackend::create()}
+, m_queue{std::make_unique<EventRing>(DEFAULT_QUEUE_CAPACITY, EventRing::Overflow::COLLAPSE)}
+, m_journal{nullptr}
+, m_nextId{1}
+, m_aborted{false}
+{
+  // opened here so wakeUp() can be called safely before the thread starts.
+  if(!m_backend->open(m_openError)) m_backend = nullptr;
+
+  m_hashPool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() / 2));
+  m_scanPool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() / 2));
+}
+
+//-----------------------------------------------------------------------------
+WatchThread::~WatchThread()
+{
+  abort();
+  wait();
+
+  m_hashPool.waitForDone();
+  m_scanPool.waitForDone();
+}
+
+//-----------------------------------------------------------------------------
+WatchThread::ObjectId WatchThread::addObject(const std::filesystem::path &object, const Events events, bool recursive, const unsigned int window,
+                                             const bool contents, const Properties properties, const PathFilter &filter, const bool gitIgnore)
+{
+  return addObjects({ObjectParameters{object, events, recursive, window, contents, properties, filter, gitIgnore}}).front();
+}
+
+//-----------------------------------------------------------------------------
+std::vector<WatchThread::ObjectId> WatchThread::addObjects(const std::vector<ObjectParameters> &objects)
+{
+  std::vector<ObjectId> ids;
+  ids.reserve(objects.size());
+
+  std::vector<Watch> watches;
+  watches.reserve(objects.size());
+
+  for(const auto &object: objects)
+  {
+    ids.push_back(m_nextId++);
+    watches.push_back(createWatch(ids.back(), object));
+  }
+
+  auto addWatch = [this, watches = std::move(watches)]() mutable
+  {
+    addWatches(watches);
+  };
+  post(addWatch);
+
+  return ids;
+}
+
+//-----------------------------------------------------------------------------
+WatchThread::Watch WatchThread::createWatch(const ObjectId id, const ObjectParameters &object)
+{
+  Watch watch;
+  watch.id = id;
+  watch.object = object.object;
+  watch.path = object.object.wstring();
+  watch.filename = object.object.filename().wstring();
+  watch.events = object.events;
+  watch.isDirectory = std::filesystem::is_directory(object.object);
+  watch.isRename = false;
+  watch.oldIncluded = true;
+  watch.recursive = object.recursive;
+  watch.window = object.window;
+  watch.directory = 0;
+  watch.deferred = false;
+  watch.lost = false;
+  watch.contents = object.contents;
+  watch.properties = object.properties;
+  watch.filter = object.filter;
+  if(object.gitIgnore && watch.isDirectory) watch.gitIgnore = std::make_shared<GitIgnore>(object.object);
+
+  return watch;
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::addWatches(std::vector<Watch> &watches)
+{
+  std::vector<std::shared_ptr<DirectorySnapshot> *> snapshots;
+  std::vector<Directory *> directories;
+  std::vector<ObjectId> hashed;
+  std::vector<ObjectId> trees;
+
+  for(auto &watch: watches)
+  {
+    if(!watch.isDirectory)
+    {
+      const auto id = watch.id;
+      const auto contents = watch.contents;
+
+      auto directory = addFile(std::move(watch), snapshots);
+      if(!directory) continue;
+
+      if(std::find(directories.cbegin(), directories.cend(), directory) == directories.cend()) directories.push_back(directory);
+
+      // the first modification is compared with the contents when the watch started.
+      if(contents) hashed.push_back(id);
+      continue;
+    }
+
+    QString errorString;
+    if(!m_backend->addWatch(watch.id, watch.object, watch.recursive, watch.events, watchedProperties(watch), errorString))
+    {
+      const auto name = QString::fromStdWString(watch.object.wstring());
+      emit error(tr("Monitor of '%1': %2").arg(name).arg(errorString));
+      continue;
+    }
+
+    auto it = m_watches.emplace(watch.id, std::move(watch)).first;
+
+    // same as a file object, the first modification of any of its files needs the previous contents.
+    if(it->second.contents) trees.push_back(it->first);
+
+    // the mark of the filesystem costs the same for any tree, reading all of it now would cost the most.
+    if(m_backend->isFilesystemWatch(it->first))
+    {
+      it->second.deferred = true;
+      continue;
+    }
+
+    // taken after the watch starts so no change is missed, the changes meanwhile update it.
+    it->second.snapshot = std::make_shared<DirectorySnapshot>(it->second.object, it->second.recursive);
+    snapshots.push_back(&it->second.snapshot);
+  }
+
+  // once per directory, with the events of all its new files.
+  for(auto directory: directories) updateFilter(*directory);
+
+  scanSnapshots(snapshots);
+
+  for(const auto id: hashed)
+  {
+    const auto it = m_watches.find(id);
+    if(it != m_watches.end()) hashContents(it->second, it->second.path, false);
+  }
+
+  for(const auto id: trees)
+  {
+    const auto it = m_watches.find(id);
+    if(it != m_watches.end()) hashTree(it->second);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::scanSnapshots(const std::vector<std::shared_ptr<DirectorySnapshot> *> &snapshots)
+{
+  if(snapshots.empty()) return;
+
+  // shared with the helpers, that can start after all the snapshots were read.
+  struct Scan
+  {
+    std::vector<std::shared_ptr<DirectorySnapshot>> snapshots;
+    std::vector<char>                               failed;
+    std::atomic<size_t>                             next;
+    QSemaphore                                      read;
+  };
+
+  auto shared = std::make_shared<Scan>();
+  for(const auto snapshot: snapshots) shared->snapshots.push_back(*snapshot);
+  shared->failed.assign(snapshots.size(), false);
+  shared->next = 0;
+
+  // the changes wait in the backend meanwhile and update the snapshots once read.
+  auto scan = [](Scan &state)
+  {
+    QString errorString;
+    for(auto i = state.next++; i < state.snapshots.size(); i = state.next++)
+    {
+      state.failed[i] = !state.snapshots[i]->scan(errorString);
+      state.read.release();
+    }
+  };
+
+  const auto helpers = static_cast<int>(std::min<size_t>(snapshots.size() - 1, m_scanPool.maxThreadCount()));
+  for(int i = 0; i < helpers; ++i)
+  {
+    m_scanPool.start([shared, scan]() { scan(*shared); });
+  }
+
+  // the helpers that didn't start in time find nothing left to read.
+  scan(*shared);
+  shared->read.acquire(static_cast<int>(snapshots.size()));
+
+  for(size_t i = 0; i < snapshots.size(); ++i)
+  {
+    if(shared->failed[i]) *snapshots[i] = nullptr;
+  }
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::removeObject(const ObjectId id)
+{
+  auto removeWatch = [this, id]()
+  {
+    flushPending(id, true);
+
+    const auto it = m_watches.find(id);
+    if(it == m_watches.end()) return;
+
+    if(it->second.isDirectory) m_backend->removeWatch(id);
+    else                       removeFile(it->second);
+
+    m_watches.erase(it);
+  };
+  post(removeWatch);
+}
+
+//-----------------------------------------------------------------------------
+WatchThread::Directory *WatchThread::addFile(Watch watch, std::vector<std::shared_ptr<DirectorySnapshot> *> &snapshots)
+{
+  const auto directory = watch.object.parent_path();
+
+  auto sameDirectory = [&directory](const std::pair<const WatchBackend::WatchId, Directory> &d) { return d.second.path == directory; };
+  auto it = std::find_if(m_directories.begin(), m_directories.end(), sameDirectory);
+  if(it == m_directories.end())
+  {
+    // the subtree is never watched, the changes of the files are the ones of the directory entries.
+    const auto directoryId = m_nextId++;
+
+    QString errorString;
+    if(!m_backend->addWatch(directoryId, directory, false, watch.events, watchedProperties(watch), errorString))
+    {
+      const auto name = QString::fromStdWString(watch.path);
+      emit error(tr("Monitor of '%1': %2").arg(name).arg(errorString));
+      return nullptr;
+    }
+
+    Directory data;
+    data.id = directoryId;
+    data.path = directory;
+    data.events = watch.events;
+    data.properties = watchedProperties(watch);
+    data.snapshot = std::make_shared<DirectorySnapshot>(directory, false);
+
+    it = m_directories.emplace(directoryId, std::move(data)).first;
+    snapshots.push_back(&it->second.snapshot);
+  }
+
+  watch.directory = it->first;
+  it->second.files[std::hash<std::wstring_view>()(watch.filename)].push_back(watch.id);
+
+  m_watches.emplace(watch.id, std::move(watch));
+
+  return &it->second;
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::removeFile(const Watch &watch)
+{
+  auto it = m_directories.find(watch.directory);
+  if(it == m_directories.end()) return;
+
+  auto &directory = it->second;
+
+  auto remove = [&watch](std::vector<ObjectId> &ids) { ids.erase(std::remove(ids.begin(), ids.end(), watch.id), ids.end()); };
+  remove(directory.renaming);
+
+  const auto files = directory.files.find(std::hash<std::wstring_view>()(watch.filename));
+  if(files != directory.files.end())
+  {
+    remove(files->second);
+    if(files->second.empty()) directory.files.erase(files);
+  }
+
+  if(directory.files.empty())
+  {
+    m_backend->removeWatch(directory.id);
+    m_directories.erase(it);
+    return;
+  }
+
+  updateFilter(directory);
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::updateFilter(Directory &directory)
+{
+  auto events = Events::NONE;
+  auto properties = Properties::NONE;
+  for(const auto &files: directory.files)
+  {
+    for(const auto id: files.second)
+    {
+      const auto it = m_watches.find(id);
+      if(it == m_watches.end()) continue;
+
+      // the properties only matter to the files that watch modifications.
+      events |= it->second.events;
+      if((it->second.events & Events::MODIFIED) != Events::NONE) properties |= watchedProperties(it->second);
+    }
+  }
+
+  if(events == directory.events && properties == directory.properties) return;
+
+  // on failure the watch keeps reporting the previous changes.
+  QString errorString;
+  if(!m_backend->updateWatch(directory.id, events, properties, errorString))
+  {
+    const auto name = QString::fromStdWString(directory.path.wstring());
+    emit error(tr("Monitor of '%1': %2").arg(name).arg(errorString));
+    return;
+  }
+
+  directory.events = events;
+  directory.properties = properties;
+}
+
+//-----------------------------------------------------------------------------
+Properties WatchThread::watchedProperties(const Watch &watch)
 {
+  if(!watch.contents) return watch.properties;
+
+  return watch.properties & (Properties::SIZE | Properties::WRITE_TIME);
 }
 
 //-----------------------------------------------------------------------------
 void WatchThread::abort()
 {
-  SetEvent(m_stopHandle);
+  m_aborted = true;
+  if(m_backend) m_backend->wakeUp();
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::post(std::function<void()> command)
+{
+  {
+    QMutexLocker lock(&m_mutex);
+    m_commands.push_back(std::move(command));
+  }
 
-  this->deleteLater();
+  if(m_backend) m_backend->wakeUp();
 }
 
 //-----------------------------------------------------------------------------
-void WatchThread::run()
+void WatchThread::executeCommands()
 {
-  const auto id = tr("Monitor thread of '%1'").arg(QString::fromStdWString(m_object.wstring()));
-  const auto name = (m_isDirectory) ? m_object.wstring() : m_object.parent_path().wstring();
+  std::vector<std::function<void()>> commands;
+  {
+    QMutexLocker lock(&m_mutex);
+    std::swap(commands, m_commands);
+  }
 
-  auto objectHandle = CreateFileW(name.c_str(),
-                                  FILE_LIST_DIRECTORY,
-                                  FILE_SHARE_READ | FILE_SHARE_DELETE | FILE_SHARE_WRITE,
-                                  nullptr,
-                                  OPEN_EXISTING,
-                                  FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
-                                  nullptr);
+  for(auto &command: commands) command();
+}
 
-  if (objectHandle == INVALID_HANDLE_VALUE)
+//-----------------------------------------------------------------------------
+void WatchThread::run()
+{
+  if(!m_backend)
   {
-    const auto errorString = getLastErrorString(GetLastError());
-    emit error(tr("%1: Unable to create object handle. Error: %2").arg(id).arg(errorString));
+    emit error(tr("Monitor thread: %1").arg(m_openError));
     return;
   }
 
-  m_stopHandle = CreateEvent(nullptr, true, false, nullptr);
-  if (m_stopHandle == INVALID_HANDLE_VALUE)
+  QString errorString;
+  while(!m_aborted)
+  {
+    executeCommands();
+
+    const auto timeout = notifyPending();
+
+    if(!m_backend->wait(*this, errorString, timeout))
+    {
+      emit error(tr("Monitor thread: %1").arg(errorString));
+      return;
+    }
+
+    flushModifications();
+    refreshSnapshots();
+  }
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::deliver(const ObjectId id, std::wstring_view object, std::wstring_view oldName, const Events e, const unsigned long count,
+                          const Properties properties)
+{
+  // the single event signals are only built if someone listens to them.
+  if(oldName.empty())
   {
-    const auto errorString = getLastErrorString(GetLastError());
-    emit error(tr("%1: Unable to create signal event handle. Error: %2").arg(id).arg(errorString));
+    if(isSignalConnected(QMetaMethod::fromSignal(&WatchThread::modified))) emit modified(std::wstring(object), e, count);
+  }
+  else
+  {
+    if(isSignalConnected(QMetaMethod::fromSignal(&WatchThread::renamed))) emit renamed(std::wstring(oldName), std::wstring(object));
+  }
+
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  const auto time = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+
+  m_queue->push(id, object, oldName, e, count, properties, time);
+
+  if(m_journal) m_journal->record(id, object, oldName, e, count, properties, time);
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::setQueue(const size_t capacity, const EventRing::Overflow overflow)
+{
+  m_queue = std::make_unique<EventRing>(capacity, overflow);
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::setJournal(EventJournal *journal)
+{
+  m_journal = journal;
+}
+
+//-----------------------------------------------------------------------------
+bool WatchThread::drain(EventBatch &batch, std::vector<EventRing::Summary> &summaries)
+{
+  return m_queue->drain(batch, summaries);
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::onChange(const WatchBackend::WatchId id, std::wstring_view name, const Events e)
+{
+  if(isFiltered(id, name, e)) return;
+
+  // the modifications wait for the refresh of the snapshot that tells their changed properties, the
+  // other changes are processed after them to keep the order. The properties are only read if some
+  // object doesn't watch all of them.
+  if(e == Events::MODIFIED)
+  {
+    const auto snapshot = findSnapshot(id);
+    if(snapshot && needsChanges(id))
+    {
+      updateSnapshot(snapshot, name, e, true);
+
+      m_modifications.push_back(Modification{id, m_modifiedNames.size(), name.size()});
+      m_modifiedNames.append(name);
+      return;
+    }
+  }
+  else
+  {
+    flushModifications();
+  }
+
+  auto directory = m_directories.find(id);
+  if(directory != m_directories.end())
+  {
+    updateSnapshot(directory->second.snapshot, name, e, false);
+
+    dispatchFiles(directory->second, name, e, Properties::ALL);
     return;
   }
 
-  OVERLAPPED overlapped{0};
-  memset(&overlapped, 0, sizeof(OVERLAPPED));
+  auto it = m_watches.find(id);
+  if(it == m_watches.end()) return;
+
+  auto &watch = it->second;
+  if(watch.reading) watch.missed.emplace_back(name, e);
+  updateSnapshot(watch.snapshot, name, e, false);
+
+  dispatch(watch, name, e, Properties::ALL);
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::readSnapshot(Watch &watch)
+{
+  // refreshed now, the thread doesn't touch it again until it's back.
+  const bool rescanned = watch.snapshot != nullptr;
+  if(rescanned)
+  {
+    flushModifications();
+    refreshSnapshots();
+  }
 
-  std::vector<BYTE> buffer(2048, 0);
+  watch.reading = rescanned ? std::move(watch.snapshot) : std::make_shared<DirectorySnapshot>(watch.object, watch.recursive);
+  watch.snapshot = nullptr;
 
-  bool async_pending = false;
-  DWORD bytes_returned = 0;
-  std::array<HANDLE, 2> handles = { objectHandle, m_stopHandle };
-  while(true)
+  const auto id = watch.id;
+  auto scan = [this, id, snapshot = watch.reading, rescanned]()
   {
-    const auto result = ReadDirectoryChangesW(objectHandle,
-                                              buffer.data(),
-                                              static_cast<DWORD>(buffer.size()),
-                                              static_cast<WINBOOL>(m_recursive),
-                                              watchProperties,
-                                              0,
-                                              &overlapped,
-                                              0);
+    std::vector<Difference> differences;
+    auto collect = [&differences](const std::wstring &name, const Events e, const Properties properties)
+    {
+      differences.push_back(Difference{name, e, properties});
+    };
+
+    QString errorString;
+    const bool success = rescanned ? snapshot->rescan(collect, errorString) : snapshot->scan(errorString);
 
-    if(result == 0)
+    post([this, id, snapshot, rescanned, success, errorString, differences = std::move(differences)]()
     {
-      const auto errorString = getLastErrorString(GetLastError());
-      emit error(tr("%1: Unable to read changes. Error: %2").arg(id).arg(errorString));
+      onSnapshotRead(id, snapshot, rescanned, success, errorString, differences);
+    });
+  };
+  m_scanPool.start(scan);
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::onSnapshotRead(const ObjectId id, const std::shared_ptr<DirectorySnapshot> &snapshot, const bool rescanned, const bool success,
+                                 const QString &message, const std::vector<Difference> &differences)
+{
+  const auto it = m_watches.find(id);
+  if(it == m_watches.end() || it->second.reading != snapshot) return;
+
+  auto &watch = it->second;
+  watch.reading = nullptr;
+
+  // the paths notified meanwhile were already reported with their last state.
+  std::unordered_set<std::wstring_view> notified;
+  for(const auto &change: watch.missed) notified.insert(change.first);
+
+  for(const auto &difference: differences)
+  {
+    const bool isRename = difference.event == Events::RENAMED_OLD || difference.event == Events::RENAMED_NEW;
+    if(!isRename && notified.find(difference.name) != notified.end()) continue;
+
+    if(isIncluded(watch, difference.name)) dispatch(watch, difference.name, difference.event, difference.properties);
+  }
+
+  if(!success)
+  {
+    const auto name = QString::fromStdWString(watch.object.wstring());
+    emit error(tr("Monitor of '%1': %2").arg(name).arg(message));
+
+    // a failed rescan keeps the recorded entries, a failed first read is tried again on the next overflow.
+    if(!rescanned)
+    {
+      watch.missed.clear();
+      watch.lost = false;
       return;
     }
+  }
 
-    async_pending = true;
+  watch.snapshot = snapshot;
+  for(const auto &change: watch.missed) updateSnapshot(watch.snapshot, change.first, change.second, false);
+  watch.missed.clear();
+
+  if(watch.lost)
+  {
+    watch.lost = false;
+    rescan(watch);
+  }
+}
+
+//-----------------------------------------------------------------------------
+std::shared_ptr<DirectorySnapshot> WatchThread::findSnapshot(const WatchBackend::WatchId id) const
+{
+  const auto directory = m_directories.find(id);
+  if(directory != m_directories.end()) return directory->second.snapshot;
+
+  const auto it = m_watches.find(id);
+  if(it != m_watches.end()) return it->second.snapshot;
+
+  return nullptr;
+}
+
+//-----------------------------------------------------------------------------
+bool WatchThread::needsChanges(const WatchBackend::WatchId id) const
+{
+  const auto directory = m_directories.find(id);
+  if(directory != m_directories.end()) return directory->second.properties != Properties::ALL;
+
+  const auto it = m_watches.find(id);
+  return it != m_watches.end() && watchedProperties(it->second) != Properties::ALL;
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::flushModifications()
+{
+  if(m_modifications.empty()) return;
+
+  refreshSnapshots();
+
+  for(const auto &modification: m_modifications)
+  {
+    const auto name = std::wstring_view{m_modifiedNames}.substr(modification.name, modification.length);
 
-    switch(WaitForMultipleObjects(2, handles.data(), false, INFINITE))
+    auto directory = m_directories.find(modification.id);
+    if(directory != m_directories.end())
     {
-      case WAIT_OBJECT_0:
-        {
-          if (!GetOverlappedResult(objectHandle, &overlapped, &bytes_returned, true))
-          {
-            const auto errorString = getLastErrorString(GetLastError());
-            emit error(tr("%1: Unable to finish overlapped IO. Error: %2").arg(id).arg(errorString));
-            return;
-          }
+      const auto &snapshot = directory->second.snapshot;
+      dispatchFiles(directory->second, name, Events::MODIFIED, snapshot ? snapshot->changes(name) : Properties::ALL);
+      continue;
+    }
 
-          async_pending = false;
+    auto it = m_watches.find(modification.id);
+    if(it == m_watches.end()) continue;
 
-          if (bytes_returned == 0) break;
+    const auto &snapshot = it->second.snapshot;
+    dispatch(it->second, name, Events::MODIFIED, snapshot ? snapshot->changes(name) : Properties::ALL);
+  }
 
-          auto information = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(&buffer[0]);
-          do
-          {
-            const std::wstring changed_file_w{ information->FileName, information->FileNameLength / sizeof(information->FileName[0]) };
-            const Events event = eventMapping.at(information->Action);
-            
-            if((m_events & event) != Events::NONE)
-            {
-              if(!processEvent(changed_file_w, event))
-              {
-                // break;
-                //
-                // NOTE: gcc 9.2.0 worked fine, upgrading to gcc 11.3.0
-                // broke this giving a modified event for the desired file
-                // even when nothing has changed after another HANDLE has been
-                // modified in the same directory.
-                // Updated: 31-12-2023 Still broken with gcc 13.1.0.
-              }
-            }
-
-            if (information->NextEntryOffset == 0) break;
-
-            information = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(reinterpret_cast<BYTE*>(information) + information->NextEntryOffset);
-          } while (true);
-        }
-        break;
-      case WAIT_OBJECT_0 + 1:
-      // no break;
-      default:
-        return;
+  m_modifications.clear();
+  m_modifiedNames.clear();
+}
+
+//-----------------------------------------------------------------------------
+bool WatchThread::isFiltered(const WatchBackend::WatchId id, std::wstring_view name, const Events e) const
+{
+  const auto it = m_watches.find(id);
+  if(it == m_watches.end()) return false;
+
+  const auto &watch = it->second;
+  if(watch.gitIgnore) watch.gitIgnore->update(name);
+
+  // the renames are filtered by both names when complete.
+  if(e == Events::RENAMED_OLD || e == Events::RENAMED_NEW) return false;
+
+  return !isIncluded(watch, name);
+}
+
+//-----------------------------------------------------------------------------
+bool WatchThread::isIncluded(const Watch &watch, std::wstring_view name)
+{
+  if(watch.gitIgnore && watch.gitIgnore->isIgnored(name)) return false;
+
+  return watch.filter.matches(name);
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::updateSnapshot(const std::shared_ptr<DirectorySnapshot> &snapshot, std::wstring_view name, const Events e, const bool read)
+{
+  if(!snapshot) return;
+
+  const bool wasStale = snapshot->isStale();
+  snapshot->update(name, e, read);
+
+  if(!wasStale && snapshot->isStale()) m_stale.push_back(snapshot);
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::refreshSnapshots()
+{
+  // the changed entries are read once, the modifications need them before being sent.
+  for(const auto &snapshot: m_stale) snapshot->refresh();
+
+  m_stale.clear();
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::dispatch(Watch &watch, std::wstring_view name, const Events e, const Properties properties)
+{
+  if((watch.events & e) != Events::NONE)
+  {
+    if(!processEvent(watch, name, e, properties))
+    {
+      // break;
+      //
+      // NOTE: gcc 9.2.0 worked fine, upgrading to gcc 11.3.0
+      // broke this giving a modified event for the desired file
+      // even when nothing has changed after another HANDLE has been
+      // modified in the same directory.
+      // Updated: 31-12-2023 Still broken with gcc 13.1.0.
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::dispatchFiles(Directory &directory, std::wstring_view name, const Events e, const Properties properties)
+{
+  // the objects renamed by the previous change get this one, with the new name.
+  m_dispatched.assign(directory.renaming.cbegin(), directory.renaming.cend());
+  directory.renaming.clear();
+
+  // hash collisions are discarded comparing the names.
+  const auto files = directory.files.find(std::hash<std::wstring_view>()(name));
+  if(files != directory.files.end())
+  {
+    for(const auto id: files->second)
+    {
+      if(std::find(m_dispatched.cbegin(), m_dispatched.cend(), id) == m_dispatched.cend()) m_dispatched.push_back(id);
     }
   }
 
-  if (async_pending)
+  for(const auto id: m_dispatched)
   {
-    //clean up running async io
-    CancelIo(objectHandle);
-    GetOverlappedResult(objectHandle, &overlapped, &bytes_returned, TRUE);
+    auto it = m_watches.find(id);
+    if(it == m_watches.end()) continue;
+
+    auto &watch = it->second;
+    const auto oldHash = std::hash<std::wstring_view>()(watch.filename);
+
+    dispatch(watch, name, e, properties);
+
+    if(watch.isRename) directory.renaming.push_back(id);
+
+    const auto newHash = std::hash<std::wstring_view>()(watch.filename);
+    if(newHash != oldHash)
+    {
+      auto &ids = directory.files[oldHash];
+      ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+      if(ids.empty()) directory.files.erase(oldHash);
+
+      directory.files[newHash].push_back(id);
+    }
   }
 }
 
 //-----------------------------------------------------------------------------
-QString WatchThread::getLastErrorString(const DWORD errorCode)
+void WatchThread::onOverflow(const WatchBackend::WatchId id)
 {
-  QString message;
+  flushModifications();
 
-  if(errorCode != 0)
+  auto directory = m_directories.find(id);
+  if(directory != m_directories.end())
   {
-    LPSTR messageBuffer = nullptr;
+    rescanFiles(directory->second);
+    return;
+  }
+
+  auto it = m_watches.find(id);
+  if(it == m_watches.end()) return;
 
-    //Ask Win32 to give us the string version of that message ID.
-    //The parameters we pass in, tell Win32 to create the buffer that holds the message for us (because we don't yet know how long the message string will be).
-    size_t size = FormatMessageA(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
-                                 NULL, errorCode, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), (LPSTR)&messageBuffer, 0, NULL);
+  auto &watch = it->second;
 
-    //Copy the error message into a std::string.
-    message = QString::fromLocal8Bit(messageBuffer, size);
+  // the new name of a pending rename may have been lost.
+  watch.isRename = false;
+  watch.oldName.clear();
+
+  // reported on the object itself, the lost changes are recovered from the snapshot.
+  deliver(watch.id, watch.path, std::wstring_view(), Events::LOST, 1);
+
+  rescan(watch);
+}
 
-    //Free the Win32's string's buffer.
-    LocalFree(messageBuffer);
+//-----------------------------------------------------------------------------
+void WatchThread::onError(const WatchBackend::WatchId id, const QString &message)
+{
+  if(m_watches.find(id) == m_watches.end() && m_directories.find(id) == m_directories.end()) return;
+
+  // not inside the backend wait(), that is still reporting the failure.
+  post([this, id, message]() { recover(id, message); });
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::recover(const ObjectId id, const QString &message)
+{
+  auto directory = m_directories.find(id);
+  if(directory != m_directories.end())
+  {
+    recoverFiles(directory->second, message);
+    return;
+  }
+
+  auto it = m_watches.find(id);
+  if(it == m_watches.end()) return;
+
+  auto &watch = it->second;
+  const auto name = QString::fromStdWString(watch.path);
+
+  QString errorString;
+  if((!watch.snapshot && !watch.reading && !watch.deferred) || !std::filesystem::is_directory(watch.object) || !m_backend->addWatch(id, watch.object, watch.recursive, watch.events, watchedProperties(watch), errorString))
+  {
+    flushPending(id, false);
+    m_watches.erase(it);
+
+    emit error(tr("Monitor of '%1': %2").arg(name).arg(message));
+    return;
   }
 
-  return message;
+  watch.isRename = false;
+  watch.oldName.clear();
+
+  // the changes while not watching are unknown until the rescan.
+  deliver(watch.id, watch.path, std::wstring_view(), Events::LOST, 1);
+
+  rescan(watch);
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::recoverFiles(Directory &directory, const QString &message)
+{
+  QString errorString;
+  if(directory.snapshot && std::filesystem::is_directory(directory.path) && m_backend->addWatch(directory.id, directory.path, false, directory.events, directory.properties, errorString))
+  {
+    rescanFiles(directory);
+    return;
+  }
+
+  std::vector<ObjectId> ids;
+  for(const auto &files: directory.files) ids.insert(ids.end(), files.second.cbegin(), files.second.cend());
+
+  m_directories.erase(directory.id);
+
+  for(const auto id: ids)
+  {
+    auto it = m_watches.find(id);
+    if(it == m_watches.end()) continue;
+
+    const auto name = QString::fromStdWString(it->second.path);
+    flushPending(id, false);
+    m_watches.erase(it);
+
+    emit error(tr("Monitor of '%1': %2").arg(name).arg(message));
+  }
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::rescanFiles(Directory &directory)
+{
+  // the new name of a pending rename may have been lost.
+  directory.renaming.clear();
+
+  for(const auto &files: directory.files)
+  {
+    for(const auto id: files.second)
+    {
+      auto it = m_watches.find(id);
+      if(it == m_watches.end()) continue;
+
+      it->second.isRename = false;
+
+      // reported on the object itself, the lost changes are recovered from the snapshot.
+      deliver(id, it->second.path, std::wstring_view(), Events::LOST, 1);
+    }
+  }
+
+  if(!directory.snapshot) return;
+
+  auto notify = [this, &directory](const std::wstring &name, const Events e, const Properties properties)
+  {
+    dispatchFiles(directory, name, e, properties);
+  };
+
+  QString errorString;
+  if(!directory.snapshot->rescan(notify, errorString))
+  {
+    const auto name = QString::fromStdWString(directory.path.wstring());
+    emit error(tr("Monitor of '%1': %2").arg(name).arg(errorString));
+  }
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::rescan(Watch &watch)
+{
+  // the changes lost before the current read ends are found by another rescan.
+  if(watch.reading)
+  {
+    watch.lost = true;
+    return;
+  }
+
+  // the changes lost before a deferred snapshot is read are only told by the LOST event.
+  if(!watch.snapshot && !watch.deferred) return;
+
+  // the ignore files may have changed too.
+  if(watch.gitIgnore) watch.gitIgnore->clear();
+
+  readSnapshot(watch);
 }
 
 //-----------------------------------------------------------------------------
-bool WatchThread::processEvent(const std::wstring &name, const Events &e)
+void WatchThread::notify(const Watch &watch, std::wstring_view object, const Events e, const Properties properties)
 {
-  if(std::filesystem::is_directory(m_object))
+  if(watch.window == 0)
+  {
+    deliver(watch.id, object, std::wstring_view(), e, 1, properties);
+    return;
+  }
+
+  pendingKey(watch.id, object, e, m_key);
+
+  const auto it = m_pendingIndex.find(m_key);
+  if(it != m_pendingIndex.end())
+  {
+    auto &pending = it->second->second;
+    ++pending.count;
+    pending.properties |= properties;
+    return;
+  }
+
+  // the same deadlines keep the arrival order.
+  const auto deadline = Clock::now() + std::chrono::milliseconds(watch.window);
+  const auto added = m_pending.emplace(deadline, Pending{watch.id, std::wstring(object), e, 1, properties});
+  m_pendingIndex.emplace(m_key, added);
+  ++m_pendingCount[watch.id];
+}
+
+//-----------------------------------------------------------------------------
+int WatchThread::notifyPending()
+{
+  if(m_pending.empty()) return -1;
+
+  // only the events whose window ended are visited.
+  const auto now = Clock::now();
+  auto it = m_pending.begin();
+  while(it != m_pending.end() && it->first <= now) it = removePending(it, false);
+
+  if(m_pending.empty()) return -1;
+
+  // rounded up, a zero timeout would spin until the deadline.
+  const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(m_pending.begin()->first - now).count() + 1;
+  return static_cast<int>(wait);
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::flushPending(const ObjectId id, bool discard)
+{
+  if(m_pendingCount.find(id) == m_pendingCount.end()) return;
+
+  auto it = m_pending.begin();
+  while(it != m_pending.end())
+  {
+    if(it->second.id == id) it = removePending(it, discard);
+    else                    ++it;
+  }
+}
+
+//-----------------------------------------------------------------------------
+WatchThread::PendingEvents::iterator WatchThread::removePending(PendingEvents::iterator it, bool discard)
+{
+  const auto &pending = it->second;
+  if(!discard) deliver(pending.id, pending.object, std::wstring_view(), pending.event, pending.count, pending.properties);
+
+  pendingKey(pending.id, pending.object, pending.event, m_key);
+  m_pendingIndex.erase(m_key);
+
+  const auto count = m_pendingCount.find(pending.id);
+  if(--count->second == 0) m_pendingCount.erase(count);
+
+  return m_pending.erase(it);
+}
+
+//-----------------------------------------------------------------------------
+bool WatchThread::checkContents(Watch &watch, std::wstring_view object, const Events e, const Properties properties)
+{
+  if(e != Events::MODIFIED)
+  {
+    // a new or removed file has no previous contents to compare with.
+    watch.hashes.erase(std::wstring(object));
+    return false;
+  }
+
+  watch.hashes[std::wstring(object)].properties |= properties;
+
+  hashContents(watch, object, true);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::hashContents(Watch &watch, std::wstring_view object, const bool notifyChange)
+{
+  auto &contents = watch.hashes[std::wstring(object)];
+  if(contents.hashing)
+  {
+    contents.modified = true;
+    return;
+  }
+
+  contents.hashing = true;
+
+  const auto id = watch.id;
+  auto hashFile = [this, id, path = std::wstring(object), notifyChange]()
+  {
+    uint64_t hash = 0;
+    QString errorString;
+    const bool success = ContentHash::hashFile(path, hash, errorString);
+
+    // a directory has no contents to read, only a failed read can be one.
+    std::error_code error;
+    const bool isDirectory = !success && std::filesystem::is_directory(path, error);
+
+    post([this, id, path, notifyChange, success, isDirectory, hash]() { onHashed(id, path, notifyChange, success, isDirectory, hash); });
+  };
+  m_hashPool.start(hashFile);
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::onHashed(const ObjectId id, const std::wstring &object, const bool notifyChange, const bool success, const bool isDirectory, const uint64_t hash)
+{
+  const auto it = m_watches.find(id);
+  if(it == m_watches.end()) return;
+
+  auto &watch = it->second;
+
+  // the file was removed or renamed meanwhile, the result is outdated.
+  const auto found = watch.hashes.find(object);
+  if(found == watch.hashes.end() || !found->second.hashing) return;
+
+  // the modification of a directory is a change of its entries, notified as their own events.
+  if(isDirectory)
+  {
+    watch.hashes.erase(found);
+    return;
+  }
+
+  auto &contents = found->second;
+  const bool changed = !success || !contents.known || contents.hash != hash;
+
+  contents.hash = hash;
+  contents.known = success;
+  contents.hashing = false;
+
+  // unreadable contents can't be compared, the modification is notified.
+  if(notifyChange && changed) notify(watch, object, Events::MODIFIED, contents.properties);
+  if(notifyChange) contents.properties = Properties::NONE;
+
+  if(contents.modified)
+  {
+    contents.modified = false;
+    hashContents(watch, object, true);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::hashTree(const Watch &watch)
+{
+  const auto id = watch.id;
+  auto hashFiles = [this, id, root = watch.object, recursive = watch.recursive]()
+  {
+    std::vector<std::pair<std::wstring, uint64_t>> hashes;
+
+    std::error_code error;
+    const auto options = std::filesystem::directory_options::skip_permission_denied;
+    const std::filesystem::recursive_directory_iterator end;
+    for(std::filesystem::recursive_directory_iterator it{root, options, error}; !error && it != end; it.increment(error))
+    {
+      if(!recursive) it.disable_recursion_pending();
+
+      std::error_code typeError;
+      if(!it->is_regular_file(typeError)) continue;
+
+      // an unreadable file is left unknown, its first modification is notified.
+      uint64_t hash = 0;
+      QString errorString;
+      if(ContentHash::hashFile(it->path(), hash, errorString)) hashes.emplace_back(it->path().lexically_relative(root).wstring(), hash);
+    }
+
+    post([this, id, hashes = std::move(hashes)]() { onTreeHashed(id, hashes); });
+  };
+  m_hashPool.start(hashFiles);
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::onTreeHashed(const ObjectId id, const std::vector<std::pair<std::wstring, uint64_t>> &hashes)
+{
+  const auto it = m_watches.find(id);
+  if(it == m_watches.end()) return;
+
+  auto &watch = it->second;
+  for(const auto &[name, hash]: hashes)
+  {
+    if(!isIncluded(watch, name)) continue;
+
+    // a file changed meanwhile has its own hash, newer than this one.
+    watch.hashes.emplace(std::wstring(childPath(watch, name)), Contents{hash, true, false, false, Properties::NONE});
+  }
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::moveContents(Watch &watch, std::wstring_view from, std::wstring_view to)
+{
+  auto node = watch.hashes.extract(std::wstring(from));
+  if(node.empty()) return;
+
+  node.key() = to;
+  watch.hashes.erase(node.key());
+
+  // the result of a hash in progress will be discarded, it's hashed again with the new name.
+  const bool hashing = node.mapped().hashing;
+  node.mapped().hashing = false;
+  node.mapped().modified = false;
+
+  watch.hashes.insert(std::move(node));
+
+  if(hashing) hashContents(watch, to, true);
+}
+
+//-----------------------------------------------------------------------------
+void WatchThread::pendingKey(const ObjectId id, std::wstring_view object, const Events e, std::wstring &key)
+{
+  // the identifier takes a fixed number of characters, 16 bits each to fit any wchar_t.
+  key.clear();
+  for(size_t shift = 0; shift < sizeof(ObjectId) * 8; shift += 16) key.push_back(static_cast<wchar_t>((id >> shift) & 0xFFFF));
+
+  key.push_back(static_cast<wchar_t>(e));
+  key.append(object);
+}
+
+//-----------------------------------------------------------------------------
+std::wstring_view WatchThread::childPath(const Watch &watch, std::wstring_view name)
+{
+  m_path.assign(watch.path);
+  if(!m_path.empty() && m_path.back() != std::filesystem::path::preferred_separator) m_path.push_back(std::filesystem::path::preferred_separator);
+  m_path.append(name);
+
+  return m_path;
+}
+
+//-----------------------------------------------------------------------------
+bool WatchThread::processEvent(Watch &watch, std::wstring_view name, const Events &e, const Properties properties)
+{
+  // only the modifications of the watched properties, the unknown ones have all of them.
+  if(e == Events::MODIFIED && (properties & watch.properties) == Properties::NONE) return true;
+
+  // the other properties are not watched, their changes are only seen when a watched one changes.
+  const auto changed = properties == Properties::ALL ? properties : properties & watch.properties;
+
+  if(watch.isDirectory)
   {
     switch(e)
     {
       case Events::RENAMED_NEW:
-        emit renamed(m_oldName, m_object.wstring() + L"\\" + name);
+        {
+          // a rename across the filter is the creation or the removal of the filtered path.
+          const bool included = isIncluded(watch, name);
+          if(watch.oldIncluded && included)
+          {
+            flushPending(watch.id, false);
+            if(watch.contents) moveContents(watch, watch.oldName, childPath(watch, name));
+            deliver(watch.id, childPath(watch, name), watch.oldName, Events::RENAMED_NEW, 1);
+          }
+          else if(included)
+          {
+            if(watch.contents) checkContents(watch, childPath(watch, name), Events::ADDED, Properties::ALL);
+            if((watch.events & Events::ADDED) != Events::NONE) notify(watch, childPath(watch, name), Events::ADDED, Properties::ALL);
+          }
+          else if(watch.oldIncluded)
+          {
+            if(watch.contents) checkContents(watch, watch.oldName, Events::REMOVED, Properties::ALL);
+            if((watch.events & Events::REMOVED) != Events::NONE) notify(watch, watch.oldName, Events::REMOVED, Properties::ALL);
+          }
+        }
         break;
       case Events::RENAMED_OLD:
-        m_oldName = m_object.wstring() + L"\\" + name;
+        watch.oldName.assign(childPath(watch, name));
+        watch.oldIncluded = isIncluded(watch, name);
         break;
       case Events::NONE:
         return false;
         break;
       default:
-        emit modified(m_object.wstring() + L"\\" + name, e);
+        if(!watch.contents || !checkContents(watch, childPath(watch, name), e, changed)) notify(watch, childPath(watch, name), e, changed);
         break;
     }
 
@@ -210,33 +1170,32 @@ bool WatchThread::processEvent(const std::wstring &name, const Events &e)
   }
   else
   {
-    auto filename = m_object.filename().wstring();
-    std::for_each(filename.begin(), filename.end(), std::towlower);
-    auto changedFilename = name;
-    std::for_each(changedFilename.begin(), changedFilename.end(), std::towlower);
-
-    if(changedFilename.compare(filename) == 0 || m_isRename)
+    if(name == watch.filename || watch.isRename)
     {
       switch(e)
       {
         case Events::RENAMED_NEW:
-          if(m_isRename)
+          if(watch.isRename)
           {
-            const auto oldFilename = m_object.wstring();
-            m_object = std::filesystem::path{m_object.parent_path().wstring() + L"\\" + name};
-            emit renamed(oldFilename, m_object.wstring());
-            m_isRename = false;
+            flushPending(watch.id, false);
+            const auto oldFilename = watch.path;
+            watch.object = watch.object.parent_path() / name;
+            watch.path = watch.object.wstring();
+            watch.filename = watch.object.filename().wstring();
+            if(watch.contents) moveContents(watch, oldFilename, watch.path);
+            deliver(watch.id, watch.path, oldFilename, Events::RENAMED_NEW, 1);
+            watch.isRename = false;
           }
           break;
         case Events::RENAMED_OLD:
-          // update m_object with the new name the next event.
-          m_isRename = true;
+          // update the object with the new name the next event.
+          watch.isRename = true;
           break;
         case Events::NONE:
           return false;
           break;
         default:
-          emit modified(m_object.wstring(), e);
+          if(!watch.contents || !checkContents(watch, watch.path, e, changed)) notify(watch, watch.path, e, changed);
           break;
       }
 
@@ -20,144 +20,602 @@
 #ifndef WATCHTHREAD_H_
 #define WATCHTHREAD_H_
 
+// Project
+#include <DirectorySnapshot.h>
+#include <EventBatch.h>
+#include <EventJournal.h>
+#include <EventRing.h>
+#include <Events.h>
+#include <GitIgnore.h>
+#include <PathFilter.h>
+#include <WatchBackend.h>
+
 // Qt
 #include <QThread>
+#include <QThreadPool>
+#include <QMutex>
 
 // C++
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
-#include <minwindef.h>
-#include <synchapi.h>
-#include <vector>
+#include <functional>
 #include <map>
-#include <type_traits>
-
-enum class Events: char
-{
-  NONE        = 0,
-  ADDED       = 0b00000001,
-  REMOVED     = 0b00000010,
-  MODIFIED    = 0b00000100,
-  RENAMED_OLD = 0b00001000,
-  RENAMED_NEW = 0b00010000,
-  RECURSIVE   = 0b00100000 /** added by me for UI reasons, not in the api. */
-};
-
-inline Events operator|(Events lhs, Events rhs)
-{ return static_cast<Events>(static_cast<std::underlying_type_t<Events>>(lhs)|static_cast<std::underlying_type_t<Events>>(rhs)); }
-
-inline Events operator&(Events lhs, Events rhs)
-{ return static_cast<Events>(static_cast<std::underlying_type_t<Events>>(lhs)&static_cast<std::underlying_type_t<Events>>(rhs)); }
-
-inline Events operator|=(Events &lhs, Events rhs)
-{ lhs = lhs|rhs; return lhs; }
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 /** \class WatchThread
- * \brief Thread wathing objects.
+ * \brief Thread watching objects. A single thread waits for the changes of all the watched objects
+ * with the operating system backend and queues them, stamped, for the consumer to drain.
  *
  */
 class WatchThread
 : public QThread
+, private WatchBackend::Listener
 {
     Q_OBJECT
   public:
+    using ObjectId = WatchBackend::WatchId;
+
+    static constexpr size_t DEFAULT_QUEUE_CAPACITY = 65536; /** default maximum number of queued changes. */
+
+    /** \struct ObjectParameters
+     * \brief Parameters of an object to watch, see addObject().
+     *
+     */
+    struct ObjectParameters
+    {
+      std::filesystem::path object;     /** path of the object to watch.                          */
+      Events                events;     /** events to watch.                                      */
+      bool                  recursive;  /** true to monitor the directory subtree.                */
+      unsigned int          window;     /** time in milliseconds to merge repeated events.        */
+      bool                  contents;   /** true to only notify modifications of the contents.    */
+      Properties            properties; /** properties whose modifications are notified.          */
+      PathFilter            filter;     /** paths inside a directory whose changes are notified.  */
+      bool                  gitIgnore;  /** true to not notify the changes of the ignored paths.  */
+    };
 
     /** \brief WatchThread class constructor.
-     * \param[in] object Path of the object to watch.
-     * \param[in] properties Events to watch.
      * \param[in] p Raw pointer of the object parent of this one.
+     *
+     */
+    explicit WatchThread(QObject *p = nullptr);
+
+    /** \brief WatchThread class virtual destructor. Stops the thread.
+     *
+     */
+    virtual ~WatchThread();
+
+    /** \brief Starts watching the given object and returns its identifier. The watch is added
+     * asynchronously and any error is reported with the error signal. Can be called from any thread.
+     * \param[in] object Path of the object to watch.
+     * \param[in] events Events to watch.
      * \param[in] recursive True to monitor the directory subtree, false to only monitor the directory files.
+     * \param[in] window Time in milliseconds to merge the repeated events of the same file, 0 to notify every event.
+     * \param[in] contents True to only notify the modifications that change the contents of the files.
+     * \param[in] properties Properties whose modifications are notified.
+     * \param[in] filter Filter of the paths inside a directory whose changes are notified.
+     * \param[in] gitIgnore True to not notify the changes of the paths of a directory ignored by its '.gitignore' files.
+     *
+     */
+    ObjectId addObject(const std::filesystem::path &object, const Events events, bool recursive = false, const unsigned int window = 0,
+                       const bool contents = false, const Properties properties = Properties::ALL, const PathFilter &filter = PathFilter(),
+                       const bool gitIgnore = false);
+
+    /** \brief Starts watching the given objects and returns their identifiers in the same order. The
+     * watches are added at once and the initial states of the directories are read in parallel, so
+     * it's faster than adding them one by one. Any error is reported with the error signal. Can be
+     * called from any thread.
+     * \param[in] objects Parameters of the objects to watch.
      *
      */
-    explicit WatchThread(const std::filesystem::path &object, const Events events, bool recursive = false, QObject *p = nullptr);
+    std::vector<ObjectId> addObjects(const std::vector<ObjectParameters> &objects);
 
-    /** \brief WatchThread class virtual destructor.
+    /** \brief Stops watching the object with the given identifier. Can be called from any thread.
+     * \param[in] id Object identifier.
      *
      */
-    virtual ~WatchThread()
-    {};
+    void removeObject(const ObjectId id);
 
     /** \brief Aborts the thread.
      *
      */
     void abort();
 
+    /** \brief Replaces the queue of the changes. Must be called before the thread starts.
+     * \param[in] capacity Maximum number of queued changes.
+     * \param[in] overflow Policy when the queue is full.
+     *
+     */
+    void setQueue(const size_t capacity, const EventRing::Overflow overflow);
+
+    /** \brief Moves the queued changes to the batch and the changes collapsed when the queue was full
+     * to the summaries, the key of a summary is the identifier of its object. Returns true if there
+     * were changes and false otherwise. Must be called from a single thread.
+     * \param[out] batch Queued changes in order.
+     * \param[out] summaries Collapsed changes of the objects.
+     *
+     */
+    bool drain(EventBatch &batch, std::vector<EventRing::Summary> &summaries);
+
+    /** \brief Sets the journal recording the changes, nullptr for none. Must be called before the
+     * thread starts, the journal must outlive the thread.
+     * \param[in] journal Raw pointer of the journal.
+     *
+     */
+    void setJournal(EventJournal *journal);
+
+    /** \brief Returns the queue of the changes, to read its counters.
+     *
+     */
+    const EventRing &queue() const
+    { return *m_queue; }
+
+    /** \brief Returns the queue of the changes, to queue changes that didn't happen in the
+     * filesystem, like the replayed ones.
+     *
+     */
+    EventRing &queue()
+    { return *m_queue; }
+
   signals:
     void renamed(const std::wstring oldName, const std::wstring newName);
-    void modified(const std::wstring obj, const Events event);
+    void modified(const std::wstring obj, const Events event, const unsigned long count);
     void error(const QString message);
 
   protected:
     virtual void run() override;
 
   private:
-    /** Maps the changes with the corresponding event.
+    /** \struct Contents
+     * \brief Hash of the contents of a file of an object that only notifies the content changes.
+     *
+     */
+    struct Contents
+    {
+      uint64_t   hash;       /** hash of the contents when last read.               */
+      bool       known;      /** true if the hash is valid, false if never read.    */
+      bool       hashing;    /** true while the contents are being hashed.          */
+      bool       modified;   /** true if modified while hashing, to hash it again.  */
+      Properties properties; /** changed properties of the modifications to notify. */
+    };
+
+    using Change = std::pair<std::wstring, Events>;
+
+    /** \struct Watch
+     * \brief Data of a watched object.
+     *
+     */
+    struct Watch
+    {
+      ObjectId                                   id;          /** object identifier.                                      */
+      std::filesystem::path                      object;      /** path of the object to watch.                            */
+      std::wstring                               path;        /** path of the object as a string.                         */
+      std::wstring                               filename;    /** file name of the object.                                */
+      Events                                     events;      /** events to watch.                                        */
+      bool                                       isDirectory; /** True if the object is a directory, false if its a file. */
+      std::wstring                               oldName;     /** old name in case of a rename event.                     */
+      bool                                       oldIncluded; /** True if the old name of a rename passes the filter.     */
+      bool                                       isRename;    /** True when a rename event is received with the old name
+                                                                  to signal that the next event will rename the object.   */
+      bool                                       recursive;   /** True to monitor the directory subtree and false to
+                                                                  monitor only the files in the directory.                */
+      unsigned int                               window;      /** time in milliseconds to merge repeated events.          */
+      std::shared_ptr<DirectorySnapshot>         snapshot;    /** state of the watched directory to recover lost changes,
+                                                                  null if it can't be read, is deferred or being read.    */
+      bool                                       deferred;    /** true if the snapshot is only read once changes are lost,
+                                                                  for filesystem watches that cost the same for any tree. */
+      std::shared_ptr<DirectorySnapshot>         reading;     /** snapshot being read or rescanned in the scanning pool.  */
+      std::vector<Change>                        missed;      /** changes notified while reading the snapshot.            */
+      bool                                       lost;        /** true if changes were lost while reading the snapshot,
+                                                                  to rescan it again once read.                           */
+      WatchBackend::WatchId                      directory;   /** shared watch of the directory of a file object.         */
+      bool                                       contents;    /** true to only notify modifications of the contents.      */
+      Properties                                 properties;  /** properties whose modifications are notified.            */
+      std::unordered_map<std::wstring, Contents> hashes;      /** path of a modified file to its contents hash.           */
+      PathFilter                                 filter;      /** paths inside the directory whose changes are notified.  */
+      std::shared_ptr<GitIgnore>                 gitIgnore;   /** rules of the ignored paths inside the directory, null
+                                                                  to notify the changes of all of them.                   */
+    };
+
+    /** \struct Directory
+     * \brief Watch of a directory shared by the watched files inside it.
+     *
+     */
+    struct Directory
+    {
+      WatchBackend::WatchId                             id;         /** backend watch identifier.                       */
+      std::filesystem::path                             path;       /** path of the directory.                          */
+      Events                                            events;     /** events reported, the ones of all the files.     */
+      Properties                                        properties; /** modified properties reported.                   */
+      std::unordered_map<size_t, std::vector<ObjectId>> files;      /** hash of a file name to the objects of the files
+                                                                        with that hash.                                  */
+      std::vector<ObjectId>                             renaming;   /** objects that get the name of the next change.   */
+      std::shared_ptr<DirectorySnapshot>                snapshot;   /** state of the directory to recover lost changes,
+                                                                        null if it couldn't be read.                     */
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    /** \struct Pending
+     * \brief An event waiting for the end of its window to be notified.
+     *
+     */
+    struct Pending
+    {
+      ObjectId      id;         /** identifier of the watched object.        */
+      std::wstring  object;     /** path of the changed object.              */
+      Events        event;      /** event.                                   */
+      unsigned long count;      /** number of merged events.                 */
+      Properties    properties; /** changed properties of the merged events. */
+    };
+
+    using PendingEvents = std::multimap<Clock::time_point, Pending>;                /** pending events by deadline. */
+    using PendingIndex  = std::unordered_map<std::wstring, PendingEvents::iterator>; /** key to pending event.       */
+
+    /** \struct Difference
+     * \brief A change found by a rescan in the scanning pool.
+     *
+     */
+    struct Difference
+    {
+      std::wstring name;       /** name of the changed entry relative to the directory. */
+      Events       event;      /** event.                                               */
+      Properties   properties; /** changed properties if it's a modification.           */
+    };
+
+    /** \struct Modification
+     * \brief A modification waiting for the refresh of its snapshot.
      *
-     *  From https://docs.microsoft.com/en-us/windows/win32/api/winnt/ns-winnt-file_notify_information                 */
-    const std::map<DWORD, Events> eventMapping =
+     */
+    struct Modification
     {
-      { FILE_ACTION_ADDED,            Events::ADDED },        /** The file was added to the directory.                  */
-      { FILE_ACTION_REMOVED,          Events::REMOVED },      /** The file was removed from the directory.              */
-      { FILE_ACTION_MODIFIED,         Events::MODIFIED },     /** The file was modified. This can be a change in the
-                                                                 time stamp or attributes.                             */
-      { FILE_ACTION_RENAMED_OLD_NAME, Events::RENAMED_OLD },  /** The file was renamed and this is the old name.        */
-      { FILE_ACTION_RENAMED_NEW_NAME, Events::RENAMED_NEW }   /** The file was renamed and this is the new name.        */
+      WatchBackend::WatchId id;     /** backend watch identifier.                 */
+      size_t                name;   /** position of the name in the names buffer. */
+      size_t                length; /** length of the name.                       */
     };
 
-    /** Properties to watch on a file or directory object. Only last access and creation applies to a directory. The
-     * rest applies for both.
-     *
-     * From https://docs.microsoft.com/en-us/windows/win32/api/winbase/nf-winbase-readdirectorychangesw
-     * Retrieves information that describes the changes within the specified directory. The function does not report
-     * changes to the specified directory itself.                                                                      */
-    const DWORD watchProperties =
-      FILE_NOTIFY_CHANGE_FILE_NAME   |/** Any file name change in the watched directory or subtree causes a change
-                                        *  notification wait operation to return. Changes include renaming, creating,
-                                        *  or deleting a file.                                                         */
-      FILE_NOTIFY_CHANGE_DIR_NAME    | /** Any directory-name change in the watched directory or subtree causes a
-                                        *  change notification wait operation to return. Changes include creating or
-                                        *  deleting a directory.                                                       */
-      FILE_NOTIFY_CHANGE_ATTRIBUTES  | /** Any attribute change in the watched directory or subtree causes a change
-                                        *  notification wait operation to return.                                      */
-      FILE_NOTIFY_CHANGE_SIZE        | /** Any file-size change in the watched directory or subtree causes a change
-                                        *  notification wait operation to return. The operating system detects a change
-                                        *  in file size only when the file is written to the disk. For operating systems
-                                        *  that use extensive caching, detection occurs only when the cache is
-                                        *  sufficiently flushed.                                                       */
-      FILE_NOTIFY_CHANGE_LAST_WRITE  | /** Any change to the last write-time of files in the watched directory or
-                                        *  subtree causes a change notification wait operation to return. The operating
-                                        *  system detects a change to the last write-time only when the file is written
-                                        *  to the disk. For operating systems that use extensive caching, detection
-                                        *  occurs only when the cache is sufficiently flushed.                         */
-      FILE_NOTIFY_CHANGE_LAST_ACCESS | /** Any change to the last access time of files in the watched directory or
-                                        *  subtree causes a change notification wait operation to return.              */
-      FILE_NOTIFY_CHANGE_CREATION    | /** Any change to the creation time of files in the watched directory or
-                                        *  subtree causes a change notification wait operation to return.              */
-      FILE_NOTIFY_CHANGE_SECURITY;     /** Any security-descriptor change in the watched directory or subtree causes a
-                                        *  change notification wait operation to return.                               */
-
-    /** \brief Helper method to get the string of the given Win32 API error.
-     * \param[in] errorCode Win32 API error code.
-     *
-     */
-    static QString getLastErrorString(const DWORD errorCode);
+    virtual void onChange(const WatchBackend::WatchId id, std::wstring_view name, const Events e) override;
+
+    virtual void onOverflow(const WatchBackend::WatchId id) override;
+
+    virtual void onError(const WatchBackend::WatchId id, const QString &message) override;
+
+    /** \brief Queues the command to be executed in the thread and wakes it up.
+     * \param[in] command Command to execute.
+     *
+     */
+    void post(std::function<void()> command);
+
+    /** \brief Executes the queued commands.
+     *
+     */
+    void executeCommands();
+
+    /** \brief Returns the data of a new watched object.
+     * \param[in] id Object identifier.
+     * \param[in] object Parameters of the object.
+     *
+     */
+    static Watch createWatch(const ObjectId id, const ObjectParameters &object);
+
+    /** \brief Starts watching the objects and reads the initial state of their directories in parallel.
+     * \param[in] watches Watched objects data.
+     *
+     */
+    void addWatches(std::vector<Watch> &watches);
+
+    /** \brief Reads the initial state of the given directories in the scanning pool and this thread,
+     * waiting only for the ones the pool is reading. The snapshots that can't be read are set to null.
+     * \param[in] snapshots Snapshots to scan.
+     *
+     */
+    void scanSnapshots(const std::vector<std::shared_ptr<DirectorySnapshot> *> &snapshots);
+
+    /** \brief Starts watching a file object using the shared watch of its directory, that is created if
+     * it's the first file watched in the directory. Returns the shared directory watch, or null on
+     * failure. The events of the directory watch must be updated after.
+     * \param[in] watch Watched object data.
+     * \param[out] snapshots Snapshot of the new directory watch, if created, to scan.
+     *
+     */
+    Directory *addFile(Watch watch, std::vector<std::shared_ptr<DirectorySnapshot> *> &snapshots);
+
+    /** \brief Stops watching a file object. The shared watch of its directory is removed if it was the
+     * last file watched in the directory.
+     * \param[in] watch Watched object data.
+     *
+     */
+    void removeFile(const Watch &watch);
+
+    /** \brief Makes the shared watch of the directory report the changes needed by all its files.
+     * \param[in] directory Shared directory watch data.
+     *
+     */
+    void updateFilter(Directory &directory);
+
+    /** \brief Returns the properties whose modifications the backend must report for the object. The
+     * contents only change with the size or the write time.
+     * \param[in] watch Watched object data.
+     *
+     */
+    static Properties watchedProperties(const Watch &watch);
+
+    /** \brief Notifies the change to the file objects with the changed name and to the ones being renamed.
+     * \param[in] directory Shared directory watch data.
+     * \param[in] name Name of the changed object relative to the directory.
+     * \param[in] e Event.
+     * \param[in] properties Changed properties if it's a modification.
+     *
+     */
+    void dispatchFiles(Directory &directory, std::wstring_view name, const Events e, const Properties properties);
+
+    /** \brief Watches the directory again after a failure and notifies the changes since the last known state
+     * to its files. Reports the error to every file if the directory can't be watched again.
+     * \param[in] directory Shared directory watch data.
+     * \param[in] message Error message of the failure.
+     *
+     */
+    void recoverFiles(Directory &directory, const QString &message);
+
+    /** \brief Notifies the file objects of the directory that changes were lost and notifies the changes
+     * since the last known state.
+     * \param[in] directory Shared directory watch data.
+     *
+     */
+    void rescanFiles(Directory &directory);
+
+    /** \brief Rescans the snapshot of the watch in the scanning pool, or reads it if deferred and not yet
+     * read. The snapshot is detached from the watch meanwhile, the changes notified in the meantime update
+     * it once done.
+     * \param[in] watch Watched object data.
+     *
+     */
+    void readSnapshot(Watch &watch);
+
+    /** \brief Notifies the differences found by the scanning pool and sets the snapshot as the one of the
+     * watch, if still waiting for it.
+     * \param[in] id Object identifier.
+     * \param[in] snapshot Read or rescanned snapshot.
+     * \param[in] rescanned True if the snapshot was rescanned, false if read for the first time.
+     * \param[in] success True if the snapshot was read and false otherwise.
+     * \param[in] message Error message in case of failure.
+     * \param[in] differences Changes found by the rescan.
+     *
+     */
+    void onSnapshotRead(const ObjectId id, const std::shared_ptr<DirectorySnapshot> &snapshot, const bool rescanned, const bool success,
+                        const QString &message, const std::vector<Difference> &differences);
+
+    /** \brief Returns true if some object of the given backend watch doesn't watch the modifications of all
+     * the properties, and needs the snapshot to tell the changed ones.
+     * \param[in] id Backend watch identifier.
+     *
+     */
+    bool needsChanges(const WatchBackend::WatchId id) const;
+
+    /** \brief Returns the snapshot of the given backend watch, null if none.
+     * \param[in] id Backend watch identifier.
+     *
+     */
+    std::shared_ptr<DirectorySnapshot> findSnapshot(const WatchBackend::WatchId id) const;
+
+    /** \brief Refreshes the snapshots and dispatches the waiting modifications with their changed properties.
+     *
+     */
+    void flushModifications();
+
+    /** \brief Updates the snapshot with a notified change and remembers it if it has to be refreshed.
+     * \param[in] snapshot Snapshot of the watched directory, can be null.
+     * \param[in] name Name of the changed object relative to the watched directory.
+     * \param[in] e Event.
+     * \param[in] read True to read a modified entry to tell its changed properties, false to only forget its data.
+     *
+     */
+    void updateSnapshot(const std::shared_ptr<DirectorySnapshot> &snapshot, std::wstring_view name, const Events e, const bool read);
+
+    /** \brief Reads again the entries changed since the last wait in the snapshots that have them.
+     *
+     */
+    void refreshSnapshots();
+
+    /** \brief Notifies the event if it's one of the watched events of the object.
+     * \param[in] watch Watched object data.
+     * \param[in] name Name of the changed object relative to the watched directory.
+     * \param[in] e Event.
+     * \param[in] properties Changed properties if it's a modification.
+     *
+     */
+    void dispatch(Watch &watch, std::wstring_view name, const Events e, const Properties properties);
+
+    /** \brief Returns true if the change is of a path excluded by the filter of the watched directory.
+     * Renames are never filtered here, only once both names are known. Forgets the ignore rules the
+     * change may modify.
+     * \param[in] id Backend watch identifier.
+     * \param[in] name Name of the changed object relative to the watched directory.
+     * \param[in] e Event.
+     *
+     */
+    bool isFiltered(const WatchBackend::WatchId id, std::wstring_view name, const Events e) const;
+
+    /** \brief Returns true if the changes of the path must be notified, false if excluded by the filter
+     * or ignored.
+     * \param[in] watch Watched object data.
+     * \param[in] name Name of the changed object relative to the watched directory.
+     *
+     */
+    static bool isIncluded(const Watch &watch, std::wstring_view name);
+
+    /** \brief Scans the watched directory again in the scanning pool and notifies the changes since the
+     * last known state once done.
+     * \param[in] watch Watched object data.
+     *
+     */
+    void rescan(Watch &watch);
+
+    /** \brief Watches the directory of the object again after a failure and notifies the changes
+     * since the last known state. Reports the error if the object can't be watched again.
+     * \param[in] id Object identifier.
+     * \param[in] message Error message of the failure.
+     *
+     */
+    void recover(const ObjectId id, const QString &message);
+
+    /** \brief Adds the event to the queue of changes and the journal. Emits the single event signals if connected.
+     * \param[in] id Object identifier.
+     * \param[in] object Path of the changed object, the new path if renamed.
+     * \param[in] oldName Old path of the object if renamed, empty otherwise.
+     * \param[in] e Event.
+     * \param[in] count Number of merged events.
+     * \param[in] properties Changed properties if it's a modification.
+     *
+     */
+    void deliver(const ObjectId id, std::wstring_view object, std::wstring_view oldName, const Events e, const unsigned long count,
+                 const Properties properties = Properties::ALL);
+
+    /** \brief Notifies the modification of the object, or merges it with the pending ones if the
+     * watched object has a window.
+     * \param[in] watch Watched object data.
+     * \param[in] object Path of the changed object.
+     * \param[in] e Event.
+     * \param[in] properties Changed properties if it's a modification.
+     *
+     */
+    void notify(const Watch &watch, std::wstring_view object, const Events e, const Properties properties);
+
+    /** \brief Notifies the pending events whose window has ended and returns the time to wait in
+     * milliseconds for the next one, or -1 if there are none.
+     *
+     */
+    int notifyPending();
+
+    /** \brief Notifies or discards the pending events of the given object.
+     * \param[in] id Object identifier.
+     * \param[in] discard True to discard the events, false to notify them.
+     *
+     */
+    void flushPending(const ObjectId id, bool discard);
+
+    /** \brief Notifies or discards the pending event and removes it. Returns the next pending event.
+     * \param[in] it Pending event.
+     * \param[in] discard True to discard the event, false to notify it.
+     *
+     */
+    PendingEvents::iterator removePending(PendingEvents::iterator it, bool discard);
+
+    /** \brief Hashes the contents of a file of an object that only notifies the content changes. Returns
+     * true if the event waits for the hash to be notified and false if it must be notified now.
+     * \param[in] watch Watched object data.
+     * \param[in] object Path of the changed file.
+     * \param[in] e Event.
+     * \param[in] properties Changed properties if it's a modification.
+     *
+     */
+    bool checkContents(Watch &watch, std::wstring_view object, const Events e, const Properties properties);
+
+    /** \brief Hashes the contents of the file in the pool of threads, or again after the current hash
+     * if it's being hashed.
+     * \param[in] watch Watched object data.
+     * \param[in] object Path of the file.
+     * \param[in] notifyChange True to notify a modification if the contents changed.
+     *
+     */
+    void hashContents(Watch &watch, std::wstring_view object, const bool notifyChange);
+
+    /** \brief Stores the hash of the contents of a file and notifies the modification if they changed.
+     * \param[in] id Object identifier.
+     * \param[in] object Path of the file.
+     * \param[in] notifyChange True to notify a modification if the contents changed.
+     * \param[in] success True if the file was read and false otherwise.
+     * \param[in] isDirectory True if the path is a directory, which has no contents to compare.
+     * \param[in] hash Hash of the contents of the file.
+     *
+     */
+    void onHashed(const ObjectId id, const std::wstring &object, const bool notifyChange, const bool success, const bool isDirectory, const uint64_t hash);
+
+    /** \brief Hashes the files of a directory object in the pool of threads, so the first modification
+     * of any of them is compared with the contents when the watch started.
+     * \param[in] watch Watched object data.
+     *
+     */
+    void hashTree(const Watch &watch);
+
+    /** \brief Stores the hashes of the files of a directory object, except the ones excluded by the
+     * filter or already hashed again after a change.
+     * \param[in] id Object identifier.
+     * \param[in] hashes Hashes of the files, by name relative to the directory.
+     *
+     */
+    void onTreeHashed(const ObjectId id, const std::vector<std::pair<std::wstring, uint64_t>> &hashes);
+
+    /** \brief Keeps the contents hash of a renamed file.
+     * \param[in] watch Watched object data.
+     * \param[in] from Old path of the file.
+     * \param[in] to New path of the file.
+     *
+     */
+    void moveContents(Watch &watch, std::wstring_view from, std::wstring_view to);
+
+    /** \brief Builds the key of the given modification in the pending events index, the same change of
+     * nested objects is merged separately for each of them.
+     * \param[in] id Object identifier.
+     * \param[in] object Path of the changed object.
+     * \param[in] e Event.
+     * \param[out] key Key of the modification.
+     *
+     */
+    static void pendingKey(const ObjectId id, std::wstring_view object, const Events e, std::wstring &key);
+
+    /** \brief Returns the path of the changed object inside the watched directory. The view is valid until
+     * the next call.
+     * \param[in] watch Watched object data.
+     * \param[in] name Name of the changed object relative to the watched directory.
+     *
+     */
+    std::wstring_view childPath(const Watch &watch, std::wstring_view name);
 
     /** \brief Processes the event for the 'name' object. Returns true on success and
      *  false otherwise. Event is not a composition of flags, just an individual event.
+     * \param[in] watch Watched object data.
      * \param[in] name Name given in the event information struct.
      * \param[in] e Event.
+     * \param[in] properties Changed properties if it's a modification.
      *
      */
-    bool processEvent(const std::wstring &name, const Events &e);
+    bool processEvent(Watch &watch, std::wstring_view name, const Events &e, const Properties properties);
+
+    std::unique_ptr<WatchBackend>                   m_backend;       /** operating system specific watcher.          */
+    QString                                         m_openError;     /** error opening the backend, if any.          */
+    std::map<ObjectId, Watch>                       m_watches;       /** watched objects, only used by the thread.   */
+    std::map<WatchBackend::WatchId, Directory>      m_directories;   /** shared watches of the directories of files,
+                                                                         routed to them by the hash of the name.       */
+    std::vector<ObjectId>                           m_dispatched;    /** objects of the last dispatched change.      */
+    std::vector<std::shared_ptr<DirectorySnapshot>> m_stale;         /** snapshots with entries to refresh.          */
+    std::vector<Modification>                       m_modifications; /** modifications waiting for the refresh of
+                                                                         their snapshots, once for all the batch.      */
+    std::wstring                                    m_modifiedNames; /** names of the waiting modifications.         */
+    PendingEvents                                   m_pending;       /** merged events by deadline, notified once at
+                                                                         the end of their window.                      */
+    PendingIndex                                    m_pendingIndex;  /** object, path and event to pending event.    */
+    std::unordered_map<ObjectId, size_t>            m_pendingCount;  /** object to its number of pending events.     */
+    std::unique_ptr<EventRing>                      m_queue;         /** changes not yet drained, bounded so a busy
+                                                                         consumer never makes the memory grow.         */
+    EventJournal                                   *m_journal;       /** journal recording the changes, if any.      */
+    std::wstring                                    m_path;          /** buffer of the last built changed path.      */
+    std::wstring                                    m_key;           /** buffer of the last built pending key.       */
+    QMutex                                          m_mutex;         /** protects the commands queue.                */
+    std::vector<std::function<void()>>              m_commands;      /** commands to execute in the thread.          */
+    std::atomic<ObjectId>                           m_nextId;        /** identifier of the next object or directory. */
+    std::atomic<bool>                               m_aborted;       /** true to stop the thread, false otherwise.   */
+    QThreadPool                                     m_hashPool;      /** threads hashing the contents of files, so
+                                                                         the thread never blocks reading them.         */
+    QThreadPool                                     m_scanPool;      /** threads reading the new snapshots.          */
 
-    std::filesystem::path m_object;      /** path of the object to watch.                            */
-    const Events          m_events;      /** events to watch.                                        */
-    HANDLE                m_stopHandle;  /** HANDLES to signal the thread to stop.                   */
-    bool                  m_isDirectory; /** True if the object is a directory, false if its a file. */
-    std::wstring          m_oldName;     /** old name in case of a rename event.                     */
-    bool                  m_isRename;    /** True when a rename event is received with the old name
-                                             to signal that the next event will rename m_object.     */
-    const bool            m_recursive;   /** True to monitor the directory subtree and false to
-                                             monitor only the files in the directory.                */
+    friend class WatchThreadBenchmark;
 };
 
 #endif // WATCHTHREAD_H_
@@ -0,0 +1,386 @@
+/*
+ File: Win32WatchBackend.cpp
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <Win32WatchBackend.h>
+
+// Qt
+#include <QObject>
+
+// C++
+#include <winapifamily.h>
+#include <shlwapi.h>
+#include <fileapi.h>
+#include <algorithm>
+#include <iterator>
+
+//-----------------------------------------------------------------------------
+Win32WatchBackend::Win32WatchBackend()
+: m_port{nullptr}
+{
+}
+
+//-----------------------------------------------------------------------------
+Win32WatchBackend::~Win32WatchBackend()
+{
+  while(!m_watches.empty()) closeWatch(m_watches.begin()->first);
+
+  // the buffers must remain valid until the cancelled reads complete.
+  while(m_port && !m_closing.empty())
+  {
+    DWORD bytes_returned = 0;
+    ULONG_PTR key = 0;
+    LPOVERLAPPED overlapped = nullptr;
+    if(!GetQueuedCompletionStatus(m_port, &bytes_returned, &key, &overlapped, 1000) && !overlapped) break;
+
+    m_closing.erase(reinterpret_cast<Watch *>(key));
+  }
+
+  if(m_port) CloseHandle(m_port);
+}
+
+//-----------------------------------------------------------------------------
+bool Win32WatchBackend::open(QString &error)
+{
+  m_port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+
+  if (!m_port)
+  {
+    const auto errorString = getLastErrorString(GetLastError());
+    error = QObject::tr("Unable to create completion port. Error: %1").arg(errorString);
+    return false;
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool Win32WatchBackend::addWatch(const WatchId id, const std::filesystem::path &directory, bool recursive,
+                                 const Events events, const Properties properties, QString &error)
+{
+  auto watch = createWatch(id, directory, recursive, notifyFilter(events, properties), INITIAL_BUFFER_SIZE, error);
+  if(!watch) return false;
+
+  m_watches.emplace(id, std::move(watch));
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool Win32WatchBackend::updateWatch(const WatchId id, const Events events, const Properties properties, QString &error)
+{
+  const auto it = m_watches.find(id);
+  if(it == m_watches.end()) return true;
+
+  const auto filter = notifyFilter(events, properties);
+  if(filter == it->second->filter) return true;
+
+  // the system keeps the filter of the first read for the lifetime of the handle, the new one is
+  // read with a new handle before closing the old one so no change is missed.
+  const auto &current = *it->second;
+  auto watch = createWatch(id, current.directory, current.recursive, filter, current.buffers[0].size(), error);
+  if(!watch) return false;
+
+  it->second->replaced = true;
+  closeWatch(id);
+
+  m_watches.emplace(id, std::move(watch));
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+std::unique_ptr<Win32WatchBackend::Watch> Win32WatchBackend::createWatch(const WatchId id, const std::filesystem::path &directory, bool recursive,
+                                                                         const DWORD filter, const size_t size, QString &error)
+{
+  auto watch = std::make_unique<Watch>();
+  watch->id = id;
+  watch->directory = directory;
+  watch->recursive = recursive;
+  watch->filter = filter;
+  watch->buffers[0].resize(size, 0);
+  watch->buffers[1].resize(size, 0);
+  watch->current = 0;
+  watch->replaced = false;
+  memset(&watch->overlapped, 0, sizeof(OVERLAPPED));
+
+  if(!openHandle(*watch, error)) return nullptr;
+
+  if(!read(*watch, error))
+  {
+    CloseHandle(watch->handle);
+    return nullptr;
+  }
+
+  return watch;
+}
+
+//-----------------------------------------------------------------------------
+bool Win32WatchBackend::openHandle(Watch &watch, QString &error)
+{
+  watch.handle = CreateFileW(watch.directory.wstring().c_str(),
+                             FILE_LIST_DIRECTORY,
+                             FILE_SHARE_READ | FILE_SHARE_DELETE | FILE_SHARE_WRITE,
+                             nullptr,
+                             OPEN_EXISTING,
+                             FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+                             nullptr);
+
+  if (watch.handle == INVALID_HANDLE_VALUE)
+  {
+    const auto errorString = getLastErrorString(GetLastError());
+    error = QObject::tr("Unable to create object handle. Error: %1").arg(errorString);
+    return false;
+  }
+
+  // the completion key identifies the watch of the completed read.
+  if(!CreateIoCompletionPort(watch.handle, m_port, reinterpret_cast<ULONG_PTR>(&watch), 0))
+  {
+    const auto errorString = getLastErrorString(GetLastError());
+    error = QObject::tr("Unable to associate object handle to completion port. Error: %1").arg(errorString);
+    CloseHandle(watch.handle);
+    watch.handle = INVALID_HANDLE_VALUE;
+    return false;
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool Win32WatchBackend::growBuffer(Watch &watch, QString &error)
+{
+  const auto size = watch.buffers[0].size();
+  if(size >= MAXIMUM_BUFFER_SIZE) return true;
+
+  // called after a read completes, there is no IO pending on the handle.
+  CloseHandle(watch.handle);
+  for(auto &buffer: watch.buffers)
+  {
+    buffer.resize(std::min<size_t>(size * 2, MAXIMUM_BUFFER_SIZE), 0);
+  }
+
+  return openHandle(watch, error);
+}
+
+//-----------------------------------------------------------------------------
+void Win32WatchBackend::removeWatch(const WatchId id)
+{
+  closeWatch(id);
+}
+
+//-----------------------------------------------------------------------------
+bool Win32WatchBackend::read(Watch &watch, QString &error)
+{
+  auto &buffer = watch.buffers[watch.current];
+  const auto result = ReadDirectoryChangesW(watch.handle,
+                                            buffer.data(),
+                                            static_cast<DWORD>(buffer.size()),
+                                            static_cast<WINBOOL>(watch.recursive),
+                                            watch.filter,
+                                            0,
+                                            &watch.overlapped,
+                                            0);
+
+  if(result == 0)
+  {
+    const auto errorString = getLastErrorString(GetLastError());
+    error = QObject::tr("Unable to read changes. Error: %1").arg(errorString);
+    return false;
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void Win32WatchBackend::closeWatch(const WatchId id)
+{
+  auto it = m_watches.find(id);
+  if(it == m_watches.end()) return;
+
+  auto watch = std::move(it->second);
+  m_watches.erase(it);
+
+  CancelIoEx(watch->handle, &watch->overlapped);
+  CloseHandle(watch->handle);
+
+  auto key = watch.get();
+  m_closing.emplace(key, std::move(watch));
+}
+
+//-----------------------------------------------------------------------------
+bool Win32WatchBackend::wait(Listener &listener, QString &error, const int timeout)
+{
+  DWORD bytes_returned = 0;
+  ULONG_PTR key = 0;
+  LPOVERLAPPED overlapped = nullptr;
+  const auto result = GetQueuedCompletionStatus(m_port, &bytes_returned, &key, &overlapped, timeout < 0 ? INFINITE : static_cast<DWORD>(timeout));
+
+  if(!result && !overlapped)
+  {
+    const auto waitError = GetLastError();
+    if(waitError == WAIT_TIMEOUT) return true;
+
+    const auto errorString = getLastErrorString(waitError);
+    error = QObject::tr("Unable to wait for changes. Error: %1").arg(errorString);
+    return false;
+  }
+
+  // posted by wakeUp().
+  if(key == 0) return true;
+
+  auto watch = reinterpret_cast<Watch *>(key);
+
+  auto closing = m_closing.find(watch);
+  if(closing != m_closing.end())
+  {
+    // the changes read before the watch was replaced are still reported.
+    if(result && bytes_returned != 0 && watch->replaced && m_watches.find(watch->id) != m_watches.end())
+    {
+      processBuffer(watch->id, watch->buffers[watch->current], listener);
+    }
+
+    m_closing.erase(closing);
+    return true;
+  }
+
+  const auto id = watch->id;
+  const auto errorCode = result ? ERROR_SUCCESS : GetLastError();
+
+  if(!result && errorCode != ERROR_NOTIFY_ENUM_DIR)
+  {
+    const auto errorString = getLastErrorString(errorCode);
+    CloseHandle(watch->handle);
+    m_watches.erase(id);
+
+    listener.onError(id, QObject::tr("Unable to finish overlapped IO. Error: %1").arg(errorString));
+    return true;
+  }
+
+  QString readError;
+
+  // the system buffer overflowed and the changes are lost. The read is re-armed before the
+  // listener rescans, so the changes made during the rescan are not lost too.
+  if(errorCode == ERROR_NOTIFY_ENUM_DIR || bytes_returned == 0)
+  {
+    if(!growBuffer(*watch, readError) || !read(*watch, readError))
+    {
+      if(watch->handle != INVALID_HANDLE_VALUE) CloseHandle(watch->handle);
+      m_watches.erase(id);
+
+      listener.onError(id, readError);
+      return true;
+    }
+
+    listener.onOverflow(id);
+    return true;
+  }
+
+  // re-arm the read on the other buffer before parsing, so the changes that happen
+  // meanwhile are written to it instead of queued in the internal buffer of the system.
+  const auto &completed = watch->buffers[watch->current];
+  watch->current ^= 1;
+  const auto armed = read(*watch, readError);
+
+  processBuffer(id, completed, listener);
+
+  if(!armed)
+  {
+    CloseHandle(watch->handle);
+    m_watches.erase(id);
+
+    listener.onError(id, readError);
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void Win32WatchBackend::processBuffer(const WatchId id, const std::vector<BYTE> &buffer, Listener &listener) const
+{
+  auto information = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer.data());
+  do
+  {
+    const std::wstring_view name{ information->FileName, information->FileNameLength / sizeof(information->FileName[0]) };
+    const auto action = information->Action < std::size(eventMapping) ? eventMapping[information->Action] : Events::NONE;
+    if(action != Events::NONE) listener.onChange(id, name, action);
+
+    if (information->NextEntryOffset == 0) break;
+
+    information = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(reinterpret_cast<const BYTE*>(information) + information->NextEntryOffset);
+  } while (true);
+}
+
+//-----------------------------------------------------------------------------
+DWORD Win32WatchBackend::notifyFilter(const Events events, const Properties properties)
+{
+  // From https://docs.microsoft.com/en-us/windows/win32/api/winbase/nf-winbase-readdirectorychangesw
+  DWORD filter = 0;
+
+  // Any file or directory name change in the watched directory or subtree causes a change notification
+  // wait operation to return. Changes include renaming, creating, or deleting a file or directory.
+  if((events & (Events::ADDED | Events::REMOVED | Events::RENAMED_OLD | Events::RENAMED_NEW)) != Events::NONE)
+  {
+    filter |= FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME;
+  }
+
+  if((events & Events::MODIFIED) != Events::NONE)
+  {
+    // The operating system detects a change in file size and last write-time only when the file is
+    // written to the disk. For operating systems that use extensive caching, detection occurs only when
+    // the cache is sufficiently flushed.
+    if((properties & Properties::SIZE) != Properties::NONE)       filter |= FILE_NOTIFY_CHANGE_SIZE;
+    if((properties & Properties::WRITE_TIME) != Properties::NONE) filter |= FILE_NOTIFY_CHANGE_LAST_WRITE;
+    if((properties & Properties::ATTRIBUTES) != Properties::NONE) filter |= FILE_NOTIFY_CHANGE_ATTRIBUTES;
+    if((properties & Properties::SECURITY) != Properties::NONE)   filter |= FILE_NOTIFY_CHANGE_SECURITY;
+    if((properties & Properties::OTHER) != Properties::NONE)      filter |= FILE_NOTIFY_CHANGE_LAST_ACCESS | FILE_NOTIFY_CHANGE_CREATION;
+  }
+
+  // the filter can't be empty, directory name changes are the least frequent.
+  return filter != 0 ? filter : FILE_NOTIFY_CHANGE_DIR_NAME;
+}
+
+//-----------------------------------------------------------------------------
+void Win32WatchBackend::wakeUp()
+{
+  PostQueuedCompletionStatus(m_port, 0, 0, nullptr);
+}
+
+//-----------------------------------------------------------------------------
+QString Win32WatchBackend::getLastErrorString(const DWORD errorCode)
+{
+  QString message;
+
+  if(errorCode != 0)
+  {
+    LPSTR messageBuffer = nullptr;
+
+    //Ask Win32 to give us the string version of that message ID.
+    //The parameters we pass in, tell Win32 to create the buffer that holds the message for us (because we don't yet know how long the message string will be).
+    size_t size = FormatMessageA(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+                                 NULL, errorCode, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), (LPSTR)&messageBuffer, 0, NULL);
+
+    //Copy the error message into a std::string.
+    message = QString::fromLocal8Bit(messageBuffer, size);
+
+    //Free the Win32's string's buffer.
+    LocalFree(messageBuffer);
+  }
+
+  return message;
+}
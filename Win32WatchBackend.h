@@ -0,0 +1,175 @@
+/*
+ File: Win32WatchBackend.h
+ Created on: 16/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WIN32WATCHBACKEND_H_
+#define WIN32WATCHBACKEND_H_
+
+// Project
+#include <WatchBackend.h>
+
+// C++
+#include <windows.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+/** \class Win32WatchBackend
+ * \brief Watches directories using ReadDirectoryChangesW() with overlapped IO. The reads of
+ * all the watches complete on a single IO completion port. Each watch alternates between two
+ * buffers and issues the next read before parsing the completed one, so the changes that happen
+ * while parsing are not missed.
+ *
+ */
+class Win32WatchBackend
+: public WatchBackend
+{
+  public:
+    /** \brief Win32WatchBackend class constructor.
+     *
+     */
+    explicit Win32WatchBackend();
+
+    /** \brief Win32WatchBackend class virtual destructor.
+     *
+     */
+    virtual ~Win32WatchBackend();
+
+    virtual bool open(QString &error) override;
+
+    virtual bool addWatch(const WatchId id, const std::filesystem::path &directory, bool recursive,
+                          const Events events, const Properties properties, QString &error) override;
+
+    virtual bool updateWatch(const WatchId id, const Events events, const Properties properties, QString &error) override;
+
+    virtual void removeWatch(const WatchId id) override;
+
+    virtual bool wait(Listener &listener, QString &error, const int timeout = -1) override;
+
+    virtual void wakeUp() override;
+
+    /** \brief Helper method to get the string of the given Win32 API error.
+     * \param[in] errorCode Win32 API error code.
+     *
+     */
+    static QString getLastErrorString(const DWORD errorCode);
+
+  private:
+    /** \struct Watch
+     * \brief Data of a watched directory. Must live until its pending read completes.
+     *
+     */
+    struct Watch
+    {
+      WatchId               id;         /** watch identifier.                             */
+      std::filesystem::path directory;  /** path of the watched directory.                */
+      HANDLE                handle;     /** handle of the watched directory.              */
+      OVERLAPPED            overlapped; /** overlapped IO structure of the pending read.  */
+      bool                  recursive;  /** true to monitor the directory subtree.        */
+      DWORD                 filter;     /** changes to watch.                             */
+      std::vector<BYTE>     buffers[2]; /** notifications buffers.                        */
+      unsigned int          current;    /** index of the buffer of the pending read.      */
+      bool                  replaced;   /** true if closed to watch other changes instead. */
+    };
+
+    /** \brief Creates the watch of the given directory and issues its first read. Returns nullptr in
+     * case of failure.
+     * \param[in] id Watch identifier.
+     * \param[in] directory Path of the directory to watch.
+     * \param[in] recursive True to monitor the directory subtree.
+     * \param[in] filter Changes to watch.
+     * \param[in] size Size of the notifications buffers.
+     * \param[out] error Error message in case of failure.
+     *
+     */
+    std::unique_ptr<Watch> createWatch(const WatchId id, const std::filesystem::path &directory, bool recursive,
+                                       const DWORD filter, const size_t size, QString &error);
+
+    /** \brief Opens the directory handle of the watch and associates it to the completion port. Returns
+     * true on success and false otherwise.
+     * \param[in] watch Watch data.
+     * \param[out] error Error message in case of failure.
+     *
+     */
+    bool openHandle(Watch &watch, QString &error);
+
+    /** \brief Doubles the buffers of the watch up to the maximum size. The directory handle is reopened
+     * as the system keeps the size of the first read for the lifetime of the handle. Returns true on
+     * success and false otherwise.
+     * \param[in] watch Watch data.
+     * \param[out] error Error message in case of failure.
+     *
+     */
+    bool growBuffer(Watch &watch, QString &error);
+
+    /** \brief Issues the next read of changes of the given watch on its current buffer. Returns true on
+     * success and false otherwise.
+     * \param[in] watch Watch data.
+     * \param[out] error Error message in case of failure.
+     *
+     */
+    bool read(Watch &watch, QString &error);
+
+    /** \brief Closes the directory handle of the watch and moves it to the closing list, to be destroyed
+     * when the completion of the cancelled read is received.
+     * \param[in] id Watch identifier.
+     *
+     */
+    void closeWatch(const WatchId id);
+
+    /** \brief Notifies the listener of the changes in the given buffer.
+     * \param[in] id Watch identifier.
+     * \param[in] buffer Buffer of a completed read.
+     * \param[in] listener Listener of the changes.
+     *
+     */
+    void processBuffer(const WatchId id, const std::vector<BYTE> &buffer, Listener &listener) const;
+
+    static const DWORD INITIAL_BUFFER_SIZE = 4096;  /** size of the notifications buffer of a new watch.        */
+    static const DWORD MAXIMUM_BUFFER_SIZE = 65536; /** maximum size of a notifications buffer, the limit of
+                                                        ReadDirectoryChangesW for directories on the network. */
+
+    /** Maps the changes with the corresponding event, indexed by the action value (FILE_ACTION_ADDED = 1 to
+     *  FILE_ACTION_RENAMED_NEW_NAME = 5).
+     *
+     *  From https://docs.microsoft.com/en-us/windows/win32/api/winnt/ns-winnt-file_notify_information                 */
+    static constexpr Events eventMapping[] =
+    {
+      Events::NONE,        /** Not an action.                                                                          */
+      Events::ADDED,       /** FILE_ACTION_ADDED: The file was added to the directory.                                 */
+      Events::REMOVED,     /** FILE_ACTION_REMOVED: The file was removed from the directory.                           */
+      Events::MODIFIED,    /** FILE_ACTION_MODIFIED: The file was modified. This can be a change in the time stamp or
+                                attributes.                                                                            */
+      Events::RENAMED_OLD, /** FILE_ACTION_RENAMED_OLD_NAME: The file was renamed and this is the old name.            */
+      Events::RENAMED_NEW  /** FILE_ACTION_RENAMED_NEW_NAME: The file was renamed and this is the new name.            */
+    };
+
+    /** \brief Returns the changes to watch to report the given events.
+     * \param[in] events Events to report.
+     * \param[in] properties Properties whose modifications are reported.
+     *
+     */
+    static DWORD notifyFilter(const Events events, const Properties properties);
+
+    HANDLE                                      m_port;    /** IO completion port.                        */
+    std::map<WatchId, std::unique_ptr<Watch>>   m_watches; /** active watches.                            */
+    std::map<Watch *, std::unique_ptr<Watch>>   m_closing; /** closed watches waiting for their read
+                                                               cancellation to complete.                  */
+};
+
+#endif // WIN32WATCHBACKEND_H_
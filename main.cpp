@@ -19,18 +19,27 @@
 
 // Project
 #include "FilesystemWatcher.h"
+#include "HeadlessWatcher.h"
 
 // Qt
 #include <QApplication>
+#include <QCoreApplication>
 #include <QSharedMemory>
 #include <QObject>
 #include <QMessageBox>
 #include <QString>
 #include <QIcon>
+#include <QCommandLineParser>
 
 // C++
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
 //-----------------------------------------------------------------
 void myMessageOutput(QtMsgType type, const QMessageLogContext &context, const QString &msg)
 {
@@ -42,14 +51,86 @@ void myMessageOutput(QtMsgType type, const QMessageLogContext &context, const QS
   if (type == QtFatalMsg) abort();
 }
 
+//-----------------------------------------------------------------
+const QCommandLineOption HEADLESS_OPTION("headless", QObject::tr("Watches the objects of the settings without a GUI and writes the events as JSON lines."));
+const QCommandLineOption OUTPUT_OPTION("output", QObject::tr("Appends the JSON lines of the headless mode to <file> instead of the standard output."), "file");
+const QCommandLineOption REPLAY_OPTION("replay", QObject::tr("Replays the events recorded in the journal <path>, a segment or its directory."), "path");
+const QCommandLineOption SPEED_OPTION("speed", QObject::tr("Speed of the replay, 0 for as fast as possible (default 1)."), "factor", "1");
+
+//-----------------------------------------------------------------
+void processArguments(QCommandLineParser &parser, const QCoreApplication &app)
+{
+  parser.addHelpOption();
+  parser.addOption(HEADLESS_OPTION);
+  parser.addOption(OUTPUT_OPTION);
+  parser.addOption(REPLAY_OPTION);
+  parser.addOption(SPEED_OPTION);
+  parser.process(app);
+}
+
+//-----------------------------------------------------------------
+bool isHeadless(int argc, char **argv)
+{
+  // before creating the application, a QApplication needs a display.
+  for(int i = 1; i < argc; ++i)
+  {
+    if(std::strcmp(argv[i], "--headless") == 0 || std::strcmp(argv[i], "-headless") == 0) return true;
+  }
+
+  return false;
+}
+
+//-----------------------------------------------------------------
+int runHeadless(int argc, char **argv)
+{
+#ifdef _WIN32
+  // built as a GUI application, the lines are written to the console of the parent process.
+  if(AttachConsole(ATTACH_PARENT_PROCESS))
+  {
+    std::freopen("CONOUT$", "w", stdout);
+    std::freopen("CONOUT$", "w", stderr);
+  }
+#endif
+
+  QCoreApplication app(argc, argv);
+
+  QCommandLineParser parser;
+  processArguments(parser, app);
+
+  QSharedMemory guard;
+  guard.setKey("FilesystemWatcher");
+
+  if (!guard.create(1))
+  {
+    std::cerr << QObject::tr("An instance is already running!").toStdString() << std::endl;
+    return 1;
+  }
+
+  HeadlessWatcher watcher;
+
+  QString error;
+  if(!watcher.start(parser.value(OUTPUT_OPTION), error))
+  {
+    std::cerr << error.toStdString() << std::endl;
+    return 1;
+  }
+
+  return app.exec();
+}
+
 //-----------------------------------------------------------------
 int main(int argc, char **argv)
 {
   qInstallMessageHandler(myMessageOutput);
 
+  if(isHeadless(argc, argv)) return runHeadless(argc, argv);
+
   QApplication app(argc, argv);
   app.setQuitOnLastWindowClosed(false);
 
+  QCommandLineParser parser;
+  processArguments(parser, app);
+
   // allow only one instance running
   QSharedMemory guard;
   guard.setKey("FilesystemWatcher");
@@ -70,6 +151,11 @@ int main(int argc, char **argv)
   auto watcher = new FilesystemWatcher();
   watcher->showNormal();
 
+  if(parser.isSet(REPLAY_OPTION))
+  {
+    watcher->replay(parser.value(REPLAY_OPTION), parser.value(SPEED_OPTION).toDouble());
+  }
+
   auto returnVal = app.exec();
 
   delete watcher;